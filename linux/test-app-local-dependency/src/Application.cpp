@@ -21,9 +21,13 @@
  */
 
 #include "Application.h"
+#include "LogSink.h"
+#include "SessionHistory.h"
+#include "SessionRouter.h"
 #include <FFmpegKit.h>
 #include <FFmpegKitConfig.h>
 #include <FFprobeKit.h>
+#include <cstdlib>
 #include <iostream>
 
 using namespace ffmpegkit;
@@ -96,6 +100,20 @@ ffmpegkittest::Application::Application() {
 
     FFmpegKitConfig::ignoreSignal(SignalXcpu);
     FFmpegKitConfig::setLogLevel(LevelAVLogInfo);
+
+    LogSink::getInstance().start();
+
+    // RING FILES NEED EVERY LINE, SO THEY STOP LOG FILTERS FROM DROPPING LINES BEFORE THEY ARE COPIED
+    if (getenv("FFMPEG_KIT_TEST_LOG_FILES") != nullptr) {
+        SessionRouter::getInstance().enableLogFiles(getApplicationCacheDirectory());
+    }
+
+    // SESSIONS WITHOUT A ROUTE PRINT THEIR LOGS LIKE FFMPEG DOES WITHOUT A LOG CALLBACK
+    SessionRouter::getInstance().setDefaultLogConsumer(LogSink::getInstance().registerConsumer([](const std::string& batch) {
+        std::cout << batch;
+    }));
+    SessionRouter::getInstance().enable();
+    SessionHistory::getInstance().enable();
 }
 
 void ffmpegkittest::Application::initApplicationCacheDirectory() {
@@ -144,13 +162,14 @@ void ffmpegkittest::Application::onTabSelected(const Widget* page, const guint p
 }
 
 void ffmpegkittest::Application::listFFmpegSessions() {
-    auto ffmpegSessions = FFmpegKit::listSessions();
+    auto records = SessionHistory::getInstance().listSessions();
     std::cout << "Listing FFmpeg sessions." << std::endl;
     int i = 0;
-    std::for_each(ffmpegSessions->begin(), ffmpegSessions->end(), [&](const std::shared_ptr<ffmpegkit::FFmpegSession> session) {
-        std::cout << "Session " << i++ << " = id:" << session->getSessionId() << ", startTime:" << session->getStartTime() << ", duration:" << session-> getDuration() << ", state:" << FFmpegKitConfig::sessionStateToString(session->getState()) << ", returnCode:" << session->getReturnCode() << "." << std::endl;
+    std::for_each(records.begin(), records.end(), [&](const SessionRecord& record) {
+        auto session = record.session;
+        std::cout << "Session " << i++ << " = id:" << session->getSessionId() << ", startTime:" << session->getStartTime() << ", duration:" << session-> getDuration() << ", state:" << FFmpegKitConfig::sessionStateToString(session->getState()) << ", returnCode:" << session->getReturnCode() << ", placement:" << record.placement << ", memory:" << SessionHistory::formatMemory(record.memory) << "." << std::endl;
     });
-    std::cout << "Listed FFmpeg sessions." << std::endl;
+    std::cout << "Listed FFmpeg sessions, retaining " << SessionHistory::getInstance().getRetainedCount() << " completed sessions in " << SessionHistory::getInstance().getRetainedBytes() << " bytes, " << SessionHistory::getInstance().getEvictedCount() << " evicted." << std::endl;
 }
 
 void ffmpegkittest::Application::listFFprobeSessions() {
@@ -22,8 +22,11 @@
 
 #include "AudioTab.h"
 #include "Application.h"
+#include "CommandTemplate.h"
 #include "Constants.h"
+#include "LogSink.h"
 #include "Popup.h"
+#include "SessionRouter.h"
 #include <FFmpegKit.h>
 #include <FFmpegKitConfig.h>
 
@@ -45,15 +48,7 @@ static gboolean showEncodeFailedPopup(const std::pair<Gtk::Window*,const std::st
     return FALSE;
 }
 
-static gboolean appendLog(const std::pair<ffmpegkittest::AudioTab*,const std::shared_ptr<Log>>* parameters) {
-    ffmpegkittest::AudioTab* audioTab = parameters->first;
-    auto log = parameters->second;
-    audioTab->appendOutput(log->getMessage());
-    delete parameters;
-    return FALSE;
-}
-
-ffmpegkittest::AudioTab::AudioTab() : selectedCodec(-1) {
+ffmpegkittest::AudioTab::AudioTab() : selectedCodec(-1), outputView("audio") {
     audioCodecModel = Gtk::ListStore::create(audioCodecModelColumn);
     audioCodec.set_model(audioCodecModel);
     audioCodec.set_size_request(240, 30);
@@ -70,23 +65,18 @@ ffmpegkittest::AudioTab::AudioTab() : selectedCodec(-1) {
     Util::applyButtonStyle(encodeButton);
     encodeButtonBox.pack_start(encodeButton, Gtk::PACK_EXPAND_PADDING);
 
-    outputText.set_editable(false);
-    Util::applyOutputTextStyle(outputText);
-    outputTextWindow.add(outputText);
+    logConsumerId = LogSink::getInstance().registerConsumer([this](const std::string& batch) {
+        appendOutput(batch);
+    });
 
     pack_start(audioCodecBox, Gtk::PACK_SHRINK);
     pack_start(encodeButtonBox, Gtk::PACK_SHRINK);
-    add(outputTextWindow);
+    add(outputView);
 }
 
 void ffmpegkittest::AudioTab::setActive() {
     std::cout << "Audio Tab Activated" << std::endl;
-    FFmpegKitConfig::enableLogCallback(nullptr);
-    FFmpegKitConfig::enableStatisticsCallback(nullptr);
     createAudioSample();
-    FFmpegKitConfig::enableLogCallback([this](auto log) {
-        g_idle_add((GSourceFunc)appendLog, new std::pair<AudioTab*,const std::shared_ptr<Log>>(this, log));
-    });
 }
 
 void ffmpegkittest::AudioTab::setParentWindow(Gtk::Window* parentWindow) {
@@ -94,9 +84,7 @@ void ffmpegkittest::AudioTab::setParentWindow(Gtk::Window* parentWindow) {
 }
 
 void ffmpegkittest::AudioTab::appendOutput(const std::string& string) {
-    outputText.get_buffer()->set_text(outputText.get_buffer()->get_text() + string);
-    Glib::RefPtr<Gtk::Adjustment> adj = outputText.get_vadjustment();
-    adj->set_value(adj->get_upper());
+    outputView.append(string);
 }
 
 void ffmpegkittest::AudioTab::createAudioSample() {
@@ -105,11 +93,13 @@ void ffmpegkittest::AudioTab::createAudioSample() {
     auto audioSampleFile = getAudioSampleFile();
     std::remove(audioSampleFile.c_str());
 
-    std::string ffmpegCommand = "-hide_banner -y -f lavfi -i sine=frequency=1000:duration=5 -c:a pcm_s16le " + audioSampleFile;
+    static const CommandTemplate sampleTemplate("-hide_banner -y -f lavfi -i sine=frequency=1000:duration=5 -c:a pcm_s16le {output}");
+    auto arguments = sampleTemplate.bind({{"output", audioSampleFile}});
 
-    std::cout << "Creating audio sample with '" << ffmpegCommand << "'." << std::endl;
+    std::cout << "Creating audio sample with '" << CommandTemplate::toString(arguments) << "'." << std::endl;
 
-    auto session = FFmpegKit::execute(ffmpegCommand);
+    auto session = FFmpegSession::create(arguments);
+    FFmpegKitConfig::ffmpegExecute(session);
     if (ReturnCode::isSuccess(session->getReturnCode())) {
         encodeButton.set_sensitive(true);
         std::cout << "AUDIO sample created." << std::endl;
@@ -120,7 +110,7 @@ void ffmpegkittest::AudioTab::createAudioSample() {
 }
 
 void ffmpegkittest::AudioTab::clearOutput() {
-    outputText.get_buffer()->set_text("");
+    outputView.clear();
 }
 
 void ffmpegkittest::AudioTab::initAudioCodecData() {
@@ -207,15 +197,15 @@ void ffmpegkittest::AudioTab::encodeAudio() {
 
     std::cout << "Testing AUDIO encoding with '" << audioCodec << "' codec." << std::endl;
 
-    auto ffmpegCommand = generateAudioEncodeScript();
+    auto arguments = generateAudioEncodeArguments();
 
     showProgressDialog();
 
     clearOutput();
 
-    std::cout << "FFmpeg process started with arguments: '" << ffmpegCommand << "'." << std::endl;
+    std::cout << "FFmpeg process started with arguments: '" << CommandTemplate::toString(arguments) << "'." << std::endl;
 
-    auto session = FFmpegKit::executeAsync(ffmpegCommand, [this](auto session) {
+    auto session = SessionRouter::getInstance().executeAsync(arguments, [this](auto session) {
         const auto state = session->getState();
         auto returnCode = session->getReturnCode();
 
@@ -228,7 +218,7 @@ void ffmpegkittest::AudioTab::encodeAudio() {
             g_idle_add((GSourceFunc)showEncodeFailedPopup, new std::pair<Gtk::Window*,const std::string>(this->parentWindow, "Encode failed. Please check logs for the details."));
             std::cout << "Encode failed with state " << FFmpegKitConfig::sessionStateToString(state) << " and rc " << returnCode << "." << session->getFailStackTrace() << std::endl;
         }
-    });
+    }, logConsumerId);
 }
 
 std::string ffmpegkittest::AudioTab::getAudioOutputFile() {
@@ -272,34 +262,36 @@ void ffmpegkittest::AudioTab::hideProgressDialog() {
     // progressDialog.hide();
 }
 
-std::string ffmpegkittest::AudioTab::generateAudioEncodeScript() {
+std::list<std::string> ffmpegkittest::AudioTab::generateAudioEncodeArguments() {
+    static const CommandTemplate encodeTemplate("-hide_banner -y -i {sample} {options...} {output}");
     auto audioCodec = getSelectedAudioCodec();
-    auto audioSampleFile = getAudioSampleFile();
-    auto audioOutputFile = getAudioOutputFile();
+    std::string options;
 
     if (audioCodec.compare("mp2 (twolame)") == 0) {
-        return "-hide_banner -y -i " + audioSampleFile + " -c:a mp2 -b:a 192k " + audioOutputFile;
+        options = "-c:a mp2 -b:a 192k";
     } else if (audioCodec.compare("mp3 (liblame)") == 0) {
-        return "-hide_banner -y -i " + audioSampleFile + " -c:a libmp3lame -qscale:a 2 " + audioOutputFile;
+        options = "-c:a libmp3lame -qscale:a 2";
     } else if (audioCodec.compare("mp3 (libshine)") == 0) {
-        return "-hide_banner -y -i " + audioSampleFile + " -c:a libshine -qscale:a 2 " + audioOutputFile;
+        options = "-c:a libshine -qscale:a 2";
     } else if (audioCodec.compare("vorbis") == 0) {
-        return "-hide_banner -y -i " + audioSampleFile + " -c:a libvorbis -b:a 64k " + audioOutputFile;
+        options = "-c:a libvorbis -b:a 64k";
     } else if (audioCodec.compare("opus") == 0) {
-        return "-hide_banner -y -i " + audioSampleFile + " -c:a libopus -b:a 64k -vbr on -compression_level 10 " + audioOutputFile;
+        options = "-c:a libopus -b:a 64k -vbr on -compression_level 10";
     } else if (audioCodec.compare("amr-nb") == 0) {
-        return "-hide_banner -y -i " + audioSampleFile + " -ar 8000 -ab 12.2k -c:a libopencore_amrnb " + audioOutputFile;
+        options = "-ar 8000 -ab 12.2k -c:a libopencore_amrnb";
     } else if (audioCodec.compare("amr-wb") == 0) {
-        return "-hide_banner -y -i " + audioSampleFile + " -ar 8000 -ab 12.2k -c:a libvo_amrwbenc -strict experimental " + audioOutputFile;
+        options = "-ar 8000 -ab 12.2k -c:a libvo_amrwbenc -strict experimental";
     } else if (audioCodec.compare("ilbc") == 0) {
-        return "-hide_banner -y -i " + audioSampleFile + " -c:a ilbc -ar 8000 -b:a 15200 " + audioOutputFile;
+        options = "-c:a ilbc -ar 8000 -b:a 15200";
     } else if (audioCodec.compare("speex") == 0) {
-        return "-hide_banner -y -i " + audioSampleFile + " -c:a libspeex -ar 16000 " + audioOutputFile;
+        options = "-c:a libspeex -ar 16000";
     } else if (audioCodec.compare("wavpack") == 0) {
-        return "-hide_banner -y -i " + audioSampleFile + " -c:a wavpack -b:a 64k " + audioOutputFile;
+        options = "-c:a wavpack -b:a 64k";
     } else {
 
         // soxr
-        return "-hide_banner -y -i " + audioSampleFile + " -af aresample=resampler=soxr -ar 44100 " + audioOutputFile;
+        options = "-af aresample=resampler=soxr -ar 44100";
     }
+
+    return encodeTemplate.bind({{"sample", getAudioSampleFile()}, {"options", options}, {"output", getAudioOutputFile()}});
 }
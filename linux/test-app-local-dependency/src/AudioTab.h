@@ -23,9 +23,11 @@
 #ifndef FFMPEG_KIT_TEST_AUDIO_TAB_H
 #define FFMPEG_KIT_TEST_AUDIO_TAB_H
 
+#include "OutputView.h"
 #include "ProgressDialog.h"
 #include "Util.h"
 #include <gtkmm.h>
+#include <list>
 
 namespace ffmpegkittest {
 
@@ -47,7 +49,7 @@ namespace ffmpegkittest {
             std::string getAudioSampleFile();
             void showProgressDialog();
             void hideProgressDialog();
-            std::string generateAudioEncodeScript();
+            std::list<std::string> generateAudioEncodeArguments();
 
             Glib::RefPtr<Gtk::ListStore> audioCodecModel;
             ComboBoxModelColumn audioCodecModelColumn;
@@ -56,10 +58,10 @@ namespace ffmpegkittest {
             int selectedCodec;
             Gtk::Button encodeButton;
             Gtk::HBox encodeButtonBox;
-            Gtk::TextView outputText;
-            Gtk::ScrolledWindow outputTextWindow;
+            OutputView outputView;
             ffmpegkittest::ProgressDialog progressDialog;
             Gtk::Window* parentWindow;
+            int logConsumerId;
     };
 
 }
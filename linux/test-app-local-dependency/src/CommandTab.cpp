@@ -23,7 +23,10 @@
 #include "CommandTab.h"
 #include "Application.h"
 #include "Constants.h"
+#include "LogSink.h"
 #include "Popup.h"
+#include "ProgressEstimator.h"
+#include "SessionRouter.h"
 #include <FFmpegKit.h>
 #include <FFmpegKitConfig.h>
 #include <FFprobeSession.h>
@@ -37,14 +40,6 @@ static gboolean showCommandFailedPopup(Gtk::Window* window) {
     return FALSE;
 }
 
-static gboolean appendLog(const std::pair<ffmpegkittest::CommandTab*,const std::shared_ptr<Log>>* parameters) {
-    ffmpegkittest::CommandTab* commandTab = parameters->first;
-    auto log = parameters->second;
-    commandTab->appendOutput(log->getMessage());
-    delete parameters;
-    return FALSE;
-}
-
 static gboolean appendSessionOutput(const std::pair<ffmpegkittest::CommandTab*,const std::shared_ptr<FFprobeSession>>* parameters) {
     ffmpegkittest::CommandTab* commandTab = parameters->first;
     auto session = parameters->second;
@@ -53,7 +48,7 @@ static gboolean appendSessionOutput(const std::pair<ffmpegkittest::CommandTab*,c
     return FALSE;
 }
 
-ffmpegkittest::CommandTab::CommandTab() : parentWindow(nullptr) {
+ffmpegkittest::CommandTab::CommandTab() : outputView("command"), parentWindow(nullptr) {
     commandText.set_placeholder_text("Enter command");
     Util::applyEditTextStyle(commandText);
 
@@ -71,14 +66,17 @@ ffmpegkittest::CommandTab::CommandTab() : parentWindow(nullptr) {
     Util::applyButtonStyle(runFFprobeButton);
     runFFprobeButtonBox.pack_start(runFFprobeButton, Gtk::PACK_EXPAND_PADDING);
 
-    outputText.set_editable(false);
-    Util::applyOutputTextStyle(outputText);
-    outputTextWindow.add(outputText);
+    logConsumerId = LogSink::getInstance().registerConsumer([this](const std::string& batch) {
+        appendOutput(batch);
+    });
+    statisticsConsumerId = SessionRouter::getInstance().registerStatisticsConsumer([this](const StatisticsSnapshot& statistics) {
+        std::cout << "FFmpeg progress: " << ProgressEstimator::format(ProgressEstimator::getInstance().update(statistics)) << std::endl;
+    });
 
     pack_start(commandText, Gtk::PACK_SHRINK);
     pack_start(runFFmpegButtonBox, Gtk::PACK_SHRINK);
     pack_start(runFFprobeButtonBox, Gtk::PACK_SHRINK);
-    add(outputTextWindow);
+    add(outputView);
 }
 
 void ffmpegkittest::CommandTab::setParentWindow(Gtk::Window* parentWindow) {
@@ -96,7 +94,7 @@ void ffmpegkittest::CommandTab::runFFmpeg() {
 
     std::cout << "FFmpeg process started with arguments: '" << ffmpegCommand << "'" << std::endl;
 
-    FFmpegKit::executeAsync(ffmpegCommand, [this](auto session) {
+    auto session = SessionRouter::getInstance().executeAsync(ffmpegCommand, [this](auto session) {
         const auto state = session->getState();
         auto returnCode = session->getReturnCode();
 
@@ -105,9 +103,8 @@ void ffmpegkittest::CommandTab::runFFmpeg() {
         if (state == SessionStateFailed || !returnCode->isValueSuccess()) {
             g_idle_add((GSourceFunc)showCommandFailedPopup, this->parentWindow);
         }
-    }, [this](auto log) {
-        g_idle_add((GSourceFunc)appendLog, new std::pair<CommandTab*,const std::shared_ptr<Log>>(this, log));
-    }, nullptr);
+    }, logConsumerId, statisticsConsumerId);
+    ProgressEstimator::getInstance().expectDurationOf(session->getSessionId(), ffmpegCommand);
 }
 
 void ffmpegkittest::CommandTab::runFFprobe() {
@@ -140,15 +137,12 @@ void ffmpegkittest::CommandTab::runFFprobe() {
 
 void ffmpegkittest::CommandTab::setActive() {
     std::cout << "Command Tab Activated" << std::endl;
-    FFmpegKitConfig::enableLogCallback(nullptr);
 }
 
 void ffmpegkittest::CommandTab::appendOutput(const std::string& string) {
-    outputText.get_buffer()->set_text(outputText.get_buffer()->get_text() + string);
-    Glib::RefPtr<Gtk::Adjustment> adj = outputText.get_vadjustment();
-    adj->set_value(adj->get_upper());
+    outputView.append(string);
 }
 
 void ffmpegkittest::CommandTab::clearOutput() {
-    outputText.get_buffer()->set_text("");
+    outputView.clear();
 }
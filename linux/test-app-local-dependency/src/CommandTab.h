@@ -23,6 +23,7 @@
 #ifndef FFMPEG_KIT_TEST_COMMAND_TAB_H
 #define FFMPEG_KIT_TEST_COMMAND_TAB_H
 
+#include "OutputView.h"
 #include "Util.h"
 #include <gtkmm.h>
 #include <FFprobeSession.h>
@@ -47,9 +48,10 @@ namespace ffmpegkittest {
             Gtk::HBox runFFmpegButtonBox;
             Gtk::Button runFFprobeButton;
             Gtk::HBox runFFprobeButtonBox;
-            Gtk::TextView outputText;
-            Gtk::ScrolledWindow outputTextWindow;
+            OutputView outputView;
             Gtk::Window* parentWindow;
+            int logConsumerId;
+            int statisticsConsumerId;
     };
 
 }
@@ -0,0 +1,169 @@
+/*
+ * Copyright (c) 2022 Taner Sener
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#include "CommandTemplate.h"
+#include <FFmpegKitConfig.h>
+#include <cctype>
+#include <stdexcept>
+
+using namespace ffmpegkit;
+
+ffmpegkittest::CommandTemplate::CommandTemplate(const std::string& command) {
+
+    // QUOTES ARE RESOLVED HERE WITH THE SAME RULES FFMPEGKIT USES, BOUND VALUES ARE NEVER PARSED
+    for (const std::string& argument : FFmpegKitConfig::parseArguments(command)) {
+        Token token{std::vector<Part>(), 0, false};
+
+        if (argument.size() > 5 && argument.front() == '{' && argument.compare(argument.size() - 4, 4, "...}") == 0) {
+            token.parts.push_back(Part{"", addPlaceholder(argument.substr(1, argument.size() - 5))});
+            token.expands = true;
+            tokens.push_back(token);
+            continue;
+        }
+
+        std::string literal;
+        size_t position = 0;
+        while (position < argument.size()) {
+            size_t end = position + 1;
+            if (argument[position] == '{') {
+                while (end < argument.size() && (isalnum((unsigned char)argument[end]) || argument[end] == '_')) {
+                    end++;
+                }
+            }
+
+            // BRACES THAT DO NOT ENCLOSE A NAME ARE PART OF THE ARGUMENT
+            if (end > position + 1 && end < argument.size() && argument[end] == '}') {
+                if (!literal.empty()) {
+                    token.literalLength += literal.size();
+                    token.parts.push_back(Part{literal, -1});
+                    literal.clear();
+                }
+                token.parts.push_back(Part{"", addPlaceholder(argument.substr(position + 1, end - position - 1))});
+                position = end + 1;
+            } else {
+                literal.append(argument, position, end - position);
+                position = end;
+            }
+        }
+        if (!literal.empty() || token.parts.empty()) {
+            token.literalLength += literal.size();
+            token.parts.push_back(Part{literal, -1});
+        }
+
+        tokens.push_back(token);
+    }
+}
+
+int ffmpegkittest::CommandTemplate::getPlaceholder(const std::string& name) const {
+    for (size_t i = 0; i < placeholders.size(); i++) {
+        if (placeholders[i] == name) {
+            return (int)i;
+        }
+    }
+
+    return -1;
+}
+
+int ffmpegkittest::CommandTemplate::getPlaceholderCount() const {
+    return (int)placeholders.size();
+}
+
+std::list<std::string> ffmpegkittest::CommandTemplate::bind(const std::map<std::string, std::string>& namedValues) const {
+    std::list<std::string> arguments;
+
+    // VALUES ARE LOOKED UP ONCE PER BIND, TOKENS THEN USE THEM BY PLACEHOLDER INDEX
+    std::vector<const std::string*> values(placeholders.size(), nullptr);
+    for (size_t i = 0; i < placeholders.size(); i++) {
+        auto value = namedValues.find(placeholders[i]);
+        if (value == namedValues.end()) {
+            throw std::invalid_argument("Command template has no value for placeholder {" + placeholders[i] + "}.");
+        }
+        values[i] = &value->second;
+    }
+    if (namedValues.size() != placeholders.size()) {
+        for (auto& value : namedValues) {
+            if (getPlaceholder(value.first) < 0) {
+                throw std::invalid_argument("Command template has no placeholder {" + value.first + "}.");
+            }
+        }
+    }
+
+    for (const Token& token : tokens) {
+        if (token.expands) {
+            const std::string& options = *values[token.parts[0].placeholder];
+            size_t start = options.find_first_not_of(" \t");
+            while (start != std::string::npos) {
+                const size_t end = options.find_first_of(" \t", start);
+                arguments.push_back(options.substr(start, end - start));
+                start = options.find_first_not_of(" \t", end);
+            }
+        } else if (token.parts.size() == 1) {
+            arguments.push_back(token.parts[0].placeholder < 0 ? token.parts[0].literal : *values[token.parts[0].placeholder]);
+        } else {
+            size_t length = token.literalLength;
+            for (const Part& part : token.parts) {
+                if (part.placeholder >= 0) {
+                    length += values[part.placeholder]->size();
+                }
+            }
+
+            std::string argument;
+            argument.reserve(length);
+            for (const Part& part : token.parts) {
+                argument += (part.placeholder < 0) ? part.literal : *values[part.placeholder];
+            }
+            arguments.push_back(std::move(argument));
+        }
+    }
+
+    return arguments;
+}
+
+std::string ffmpegkittest::CommandTemplate::toString(const std::list<std::string>& arguments) {
+    std::string command;
+
+    // ONLY USED FOR LOGGING, ARGUMENTS WITH SPACES ARE QUOTED SO THEIR BOUNDARIES STAY VISIBLE
+    for (const std::string& argument : arguments) {
+        if (!command.empty()) {
+            command += ' ';
+        }
+        if (argument.empty() || argument.find_first_of(" \t") != std::string::npos) {
+            command += "\"" + argument + "\"";
+        } else {
+            command += argument;
+        }
+    }
+
+    return command;
+}
+
+int ffmpegkittest::CommandTemplate::addPlaceholder(const std::string& name) {
+
+    // A NAME USED TWICE IS BOUND TO ONE VALUE
+    const int placeholder = getPlaceholder(name);
+    if (placeholder >= 0) {
+        return placeholder;
+    }
+
+    placeholders.push_back(name);
+    return (int)placeholders.size() - 1;
+}
@@ -0,0 +1,71 @@
+/*
+ * Copyright (c) 2022 Taner Sener
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#ifndef FFMPEG_KIT_TEST_COMMAND_TEMPLATE_H
+#define FFMPEG_KIT_TEST_COMMAND_TEMPLATE_H
+
+#include <list>
+#include <map>
+#include <string>
+#include <vector>
+
+namespace ffmpegkittest {
+
+    /**
+     * An FFmpeg command that is tokenized once. Placeholders written as {name} inside an
+     * argument are replaced when the template is bound, so bound paths never need quoting and
+     * the bound arguments are passed to the session without being parsed again. A placeholder
+     * written as {name...} that fills a whole argument expands into the space separated
+     * options of its value, or into nothing when the value is empty. Values are bound by
+     * placeholder name; binding without a value for every placeholder, or with a value for a
+     * name the template does not have, throws instead of building a partial command.
+     */
+    class CommandTemplate {
+        public:
+            explicit CommandTemplate(const std::string& command);
+            int getPlaceholder(const std::string& name) const;
+            int getPlaceholderCount() const;
+            std::list<std::string> bind(const std::map<std::string, std::string>& values) const;
+
+            static std::string toString(const std::list<std::string>& arguments);
+
+        private:
+            struct Part {
+                std::string literal;
+                int placeholder;
+            };
+
+            struct Token {
+                std::vector<Part> parts;
+                size_t literalLength;
+                bool expands;
+            };
+
+            int addPlaceholder(const std::string& name);
+
+            std::vector<Token> tokens;
+            std::vector<std::string> placeholders;
+    };
+
+}
+
+#endif // FFMPEG_KIT_TEST_COMMAND_TEMPLATE_H
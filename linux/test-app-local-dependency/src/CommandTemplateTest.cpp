@@ -0,0 +1,102 @@
+/*
+ * Copyright (c) 2022 Taner Sener
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#include "CommandTemplateTest.h"
+#include "CommandTemplate.h"
+#include "Video.h"
+#include <FFmpegKitConfig.h>
+#include <iostream>
+#include <iterator>
+#include <stdexcept>
+
+using namespace ffmpegkit;
+using namespace ffmpegkittest;
+
+void testPlaceholdersAreBound() {
+    CommandTemplate command("-i {input} -vf 'scale=640:{height},drawtext=text=a b' -c:v {codec} {output}");
+    assert(command.getPlaceholderCount() == 4);
+    assert(command.getPlaceholder("height") == 1);
+    assert(command.getPlaceholder("missing") == -1);
+
+    const std::list<std::string> arguments = command.bind({{"input", "/my photos/it's \"one\".jpg"}, {"height", "360"}, {"codec", "mpeg4"}, {"output", "/tmp/video one.mp4"}});
+    const std::list<std::string> expected{"-i", "/my photos/it's \"one\".jpg", "-vf", "scale=640:360,drawtext=text=a b", "-c:v", "mpeg4", "/tmp/video one.mp4"};
+    assert(arguments == expected);
+}
+
+void testOptionsAreExpanded() {
+    CommandTemplate command("-i {input} {options...} -c:v {codec} {input}");
+    assert(command.getPlaceholderCount() == 3);
+
+    const std::list<std::string> expanded{"-i", "a.mp4", "-crf", "28", "-preset", "fast", "-c:v", "libx265", "a.mp4"};
+    assert(command.bind({{"input", "a.mp4"}, {"options", " -crf 28  -preset fast "}, {"codec", "libx265"}}) == expanded);
+
+    const std::list<std::string> empty{"-i", "a.mp4", "-c:v", "libx265", "a.mp4"};
+    assert(command.bind({{"input", "a.mp4"}, {"options", ""}, {"codec", "libx265"}}) == empty);
+}
+
+void testBracesWithoutNamesAreKept() {
+    CommandTemplate command("-vf {} -metadata title={title -i {input}");
+    assert(command.getPlaceholderCount() == 1);
+
+    const std::list<std::string> expected{"-vf", "{}", "-metadata", "title={title", "-i", "b.mp4"};
+    assert(command.bind({{"input", "b.mp4"}}) == expected);
+}
+
+static bool bindFails(const CommandTemplate& command, const std::map<std::string, std::string>& values) {
+    try {
+        command.bind(values);
+    } catch (const std::invalid_argument&) {
+        return true;
+    }
+    return false;
+}
+
+void testMissingValuesAreRejected() {
+    CommandTemplate command("-i {input} {output}");
+    assert(bindFails(command, {{"input", "a.mp4"}}));
+    assert(bindFails(command, {{"input", "a.mp4"}, {"outptu", "c.mp4"}}));
+    assert(bindFails(command, {{"input", "a.mp4"}, {"output", "c.mp4"}, {"codec", "mpeg4"}}));
+
+    // VALUES ARE MATCHED BY NAME, NOT BY POSITION
+    assert(CommandTemplate::toString(command.bind({{"output", "c.mp4"}, {"input", "a b.mp4"}})) == "-i \"a b.mp4\" c.mp4");
+}
+
+void testEncodeArgumentsMatchScript() {
+    const std::string script = Video::generateEncodeVideoScript("/images/1.jpg", "/images/2.jpg", "/images/3.jpg", "/videos/video.mp4", "libx265", "yuv420p10le", "-crf 28 -preset fast ");
+    const std::list<std::string> arguments = Video::generateEncodeVideoArguments("/images/1.jpg", "/images/2.jpg", "/images/3.jpg", "/videos/video.mp4", "libx265", "yuv420p10le", "-crf 28 -preset fast ", "");
+    assert(arguments == FFmpegKitConfig::parseArguments(script));
+
+    // A PATH THAT WOULD END THE QUOTES OF THE SCRIPT STAYS ONE ARGUMENT
+    const std::list<std::string> quoted = Video::generateEncodeVideoArguments("/images/1.jpg", "/images/it's.jpg", "/images/3.jpg", "/videos/my video.mp4", "mpeg4", "yuv420p", "", "");
+    assert(quoted.size() == 19);
+    assert(*std::next(quoted.begin(), 5) == "/images/it's.jpg");
+    assert(quoted.back() == "/videos/my video.mp4");
+}
+
+void testCommandTemplate(void) {
+    testPlaceholdersAreBound();
+    testOptionsAreExpanded();
+    testBracesWithoutNamesAreKept();
+    testMissingValuesAreRejected();
+    testEncodeArgumentsMatchScript();
+    std::cout << "CommandTemplateTest passed." << std::endl;
+}
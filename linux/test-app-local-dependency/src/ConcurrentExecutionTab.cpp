@@ -23,27 +23,32 @@
 #include "ConcurrentExecutionTab.h"
 #include "Application.h"
 #include "Constants.h"
+#include "JobScheduler.h"
 #include "Log.h"
+#include "LogSink.h"
 #include "Popup.h"
+#include "SessionPlacement.h"
+#include "SessionRouter.h"
 #include "Video.h"
 #include <FFmpegKit.h>
 #include <FFmpegKitConfig.h>
+#include <chrono>
+#include <thread>
 
 using namespace ffmpegkit;
 
-static long sessionId1 = -1;
-static long sessionId2 = -1;
-static long sessionId3 = -1;
+static gboolean showJobCounts(ffmpegkittest::ConcurrentExecutionTab* concurrentExecutionTab) {
+    concurrentExecutionTab->showJobCounts();
+    return FALSE;
+}
 
-static gboolean appendLog(const std::pair<ffmpegkittest::ConcurrentExecutionTab*,const std::shared_ptr<Log>>* parameters) {
-    ffmpegkittest::ConcurrentExecutionTab* concurrentExecutionTab = parameters->first;
-    auto log = parameters->second;
-    concurrentExecutionTab->appendOutput(log->getMessage());
+static gboolean appendBenchmarkOutput(const std::pair<ffmpegkittest::ConcurrentExecutionTab*,const std::string>* parameters) {
+    parameters->first->appendOutput(parameters->second);
     delete parameters;
     return FALSE;
 }
 
-ffmpegkittest::ConcurrentExecutionTab::ConcurrentExecutionTab() {
+ffmpegkittest::ConcurrentExecutionTab::ConcurrentExecutionTab() : outputView("concurrent-execution") {
     encodeButton1.set_label("ENCODE 1");
     encodeButton1.set_size_request(120, 30);
     encodeButton1.set_tooltip_text(Constants::ConcurrentExecutionTestTooltipText);
@@ -88,20 +93,55 @@ ffmpegkittest::ConcurrentExecutionTab::ConcurrentExecutionTab() {
     Util::applyButtonStyle(cancelButton4);
     cancelButtonBox.pack_start(cancelButton4, Gtk::PACK_EXPAND_PADDING);
 
-    outputText.set_editable(false);
-    Util::applyOutputTextStyle(outputText);
-    outputTextWindow.add(outputText);
+    benchmarkButton.set_label("BENCHMARK");
+    benchmarkButton.set_size_request(120, 30);
+    benchmarkButton.set_tooltip_text(Constants::ConcurrentExecutionTestTooltipText);
+    benchmarkButton.signal_clicked().connect(sigc::mem_fun(*this, &ConcurrentExecutionTab::runBenchmark));
+    Util::applyButtonStyle(benchmarkButton);
+    jobBox.pack_start(benchmarkButton, Gtk::PACK_EXPAND_PADDING);
+    threadBudgetButton.set_label("THREAD BUDGET");
+    threadBudgetButton.set_size_request(120, 30);
+    threadBudgetButton.set_tooltip_text(Constants::ConcurrentExecutionTestTooltipText);
+    threadBudgetButton.signal_clicked().connect(sigc::mem_fun(*this, &ConcurrentExecutionTab::runThreadBudgetBenchmark));
+    Util::applyButtonStyle(threadBudgetButton);
+    jobBox.pack_start(threadBudgetButton, Gtk::PACK_EXPAND_PADDING);
+    placementButton.set_label("PLACEMENT");
+    placementButton.set_size_request(120, 30);
+    placementButton.set_tooltip_text(Constants::ConcurrentExecutionTestTooltipText);
+    placementButton.signal_clicked().connect(sigc::mem_fun(*this, &ConcurrentExecutionTab::runPlacementBenchmark));
+    Util::applyButtonStyle(placementButton);
+    jobBox.pack_start(placementButton, Gtk::PACK_EXPAND_PADDING);
+    warningsOnlyButton.set_label("WARNINGS ONLY");
+    warningsOnlyButton.set_tooltip_text(Constants::ConcurrentExecutionTestTooltipText);
+    jobBox.pack_start(warningsOnlyButton, Gtk::PACK_EXPAND_PADDING);
+    jobBox.pack_start(jobCountsLabel, Gtk::PACK_EXPAND_PADDING);
+
+    for (int buttonNumber = 1; buttonNumber <= 3; buttonNumber++) {
+        logConsumerIds[buttonNumber - 1] = LogSink::getInstance().registerConsumer([this, buttonNumber](const std::string& batch) {
+            appendSessionOutput(buttonNumber, batch);
+        });
+        atLineStart[buttonNumber - 1] = true;
+        jobIds[buttonNumber - 1] = -1;
+    }
+    benchmarkRunning = false;
+
+    // COUNTS CHANGE ON FFMPEG THREADS, THE LABEL IS UPDATED ON THE MAIN LOOP
+    JobScheduler::getInstance().setStateListener([this]() {
+        g_idle_add((GSourceFunc)::showJobCounts, this);
+    });
+    showJobCounts();
+
+    // THREE INTERLEAVED ENCODES ARE EASIER TO READ WHEN THE VIEW ONLY SHOWS PROBLEMS, WHICH IS OPT-IN
+    logFilterId = SessionRouter::getInstance().registerLogFilter(LogFilter(LevelAVLogWarning));
 
     pack_start(encodeButtonBox, Gtk::PACK_SHRINK);
     pack_start(cancelButtonBox, Gtk::PACK_SHRINK);
-    add(outputTextWindow);
+    pack_start(jobBox, Gtk::PACK_SHRINK);
+    add(outputView);
 }
 
 void ffmpegkittest::ConcurrentExecutionTab::setActive() {
     std::cout << "Concurrent Execution Tab Activated" << std::endl;
-    FFmpegKitConfig::enableLogCallback([this](auto log) {
-        g_idle_add((GSourceFunc)appendLog, new std::pair<ConcurrentExecutionTab*,const std::shared_ptr<Log>>(this, log));
-    });
 }
 
 void ffmpegkittest::ConcurrentExecutionTab::setParentWindow(Gtk::Window* parentWindow) {
@@ -109,18 +149,32 @@ void ffmpegkittest::ConcurrentExecutionTab::setParentWindow(Gtk::Window* parentW
 }
 
 void ffmpegkittest::ConcurrentExecutionTab::appendOutput(const std::string& string) {
-    outputText.get_buffer()->set_text(outputText.get_buffer()->get_text() + string);
-    Glib::RefPtr<Gtk::Adjustment> adj = outputText.get_vadjustment();
-    adj->set_value(adj->get_upper());
+    outputView.append(string);
 }
 
-void ffmpegkittest::ConcurrentExecutionTab::clearOutput() {
-    outputText.get_buffer()->set_text("");
+void ffmpegkittest::ConcurrentExecutionTab::showJobCounts() {
+    JobScheduler& scheduler = JobScheduler::getInstance();
+    jobCountsLabel.set_text("queued " + std::to_string(scheduler.getQueuedCount()) + " | running " + std::to_string(scheduler.getRunningCount()) + "/" + std::to_string(scheduler.getMaxRunningJobs()) + " | done " + std::to_string(scheduler.getDoneCount()));
 }
 
-void ffmpegkittest::ConcurrentExecutionTab::encodeVideo(const int buttonNumber) {
-    clearOutput();
+void ffmpegkittest::ConcurrentExecutionTab::appendSessionOutput(const int buttonNumber, const std::string& string) {
+    const std::string prefix = std::to_string(buttonNumber) + ": ";
+    std::string output;
+    output.reserve(string.size() + prefix.size());
+
+    // EACH LINE IS TAGGED WITH ITS BUTTON SINCE ALL SESSIONS SHARE THE SAME VIEW
+    for (const char c : string) {
+        if (atLineStart[buttonNumber - 1]) {
+            output.append(prefix);
+        }
+        output.push_back(c);
+        atLineStart[buttonNumber - 1] = (c == '\n');
+    }
+
+    appendOutput(output);
+}
 
+void ffmpegkittest::ConcurrentExecutionTab::encodeVideo(const int buttonNumber) {
     std::string image1File = Application::getApplicationInstallDirectory() + "/share/images/machupicchu.jpg";
     std::string image2File = Application::getApplicationInstallDirectory() + "/share/images/pyramid.jpg";
     std::string image3File = Application::getApplicationInstallDirectory() + "/share/images/stonehenge.jpg";
@@ -132,7 +186,8 @@ void ffmpegkittest::ConcurrentExecutionTab::encodeVideo(const int buttonNumber)
 
     std::cout << "FFmpeg process starting for button " << buttonNumber << " with arguments: '" << ffmpegCommand << "'." << std::endl;
 
-    auto session = FFmpegKit::executeAsync(ffmpegCommand, [this, buttonNumber](auto session) {
+    // WAITS IN THE QUEUE WHEN ALL WORKERS ARE BUSY
+    jobIds[buttonNumber - 1] = JobScheduler::getInstance().submitFFmpeg(ffmpegCommand, [buttonNumber](auto session) {
         const auto state = session->getState();
         auto returnCode = session->getReturnCode();
 
@@ -141,51 +196,150 @@ void ffmpegkittest::ConcurrentExecutionTab::encodeVideo(const int buttonNumber)
         } else {
             std::cout << "FFmpeg process ended with state " << FFmpegKitConfig::sessionStateToString(state) << " and rc " << returnCode << " for button " << buttonNumber << " with sessionId " << session->getSessionId() << "." << session->getFailStackTrace() << std::endl;
         }
-    });
+    }, JobScheduler::PriorityNormal, logConsumerIds[buttonNumber - 1], 0, 0, warningsOnlyButton.get_active() ? logFilterId : 0);
 
-    const long sessionId = session->getSessionId();
+    std::cout << "FFmpeg job " << jobIds[buttonNumber - 1] << " submitted for button " << buttonNumber << "." << std::endl;
 
-    std::cout << "Async FFmpeg process started for button " << buttonNumber << " with sessionId " << session->getSessionId() << "." << std::endl;
+    Application::listFFmpegSessions();
 
-    switch (buttonNumber) {
-        case 1: {
-            sessionId1 = sessionId;
-        }
-        break;
-        case 2: {
-            sessionId2 = sessionId;
-        }
-        break;
-        default: {
-            sessionId3 = sessionId;
-        }
+    std::cout << SessionRouter::getInstance().getFilteredCount() << " log lines below warning level filtered so far." << std::endl;
+}
+
+void ffmpegkittest::ConcurrentExecutionTab::cancel(const int buttonNumber) {
+    if (buttonNumber == 0) {
+        std::cout << "Cancelling all FFmpeg jobs." << std::endl;
+        JobScheduler::getInstance().cancelAll();
+        return;
     }
 
-    Application::listFFmpegSessions();
+    const long jobId = jobIds[buttonNumber - 1];
+
+    std::cout << "Cancelling FFmpeg job for button " << buttonNumber << " with jobId " << jobId << "." << std::endl;
+
+    if (jobId >= 0) {
+        JobScheduler::getInstance().cancel(jobId);
+    }
 }
 
-void ffmpegkittest::ConcurrentExecutionTab::cancel(const int buttonNumber) {
-    long sessionId = 0;
+void ffmpegkittest::ConcurrentExecutionTab::runBenchmark() {
+    if (benchmarkRunning.exchange(true)) {
+        std::cout << "Concurrent execution benchmark is already running." << std::endl;
+        return;
+    }
 
-    switch (buttonNumber) {
-        case 1: {
-            sessionId = sessionId1;
-        }
-        break;
-        case 2: {
-            sessionId = sessionId2;
+    std::cout << "Testing CONCURRENT EXECUTION throughput." << std::endl;
+
+    // WAITING FOR EACH ROUND BLOCKS, SO ROUNDS RUN OUTSIDE THE MAIN LOOP
+    std::thread([this]() {
+        const int jobCount = 16;
+        const int parallelisms[] = {1, 2, 4, 8, 16};
+
+        for (const int parallelism : parallelisms) {
+            JobScheduler scheduler(parallelism, [](const long sessionId) {
+                FFmpegKit::cancel(sessionId);
+            });
+            const BenchmarkRound round = runBenchmarkRound(scheduler, jobCount, "mpeg4");
+
+            appendBenchmarkResult(std::to_string(jobCount) + " slideshow encodes with " + std::to_string(parallelism) + " parallel jobs took " + std::to_string(round.elapsed) + " ms, " + std::to_string(round.failedCount) + " failed.\n");
         }
-        break;
-        case 3: {
-            sessionId = sessionId3;
+
+        benchmarkRunning = false;
+    }).detach();
+}
+
+void ffmpegkittest::ConcurrentExecutionTab::runThreadBudgetBenchmark() {
+    if (benchmarkRunning.exchange(true)) {
+        std::cout << "Concurrent execution benchmark is already running." << std::endl;
+        return;
+    }
+
+    std::cout << "Testing CONCURRENT EXECUTION thread budgets." << std::endl;
+
+    std::thread([this]() {
+        const int cores = JobScheduler::getPhysicalCoreCount();
+
+        // EVERY ROUND STARTS ALL OF ITS ENCODES AT ONCE, ONLY THE THREAD OPTIONS DIFFER
+        for (int budgeted = 0; budgeted <= 1; budgeted++) {
+            for (int concurrentJobs = 1; concurrentJobs <= 8; concurrentJobs++) {
+                ThreadBudget threadBudget(cores);
+                JobScheduler scheduler(concurrentJobs, [](const long sessionId) {
+                    FFmpegKit::cancel(sessionId);
+                }, budgeted ? &threadBudget : nullptr);
+                const BenchmarkRound round = runBenchmarkRound(scheduler, concurrentJobs, "libx264");
+                const double fps = round.elapsed > 0 ? round.frameCount * 1000.0 / round.elapsed : 0;
+
+                appendBenchmarkResult(std::to_string(concurrentJobs) + " concurrent libx264 encodes " + (budgeted ? "with" : "without") + " thread budgets: " + std::to_string((int)fps) + " fps in total, " + std::to_string(round.failedCount) + " failed.\n");
+            }
         }
+
+        benchmarkRunning = false;
+    }).detach();
+}
+
+void ffmpegkittest::ConcurrentExecutionTab::runPlacementBenchmark() {
+    if (benchmarkRunning.exchange(true)) {
+        std::cout << "Concurrent execution benchmark is already running." << std::endl;
+        return;
     }
 
-    std::cout << "Cancelling FFmpeg process for button " << buttonNumber << " with sessionId " << sessionId << "." << std::endl;
+    std::cout << "Testing CONCURRENT EXECUTION placement." << std::endl;
+
+    std::thread([this]() {
+        SessionPlacement& placement = SessionPlacement::getInstance();
+        const PlacementPolicy previousPolicy = placement.getPolicy();
+        const PlacementPolicy policies[] = {PlacementNone, PlacementRoundRobin, PlacementPacked};
+        const int concurrentJobs = std::max(2, JobScheduler::getPhysicalCoreCount() / JobScheduler::DefaultJobThreads);
+
+        if (placement.getNodeCount() < 2) {
+            appendBenchmarkResult("Single NUMA node found, placement policies leave sessions unpinned.\n");
+        }
+
+        for (const PlacementPolicy policy : policies) {
+            placement.setPolicy(policy);
+            JobScheduler scheduler(concurrentJobs, [](const long sessionId) {
+                FFmpegKit::cancel(sessionId);
+            }, &ThreadBudget::getInstance());
+            const BenchmarkRound round = runBenchmarkRound(scheduler, concurrentJobs * 2, "libx264");
+            const double fps = round.elapsed > 0 ? round.frameCount * 1000.0 / round.elapsed : 0;
+
+            appendBenchmarkResult(std::to_string(concurrentJobs * 2) + " libx264 encodes on " + std::to_string(placement.getNodeCount()) + " nodes with " + SessionPlacement::policyToString(policy) + " placement: " + std::to_string((int)fps) + " fps in total, " + std::to_string(round.failedCount) + " failed.\n");
+        }
+
+        placement.setPolicy(previousPolicy);
+        benchmarkRunning = false;
+    }).detach();
+}
+
+ffmpegkittest::ConcurrentExecutionTab::BenchmarkRound ffmpegkittest::ConcurrentExecutionTab::runBenchmarkRound(JobScheduler& scheduler, const int jobCount, const std::string& videoCodec) {
+    const std::string image1File = Application::getApplicationInstallDirectory() + "/share/images/machupicchu.jpg";
+    const std::string image2File = Application::getApplicationInstallDirectory() + "/share/images/pyramid.jpg";
+    const std::string image3File = Application::getApplicationInstallDirectory() + "/share/images/stonehenge.jpg";
+    std::atomic<int> failedCount(0);
+    std::atomic<long> frameCount(0);
 
-    if (sessionId == 0) {
-        FFmpegKit::cancel();
-    } else {
-        FFmpegKit::cancel(sessionId);
+    const auto start = std::chrono::steady_clock::now();
+    for (int i = 0; i < jobCount; i++) {
+        const std::string videoFile = Application::getApplicationCacheDirectory() + "/benchmark" + std::to_string(i) + ".mp4";
+        scheduler.submitFFmpeg(Video::generateEncodeVideoScript(image1File, image2File, image3File, videoFile, videoCodec, ""), [&failedCount, &frameCount](auto session) {
+            if (!ReturnCode::isSuccess(session->getReturnCode())) {
+                failedCount++;
+            }
+            auto statistics = session->getAllStatistics();
+            if (!statistics->empty()) {
+                frameCount += statistics->back()->getVideoFrameNumber();
+            }
+        });
     }
+    scheduler.waitUntilIdle();
+
+    BenchmarkRound round;
+    round.elapsed = std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::steady_clock::now() - start).count();
+    round.failedCount = failedCount;
+    round.frameCount = frameCount;
+    return round;
+}
+
+void ffmpegkittest::ConcurrentExecutionTab::appendBenchmarkResult(const std::string& result) {
+    std::cout << result;
+    g_idle_add((GSourceFunc)appendBenchmarkOutput, new std::pair<ConcurrentExecutionTab*,const std::string>(this, result));
 }
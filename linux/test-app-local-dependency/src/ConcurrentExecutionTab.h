@@ -23,7 +23,10 @@
 #ifndef FFMPEG_KIT_TEST_CONCURRENT_EXECUTION_TAB_H
 #define FFMPEG_KIT_TEST_CONCURRENT_EXECUTION_TAB_H
 
+#include "JobScheduler.h"
+#include "OutputView.h"
 #include "Util.h"
+#include <atomic>
 #include <gtkmm.h>
 
 namespace ffmpegkittest {
@@ -34,11 +37,23 @@ namespace ffmpegkittest {
             void setActive();
             void setParentWindow(Gtk::Window* parentWindow);
             void appendOutput(const std::string& string);
+            void showJobCounts();
 
         private:
-            void clearOutput();
+            struct BenchmarkRound {
+                long elapsed;
+                int failedCount;
+                long frameCount;
+            };
+
+            void appendSessionOutput(const int buttonNumber, const std::string& string);
             void encodeVideo(const int buttonNumber);
             void cancel(const int buttonNumber);
+            void runBenchmark();
+            void runThreadBudgetBenchmark();
+            void runPlacementBenchmark();
+            BenchmarkRound runBenchmarkRound(JobScheduler& scheduler, const int jobCount, const std::string& videoCodec);
+            void appendBenchmarkResult(const std::string& result);
 
             Gtk::Button encodeButton1;
             Gtk::Button encodeButton2;
@@ -49,9 +64,19 @@ namespace ffmpegkittest {
             Gtk::Button cancelButton3;
             Gtk::Button cancelButton4;
             Gtk::HBox cancelButtonBox;
-            Gtk::TextView outputText;
-            Gtk::ScrolledWindow outputTextWindow;
+            Gtk::Button benchmarkButton;
+            Gtk::Button threadBudgetButton;
+            Gtk::Button placementButton;
+            Gtk::CheckButton warningsOnlyButton;
+            Gtk::Label jobCountsLabel;
+            Gtk::HBox jobBox;
+            OutputView outputView;
             Gtk::Window* parentWindow;
+            int logConsumerIds[3];
+            bool atLineStart[3];
+            int logFilterId;
+            long jobIds[3];
+            std::atomic<bool> benchmarkRunning;
     };
 
 }
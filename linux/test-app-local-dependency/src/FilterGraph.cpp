@@ -0,0 +1,193 @@
+/*
+ * Copyright (c) 2022 Taner Sener
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#include "FilterGraph.h"
+#include <mutex>
+
+namespace ffmpegkittest {
+
+    static std::mutex graphCacheMutex;
+    static std::unordered_map<std::string, std::string> graphCache;
+
+}
+
+std::string ffmpegkittest::FilterGraph::cached(const std::string& key, const Builder& builder) {
+    {
+        std::lock_guard<std::mutex> lock(graphCacheMutex);
+        auto graph = graphCache.find(key);
+        if (graph != graphCache.end()) {
+            return graph->second;
+        }
+    }
+
+    FilterGraph graph;
+    builder(graph);
+    const std::string graphString = graph.toString();
+
+    std::lock_guard<std::mutex> lock(graphCacheMutex);
+
+    // PARAMETER SETS ARE FEW, A FULL CACHE IS SIMPLY STARTED OVER
+    if (graphCache.size() >= MaxCachedGraphs) {
+        graphCache.clear();
+    }
+    graphCache[key] = graphString;
+
+    return graphString;
+}
+
+void ffmpegkittest::FilterGraph::clearCache() {
+    std::lock_guard<std::mutex> lock(graphCacheMutex);
+    graphCache.clear();
+}
+
+ffmpegkittest::FilterPad ffmpegkittest::FilterGraph::input(const std::string& stream) {
+    const std::string key = "[" + stream + "]";
+
+    auto existing = nodeIndex.find(key);
+    if (existing != nodeIndex.end()) {
+        return FilterPad{existing->second};
+    }
+
+    nodes.push_back(Node{stream, "", {}, {}, 0, -1});
+    nodeIndex[key] = (int)nodes.size() - 1;
+
+    return FilterPad{(int)nodes.size() - 1};
+}
+
+ffmpegkittest::FilterPad ffmpegkittest::FilterGraph::source(const std::string& filters) {
+    return chain(std::vector<FilterPad>(), filters);
+}
+
+ffmpegkittest::FilterPad ffmpegkittest::FilterGraph::chain(const FilterPad& input, const std::string& filters) {
+    return chain(std::vector<FilterPad>{input}, filters);
+}
+
+ffmpegkittest::FilterPad ffmpegkittest::FilterGraph::chain(const std::vector<FilterPad>& inputs, const std::string& filters) {
+    std::string key = filters;
+    for (const FilterPad& input : inputs) {
+        key += "|" + std::to_string(input.node);
+    }
+
+    // THE SAME FILTERS ON THE SAME INPUTS PRODUCE THE SAME FRAMES, SO THE NODE IS SHARED
+    auto existing = nodeIndex.find(key);
+    if (existing != nodeIndex.end()) {
+        return FilterPad{existing->second};
+    }
+
+    const int node = (int)nodes.size();
+    Node created{"", filters, {}, {}, 0, -1};
+    for (const FilterPad& input : inputs) {
+        created.inputs.push_back(input.node);
+        nodes[input.node].consumers++;
+        nodes[input.node].consumer = node;
+    }
+    nodes.push_back(created);
+    nodeIndex[key] = node;
+
+    return FilterPad{node};
+}
+
+void ffmpegkittest::FilterGraph::output(const FilterPad& pad, const std::string& label) {
+    nodes[pad.node].outputs.push_back(label);
+}
+
+std::string ffmpegkittest::FilterGraph::toString() const {
+    std::vector<std::vector<std::string>> labels(nodes.size());
+    std::vector<size_t> nextLabel(nodes.size());
+
+    for (size_t i = 0; i < nodes.size(); i++) {
+        const Node& node = nodes[i];
+        labels[i] = node.outputs;
+        nextLabel[i] = node.outputs.size();
+
+        if (!node.stream.empty() && node.consumers == 1 && node.outputs.empty()) {
+            labels[i].push_back(node.stream);
+        } else if (node.consumers == 1 && node.outputs.empty()) {
+            labels[i].push_back("s" + std::to_string(i));
+        } else {
+            for (int k = 0; k < node.consumers; k++) {
+                labels[i].push_back("s" + std::to_string(i) + "_" + std::to_string(k));
+            }
+        }
+    }
+
+    std::string graph;
+    std::vector<int> chainNodes;
+
+    for (size_t i = 0; i < nodes.size(); i++) {
+        const Node& node = nodes[i];
+        const size_t outputCount = labels[i].size();
+
+        if (!node.stream.empty()) {
+
+            // AN INPUT USED ONCE IS REFERENCED DIRECTLY
+            if (node.consumers == 1 && node.outputs.empty()) {
+                continue;
+            }
+            graph += (graph.empty() ? "[" : ";[") + node.stream + "]" + (outputCount > 1 ? "split=" + std::to_string(outputCount) : "null");
+        } else {
+            if (isAbsorbed(i)) {
+                continue;
+            }
+
+            // SINGLE INPUT NODES USED ONLY BY THE NEXT NODE ARE JOINED INTO ONE CHAIN
+            chainNodes.clear();
+            int head = (int)i;
+            chainNodes.push_back(head);
+            while (nodes[head].inputs.size() == 1 && isAbsorbed(nodes[head].inputs[0])) {
+                head = nodes[head].inputs[0];
+                chainNodes.push_back(head);
+            }
+
+            if (!graph.empty()) {
+                graph += ";";
+            }
+            for (const int input : nodes[head].inputs) {
+                graph += "[" + labels[input][nextLabel[input]++] + "]";
+            }
+            for (auto chainNode = chainNodes.rbegin(); chainNode != chainNodes.rend(); ++chainNode) {
+                if (chainNode != chainNodes.rbegin()) {
+                    graph += ",";
+                }
+                graph += nodes[*chainNode].filters;
+            }
+            if (outputCount > 1) {
+                graph += ",split=" + std::to_string(outputCount);
+            }
+        }
+
+        for (const std::string& label : labels[i]) {
+            graph += "[" + label + "]";
+        }
+    }
+
+    return graph;
+}
+
+int ffmpegkittest::FilterGraph::getNodeCount() const {
+    return (int)nodes.size();
+}
+
+bool ffmpegkittest::FilterGraph::isAbsorbed(const int node) const {
+    const Node& candidate = nodes[node];
+    return candidate.stream.empty() && candidate.consumers == 1 && candidate.outputs.empty() && nodes[candidate.consumer].inputs.size() == 1;
+}
@@ -0,0 +1,78 @@
+/*
+ * Copyright (c) 2022 Taner Sener
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#ifndef FFMPEG_KIT_TEST_FILTER_GRAPH_H
+#define FFMPEG_KIT_TEST_FILTER_GRAPH_H
+
+#include <functional>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+namespace ffmpegkittest {
+
+    struct FilterPad {
+        int node;
+    };
+
+    /**
+     * Builds a filter_complex string from typed nodes instead of hand written labels. Adding
+     * the same filters to the same inputs twice returns the existing node, so identical sub
+     * chains are built once. A pad used more than once is split automatically and linear
+     * chains are emitted with commas. Built graphs can be cached per parameter set.
+     */
+    class FilterGraph {
+        public:
+            static constexpr const int MaxCachedGraphs = 64;
+
+            typedef std::function<void(FilterGraph& graph)> Builder;
+
+            static std::string cached(const std::string& key, const Builder& builder);
+            static void clearCache();
+
+            FilterPad input(const std::string& stream);
+            FilterPad source(const std::string& filters);
+            FilterPad chain(const FilterPad& input, const std::string& filters);
+            FilterPad chain(const std::vector<FilterPad>& inputs, const std::string& filters);
+            void output(const FilterPad& pad, const std::string& label);
+            std::string toString() const;
+            int getNodeCount() const;
+
+        private:
+            struct Node {
+                std::string stream;
+                std::string filters;
+                std::vector<int> inputs;
+                std::vector<std::string> outputs;
+                int consumers;
+                int consumer;
+            };
+
+            bool isAbsorbed(const int node) const;
+
+            std::vector<Node> nodes;
+            std::unordered_map<std::string, int> nodeIndex;
+    };
+
+}
+
+#endif // FFMPEG_KIT_TEST_FILTER_GRAPH_H
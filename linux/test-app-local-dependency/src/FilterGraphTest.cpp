@@ -0,0 +1,201 @@
+/*
+ * Copyright (c) 2022 Taner Sener
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#include "FilterGraphTest.h"
+#include "FilterGraph.h"
+#include "Video.h"
+#include <iostream>
+#include <set>
+
+using namespace ffmpegkittest;
+
+static int countOccurrences(const std::string& string, const std::string& substring) {
+    int count = 0;
+    for (size_t position = string.find(substring); position != std::string::npos; position = string.find(substring, position + 1)) {
+        count++;
+    }
+    return count;
+}
+
+/**
+ * Collects the "<width>x<height>" sizes of every pad filter and every sized colour source in a graph.
+ */
+static std::set<std::string> collectFrameSizes(const std::string& graph) {
+    std::set<std::string> sizes;
+    for (size_t position = graph.find("pad=width="); position != std::string::npos; position = graph.find("pad=width=", position + 1)) {
+        const size_t width = position + 10;
+        const size_t height = graph.find(":height=", width) + 8;
+        sizes.insert(graph.substr(width, graph.find(':', width) - width) + "x" + graph.substr(height, graph.find(':', height) - height));
+    }
+    for (size_t position = graph.find("color="); position != std::string::npos; position = graph.find("color=", position + 1)) {
+        const size_t size = graph.find(":s=", position);
+        if (size != std::string::npos && size < graph.find_first_of(",;", position)) {
+            sizes.insert(graph.substr(size + 3, graph.find_first_of(":,;", size + 3) - size - 3));
+        }
+    }
+    return sizes;
+}
+
+void testLinearChain() {
+    FilterGraph graph;
+    auto scaled = graph.chain(graph.input("0:v"), "scale=640:360");
+    graph.output(graph.chain(scaled, "format=yuv420p"), "video");
+
+    assert(graph.toString() == "[0:v]scale=640:360,format=yuv420p[video]");
+}
+
+void testSharedPadIsSplit() {
+    FilterGraph graph;
+    auto padded = graph.chain(graph.input("0:v"), "pad=640:480");
+    auto first = graph.chain(padded, "trim=duration=1");
+    auto second = graph.chain(padded, "trim=duration=2");
+    graph.output(graph.chain({first, second}, "concat=n=2"), "video");
+
+    assert(graph.toString() == "[0:v]pad=640:480,split=2[s1_0][s1_1];[s1_0]trim=duration=1[s2];[s1_1]trim=duration=2[s3];[s2][s3]concat=n=2[video]");
+}
+
+void testIdenticalChainsAreDeduplicated() {
+    FilterGraph graph;
+    auto input = graph.input("0:v");
+    auto first = graph.chain(graph.chain(input, "scale=640:360"), "trim=duration=1");
+    auto second = graph.chain(graph.chain(graph.input("0:v"), "scale=640:360"), "trim=duration=1");
+    assert(first.node == second.node);
+    assert(graph.getNodeCount() == 3);
+
+    graph.output(graph.chain({first, second}, "blend=all_mode=average"), "video");
+    assert(graph.toString() == "[0:v]scale=640:360,trim=duration=1,split=2[s2_0][s2_1];[s2_0][s2_1]blend=all_mode=average[video]");
+}
+
+void testInputsAndSinks() {
+    FilterGraph graph;
+    auto background = graph.input("1:v");
+    auto first = graph.chain({background, graph.input("0:v")}, "overlay");
+    auto second = graph.chain({background, first}, "overlay");
+    graph.output(second, "video");
+    graph.chain(second, "nullsink");
+
+    assert(graph.toString() == "[1:v]split=2[s0_0][s0_1];[s0_0][0:v]overlay[s2];[s0_1][s2]overlay,split=2[video][s3_0];[s3_0]nullsink");
+}
+
+void testCachedGraphs() {
+    int builds = 0;
+    FilterGraph::clearCache();
+
+    auto build = [&builds](FilterGraph& graph) {
+        builds++;
+        graph.output(graph.chain(graph.input("0:v"), "null"), "video");
+    };
+    assert(FilterGraph::cached("null", build) == "[0:v]null[video]");
+    assert(FilterGraph::cached("null", build) == "[0:v]null[video]");
+    assert(builds == 1);
+
+    FilterGraph::clearCache();
+    FilterGraph::cached("null", build);
+    assert(builds == 2);
+}
+
+void testSlideshowGraph() {
+    const std::string script = Video::generateEncodeVideoScript("1.jpg", "2.jpg", "3.jpg", "video.mp4", "mpeg4", "");
+
+    // EVERY IMAGE IS FITTED AND PADDED ONCE, THE SHARED TRANSITION SEGMENT IS TRIMMED ONCE
+    assert(countOccurrences(script, "setsar=sar=1/1") == 3);
+    assert(countOccurrences(script, "pad=width=640") == 3);
+    assert(countOccurrences(script, "trim=duration=1") == 3);
+    assert(countOccurrences(script, "alphamerge") == 2);
+    assert(countOccurrences(script, "[video]") == 2);
+
+    // THE REPORTED DURATION IS THE SUM OF THE TRIMMED SEGMENTS
+    assert(countOccurrences(script, "trim=duration=3,select=lte(n\\,90)") == 1);
+    assert(countOccurrences(script, "trim=duration=2,select=lte(n\\,60)") == 2);
+    assert(Video::getEncodeVideoDuration() == (3 + 2 + 2 + 1 + 1) * 1000);
+
+    // BOTH TRANSITIONS SHARE ONE WIPE MASK AND NO PER PIXEL EXPRESSION IS EVALUATED
+    assert(countOccurrences(script, "color=white") == 1);
+    assert(countOccurrences(script, "all_expr") == 0);
+
+    // CACHED GRAPHS ARE KEYED BY THE PARAMETERS THAT CHANGE THEM
+    const std::string tenBit = Video::generateEncodeVideoScript("1.jpg", "2.jpg", "3.jpg", "video.mp4", "libx265", "yuv420p10le", "");
+    assert(tenBit.find("format=yuv420p10le[video]") != std::string::npos);
+    assert(Video::generateEncodeVideoScript("1.jpg", "2.jpg", "3.jpg", "video.mp4", "mpeg4", "") == script);
+
+    // IMAGES ARE CONVERTED INTO THE ENCODER FORMAT BY THEIR FIRST SCALE AND PADDED WITH A COLOUR IT CAN REPRESENT
+    assert(countOccurrences(script, "min(ih,426))',format=yuv420p,scale=") == 3);
+    assert(countOccurrences(script, "color=black,") == 3);
+    assert(countOccurrences(script, "#00000000") == 0);
+    assert(countOccurrences(tenBit, "min(ih,426))',format=yuv420p10le,scale=") == 3);
+    assert(countOccurrences(tenBit, "format=gray10le") == 1);
+    assert(countOccurrences(tenBit, "format=yuv420p10:shortest=1") == 2);
+    const std::string negotiated = Video::generateEncodeFilterGraph("yuv420p", "", true, false);
+    assert(countOccurrences(negotiated, "format=") == 6);
+    assert(negotiated != Video::generateEncodeFilterGraph("yuv420p", "", true, true));
+
+    // STILL IMAGES ARE DECODED ONCE AND REPLAYED BY THE GRAPH INSTEAD OF LOOPED BY THE DEMUXER
+    assert(countOccurrences(script, "-loop 1") == 0);
+    assert(countOccurrences(script, "loop=loop=-1") == 3);
+    const std::string looped = Video::generateEncodeVideoScript("1.jpg", "2.jpg", "3.jpg", "video.mp4", "mpeg4", "yuv420p", "", "", false);
+    assert(countOccurrences(looped, "-loop 1") == 3);
+    assert(countOccurrences(looped, "loop=loop=-1") == 0);
+}
+
+void testWipeMaskMatchesPaddedImages() {
+    const std::string canvas = std::to_string((int)Video::CanvasWidth) + "x" + std::to_string((int)Video::CanvasHeight);
+
+    // A 4:2:0 PAD ROUNDS AN ODD HEIGHT DOWN, ALPHAMERGE THEN REJECTS A MASK OF THE UNROUNDED SIZE
+    assert(Video::CanvasWidth % 2 == 0 && Video::CanvasHeight % 2 == 0);
+    for (const std::string pixelFormat : {"yuv420p", "yuv420p10le", "yuv444p"}) {
+        const std::string graph = Video::generateEncodeFilterGraph(pixelFormat, "", true, true);
+        assert(countOccurrences(graph, "alphamerge") == 2);
+        assert(collectFrameSizes(graph) == std::set<std::string>{canvas});
+    }
+    assert(collectFrameSizes(Video::generateEncodeFilterGraph("yuv420p", "", true, false)) == std::set<std::string>{canvas});
+    assert(collectFrameSizes(Video::generateShakingFilterGraph(3, false, "")) == std::set<std::string>{canvas});
+}
+
+void testShakingGraph() {
+    const std::string script = Video::generateShakingVideoScript("1.jpg", "2.jpg", "3.jpg", "video.mp4");
+
+    // THE JITTER MOVES A CROP WINDOW OVER IMAGES PADDED ONCE, NO BACKGROUND INPUT IS COMPOSED
+    assert(countOccurrences(script, "-f lavfi") == 0);
+    assert(countOccurrences(script, "overlay=") == 0);
+    assert(countOccurrences(script, "pad=width=646:height=428") == 3);
+    assert(countOccurrences(script, "setpts=N/25/TB,trim=duration=3,crop=w=640:h=426") == 3);
+    assert(Video::getShakingVideoDuration() == 3 * 3 * 1000);
+
+    const std::string overlaid = Video::generateShakingFilterGraph(3, false, "");
+    assert(countOccurrences(overlaid, "color=black:s=640x426") == 1);
+    assert(countOccurrences(overlaid, "overlay=") == 3);
+
+    const std::string tenMinutes = Video::generateShakingFilterGraph(200, true, "");
+    assert(countOccurrences(tenMinutes, "trim=duration=200,crop=") == 3);
+}
+
+void testFilterGraph(void) {
+    testLinearChain();
+    testSharedPadIsSplit();
+    testIdenticalChainsAreDeduplicated();
+    testInputsAndSinks();
+    testCachedGraphs();
+    testSlideshowGraph();
+    testWipeMaskMatchesPaddedImages();
+    testShakingGraph();
+    std::cout << "FilterGraphTest passed." << std::endl;
+}
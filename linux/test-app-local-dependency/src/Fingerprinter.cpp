@@ -0,0 +1,226 @@
+/*
+ * Copyright (c) 2022 Taner Sener
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#include "Fingerprinter.h"
+#include "CommandTemplate.h"
+#include "SessionRouter.h"
+#include <FFmpegKit.h>
+#include <FFmpegKitConfig.h>
+#include <algorithm>
+#include <cerrno>
+#include <chrono>
+#include <cstring>
+#include <dirent.h>
+#include <fcntl.h>
+#include <iostream>
+#include <memory>
+#include <mutex>
+#include <poll.h>
+#include <sys/stat.h>
+#include <thread>
+#include <unistd.h>
+
+using namespace ffmpegkit;
+
+namespace ffmpegkittest {
+
+    struct FingerprintPipe {
+        int fd;
+        std::string output;
+        std::atomic<bool> sessionCompleted;
+        std::thread reader;
+    };
+
+    static void readFingerprintPipe(FingerprintPipe* pipe, const int pollInterval) {
+        char buffer[4096];
+
+        for (;;) {
+            struct pollfd descriptor = {pipe->fd, POLLIN, 0};
+            const int ready = poll(&descriptor, 1, pollInterval);
+
+            if (ready > 0 && (descriptor.revents & POLLIN) != 0) {
+                const ssize_t length = read(pipe->fd, buffer, sizeof(buffer));
+                if (length > 0) {
+                    pipe->output.append(buffer, length);
+                    continue;
+                }
+
+                // ZERO MEANS THE MUXER CLOSED ITS END
+                if (length == 0 || (errno != EAGAIN && errno != EINTR)) {
+                    break;
+                }
+            } else if (ready > 0 && (descriptor.revents & (POLLHUP | POLLERR)) != 0) {
+                break;
+            }
+
+            // A SESSION THAT FAILED BEFORE OPENING ITS OUTPUT NEVER CONNECTS, ONE THAT DID HAS BEEN DRAINED
+            if (ready == 0 && pipe->sessionCompleted.load()) {
+                break;
+            }
+        }
+    }
+
+}
+
+std::list<std::string> ffmpegkittest::Fingerprinter::generateFingerprintArguments(const std::list<std::string>& inputArguments, const std::string& outputPath) {
+    static const CommandTemplate outputTemplate("-vn -f chromaprint -fp_format 2 {output}");
+
+    std::list<std::string> arguments{"-hide_banner", "-y"};
+    arguments.insert(arguments.end(), inputArguments.begin(), inputArguments.end());
+    arguments.splice(arguments.end(), outputTemplate.bind({{"output", outputPath}}));
+    return arguments;
+}
+
+ffmpegkittest::Fingerprinter::Fingerprinter(const std::string& pipeDirectory, const int logConsumerId) :
+    pipeDirectory(pipeDirectory),
+    logConsumerId(logConsumerId),
+    nextPipeId(1),
+    batchScheduler(1, [](const long sessionId) {
+        FFmpegKit::cancel(sessionId);
+    }) {
+}
+
+long ffmpegkittest::Fingerprinter::fingerprint(const std::string& inputOptions, const FingerprintCallback& callback) {
+    return fingerprint(FFmpegKitConfig::parseArguments(inputOptions.c_str()), callback);
+}
+
+long ffmpegkittest::Fingerprinter::fingerprint(const std::list<std::string>& inputArguments, const FingerprintCallback& callback) {
+    const std::string input = CommandTemplate::toString(inputArguments);
+    const std::string pipePath = pipeDirectory + "/fingerprint-" + std::to_string(getpid()) + "-" + std::to_string(nextPipeId++) + ".pipe";
+    const auto start = std::chrono::steady_clock::now();
+
+    // THE READ END IS OPENED FIRST SO FFMPEG NEVER BLOCKS OPENING THE WRITE END
+    unlink(pipePath.c_str());
+    const int fd = (mkfifo(pipePath.c_str(), 0600) == 0) ? open(pipePath.c_str(), O_RDONLY | O_NONBLOCK) : -1;
+    if (fd < 0) {
+        std::cout << "Failed to create fingerprint pipe " << pipePath << "." << std::endl;
+        unlink(pipePath.c_str());
+        callback(Fingerprint{input, false, "", 0});
+        return -1;
+    }
+
+    // THE TRAILER WRITES THE WHOLE FINGERPRINT AT ONCE, A LARGE BUFFER LETS IT FINISH WITHOUT WAITING FOR THE READER
+    if (fcntl(fd, F_SETPIPE_SZ, PipeBufferSize) < 0) {
+        std::cout << "Failed to resize fingerprint pipe " << pipePath << " to " << PipeBufferSize << " bytes: " << strerror(errno) << "." << std::endl;
+        close(fd);
+        unlink(pipePath.c_str());
+        callback(Fingerprint{input, false, "", 0});
+        return -1;
+    }
+
+    auto pipe = std::make_shared<FingerprintPipe>();
+    pipe->fd = fd;
+    pipe->sessionCompleted = false;
+    pipe->reader = std::thread([pipe]() {
+        readFingerprintPipe(pipe.get(), PipePollInterval);
+    });
+
+    auto session = SessionRouter::getInstance().executeAsync(generateFingerprintArguments(inputArguments, pipePath), [pipe, pipePath, input, callback, start](auto session) {
+        pipe->sessionCompleted = true;
+        pipe->reader.join();
+        close(pipe->fd);
+        unlink(pipePath.c_str());
+
+        std::string output = pipe->output;
+        const size_t end = output.find_last_not_of(" \r\n\t");
+        output.erase(end == std::string::npos ? 0 : end + 1);
+
+        const long duration = (long)std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::steady_clock::now() - start).count();
+        callback(Fingerprint{input, ReturnCode::isSuccess(session->getReturnCode()) && !output.empty(), output, duration});
+    }, logConsumerId);
+
+    return session->getSessionId();
+}
+
+long ffmpegkittest::Fingerprinter::fingerprintFile(const std::string& path, const FingerprintCallback& callback) {
+    return fingerprint(std::list<std::string>{"-i", path}, callback);
+}
+
+int ffmpegkittest::Fingerprinter::fingerprintDirectory(const std::string& directory, const int maxWorkers, const std::vector<std::string>& extensions, const FingerprintCallback& fileCallback, const BatchCallback& batchCallback) {
+    std::vector<std::string> files;
+
+    DIR* handle = opendir(directory.c_str());
+    if (handle != nullptr) {
+        struct dirent* entry;
+        while ((entry = readdir(handle)) != nullptr) {
+            const std::string name = entry->d_name;
+            const std::string path = directory + "/" + name;
+            struct stat fileStat;
+            if (stat(path.c_str(), &fileStat) != 0 || !S_ISREG(fileStat.st_mode)) {
+                continue;
+            }
+
+            const size_t dot = name.rfind('.');
+            const std::string extension = (dot == std::string::npos) ? "" : name.substr(dot);
+            if (extensions.empty() || std::find(extensions.begin(), extensions.end(), extension) != extensions.end()) {
+                files.push_back(path);
+            }
+        }
+        closedir(handle);
+    }
+    std::sort(files.begin(), files.end());
+
+    if (files.empty()) {
+        batchCallback(std::vector<Fingerprint>());
+        return 0;
+    }
+
+    struct Batch {
+        std::mutex mutex;
+        std::vector<Fingerprint> fingerprints;
+        size_t fileCount;
+    };
+    auto batch = std::make_shared<Batch>();
+    batch->fileCount = files.size();
+
+    batchScheduler.setMaxRunningJobs(maxWorkers);
+    for (const std::string& file : files) {
+        batchScheduler.submit([this, file, batch, fileCallback, batchCallback](const std::function<void()>& finished) {
+            return fingerprintFile(file, [file, batch, fileCallback, batchCallback, finished](const Fingerprint& fingerprint) {
+                Fingerprint fileFingerprint = fingerprint;
+                fileFingerprint.input = file;
+                if (fileCallback != nullptr) {
+                    fileCallback(fileFingerprint);
+                }
+
+                bool completed;
+                {
+                    std::lock_guard<std::mutex> lock(batch->mutex);
+                    batch->fingerprints.push_back(fileFingerprint);
+                    completed = (batch->fingerprints.size() == batch->fileCount);
+                }
+                if (completed && batchCallback != nullptr) {
+                    batchCallback(batch->fingerprints);
+                }
+                finished();
+            });
+        });
+    }
+
+    return (int)files.size();
+}
+
+void ffmpegkittest::Fingerprinter::cancel() {
+
+    // FILES THAT WERE STILL QUEUED ARE DROPPED, SO A CANCELLED BATCH NEVER CALLS ITS BATCH CALLBACK
+    batchScheduler.cancelAll();
+}
@@ -0,0 +1,73 @@
+/*
+ * Copyright (c) 2022 Taner Sener
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#ifndef FFMPEG_KIT_TEST_FINGERPRINTER_H
+#define FFMPEG_KIT_TEST_FINGERPRINTER_H
+
+#include "JobScheduler.h"
+#include <atomic>
+#include <functional>
+#include <list>
+#include <string>
+#include <vector>
+
+namespace ffmpegkittest {
+
+    struct Fingerprint {
+        std::string input;
+        bool succeeded;
+        std::string fingerprint;
+        long duration;
+    };
+
+    /**
+     * Fingerprints audio with the chromaprint muxer in a single session. The muxer writes into
+     * a named pipe that a reader thread drains while the session runs, so neither a decoded
+     * copy of the input nor the fingerprint is written to disk.
+     */
+    class Fingerprinter {
+        public:
+            static constexpr const int PipeBufferSize = 1048576;
+            static constexpr const int PipePollInterval = 100;
+
+            typedef std::function<void(const Fingerprint& fingerprint)> FingerprintCallback;
+            typedef std::function<void(const std::vector<Fingerprint>& fingerprints)> BatchCallback;
+
+            static std::list<std::string> generateFingerprintArguments(const std::list<std::string>& inputArguments, const std::string& outputPath);
+
+            Fingerprinter(const std::string& pipeDirectory, const int logConsumerId = 0);
+            long fingerprint(const std::string& inputOptions, const FingerprintCallback& callback);
+            long fingerprint(const std::list<std::string>& inputArguments, const FingerprintCallback& callback);
+            long fingerprintFile(const std::string& path, const FingerprintCallback& callback);
+            int fingerprintDirectory(const std::string& directory, const int maxWorkers, const std::vector<std::string>& extensions, const FingerprintCallback& fileCallback, const BatchCallback& batchCallback);
+            void cancel();
+
+        private:
+            std::string pipeDirectory;
+            int logConsumerId;
+            std::atomic<long> nextPipeId;
+            JobScheduler batchScheduler;
+    };
+
+}
+
+#endif // FFMPEG_KIT_TEST_FINGERPRINTER_H
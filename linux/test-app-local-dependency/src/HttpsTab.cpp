@@ -52,7 +52,7 @@ void appendLogToMainLoop(const ffmpegkittest::HttpsTab* httpsTab,const std::stri
     g_idle_add((GSourceFunc)appendLog, new std::pair<const ffmpegkittest::HttpsTab*,const std::string>(httpsTab, string));
 }
 
-ffmpegkittest::HttpsTab::HttpsTab() : parentWindow(nullptr) {
+ffmpegkittest::HttpsTab::HttpsTab() : outputView("https"), parentWindow(nullptr) {
     urlText.set_placeholder_text("Enter https url");
     Util::applyEditTextStyle(urlText);
 
@@ -82,22 +82,16 @@ ffmpegkittest::HttpsTab::HttpsTab() : parentWindow(nullptr) {
     Util::applyButtonStyle(getInfoAndFailButton);
     getInfoAndFailButtonBox.pack_start(getInfoAndFailButton, Gtk::PACK_EXPAND_PADDING);
 
-    outputText.set_editable(false);
-    Util::applyOutputTextStyle(outputText);
-    outputTextWindow.add(outputText);
-
     pack_start(urlText, Gtk::PACK_SHRINK);
     pack_start(getInfoFromUrlButtonBox, Gtk::PACK_SHRINK);
     pack_start(getRandomInfoButton1Box, Gtk::PACK_SHRINK);
     pack_start(getRandomInfoButton2Box, Gtk::PACK_SHRINK);
     pack_start(getInfoAndFailButtonBox, Gtk::PACK_SHRINK);
-    add(outputTextWindow);
+    add(outputView);
 }
 
 void ffmpegkittest::HttpsTab::setActive() {
     std::cout << "Https Tab Activated" << std::endl;
-    FFmpegKitConfig::enableLogCallback(nullptr);
-    FFmpegKitConfig::enableStatisticsCallback(nullptr);
 }
 
 void ffmpegkittest::HttpsTab::setParentWindow(Gtk::Window* parentWindow) {
@@ -105,13 +99,11 @@ void ffmpegkittest::HttpsTab::setParentWindow(Gtk::Window* parentWindow) {
 }
 
 void ffmpegkittest::HttpsTab::appendOutput(const std::string& string) {
-    outputText.get_buffer()->set_text(outputText.get_buffer()->get_text() + string);
-    Glib::RefPtr<Gtk::Adjustment> adj = outputText.get_vadjustment();
-    adj->set_value(adj->get_upper());
+    outputView.append(string);
 }
 
 void ffmpegkittest::HttpsTab::clearOutput() {
-    outputText.get_buffer()->set_text("");
+    outputView.clear();
 }
 
 void ffmpegkittest::HttpsTab::runGetMediaInformation(const int buttonNumber) {
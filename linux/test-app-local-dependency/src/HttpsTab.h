@@ -24,6 +24,7 @@
 #define FFMPEG_KIT_TEST_HTTPS_TAB_H
 
 #include <gtkmm.h>
+#include "OutputView.h"
 #include "Util.h"
 #include <FFprobeKit.h>
 
@@ -62,8 +63,7 @@ namespace ffmpegkittest {
             Gtk::HBox getRandomInfoButton2Box;
             Gtk::Button getInfoAndFailButton;
             Gtk::HBox getInfoAndFailButtonBox;
-            Gtk::TextView outputText;
-            Gtk::ScrolledWindow outputTextWindow;
+            OutputView outputView;
             Gtk::Window* parentWindow;
     };
 
@@ -0,0 +1,305 @@
+/*
+ * Copyright (c) 2022 Taner Sener
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#include "JobScheduler.h"
+#include "SessionRouter.h"
+#include <FFmpegKit.h>
+#include <FFmpegKitConfig.h>
+#include <fstream>
+#include <iostream>
+#include <set>
+#include <thread>
+#include <vector>
+
+using namespace ffmpegkit;
+
+ffmpegkittest::JobScheduler& ffmpegkittest::JobScheduler::getInstance() {
+    static JobScheduler instance(std::max(1, getPhysicalCoreCount() / DefaultJobThreads), [](const long sessionId) {
+        FFmpegKit::cancel(sessionId);
+    }, &ThreadBudget::getInstance());
+    return instance;
+}
+
+int ffmpegkittest::JobScheduler::getPhysicalCoreCount() {
+    std::ifstream cpuinfo("/proc/cpuinfo");
+    std::set<std::pair<std::string, std::string>> cores;
+    std::string physicalId;
+    std::string line;
+
+    // HYPER-THREADS OF A CORE SHARE THE SAME PHYSICAL ID AND CORE ID
+    while (std::getline(cpuinfo, line)) {
+        const size_t separator = line.find(':');
+        if (separator == std::string::npos) {
+            continue;
+        }
+        const std::string value = (separator + 2 <= line.size()) ? line.substr(separator + 2) : "";
+        if (line.compare(0, 11, "physical id") == 0) {
+            physicalId = value;
+        } else if (line.compare(0, 7, "core id") == 0) {
+            cores.insert(std::make_pair(physicalId, value));
+        }
+    }
+
+    if (!cores.empty()) {
+        return (int)cores.size();
+    }
+
+    const unsigned hardwareThreads = std::thread::hardware_concurrency();
+    return hardwareThreads > 0 ? (int)hardwareThreads : 1;
+}
+
+ffmpegkittest::JobScheduler::JobScheduler(const int maxRunningJobs, const Canceller& canceller, ThreadBudget* threadBudget) :
+    maxRunningJobs(std::max(1, maxRunningJobs)),
+    doneCount(0),
+    finishingCount(0),
+    nextJobId(1),
+    canceller(canceller),
+    threadBudget(threadBudget) {
+}
+
+long ffmpegkittest::JobScheduler::submit(const Starter& starter, const int priority) {
+    long jobId;
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        jobId = nextJobId++;
+
+        // HIGHER PRIORITY FIRST, SUBMISSION ORDER WITHIN THE SAME PRIORITY
+        auto position = queued.begin();
+        while (position != queued.end() && position->priority >= priority) {
+            ++position;
+        }
+        queued.insert(position, Job{jobId, priority, starter, -1, false});
+    }
+
+    notifyStateChanged();
+    startJobs();
+    return jobId;
+}
+
+long ffmpegkittest::JobScheduler::submitFFmpeg(const std::string& command, FFmpegSessionCompleteCallback completeCallback, const int priority, const int logConsumerId, const int statisticsConsumerId, const int logEventConsumerId, const int logFilterId) {
+    return submitFFmpeg(FFmpegKitConfig::parseArguments(command), completeCallback, priority, logConsumerId, statisticsConsumerId, logEventConsumerId, logFilterId);
+}
+
+long ffmpegkittest::JobScheduler::submitFFmpeg(const std::list<std::string>& arguments, FFmpegSessionCompleteCallback completeCallback, const int priority, const int logConsumerId, const int statisticsConsumerId, const int logEventConsumerId, const int logFilterId) {
+    return submit([=](const std::function<void()>& finished) {
+        ThreadBudget* budget;
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            budget = threadBudget;
+        }
+
+        // THE BUDGET IS SIZED FOR THE JOBS THAT WILL RUN ALONGSIDE THIS ONE
+        int threads = 0;
+        std::list<std::string> budgetedArguments = arguments;
+        if (budget != nullptr && budget->isEnabled()) {
+            threads = budget->acquire(getExpectedRunningJobs());
+            budgetedArguments = ThreadBudget::apply(arguments, threads);
+        }
+
+        auto session = SessionRouter::getInstance().executeAsync(budgetedArguments, [completeCallback, finished, budget, threads](auto session) {
+            if (threads > 0) {
+                budget->release(threads);
+            }
+            if (completeCallback != nullptr) {
+                completeCallback(session);
+            }
+            finished();
+        }, logConsumerId, statisticsConsumerId, logEventConsumerId, logFilterId);
+        return session->getSessionId();
+    }, priority);
+}
+
+bool ffmpegkittest::JobScheduler::cancel(const long jobId) {
+    long sessionId = -1;
+    bool found = false;
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+
+        for (auto job = queued.begin(); job != queued.end(); ++job) {
+            if (job->jobId == jobId) {
+                queued.erase(job);
+                found = true;
+                break;
+            }
+        }
+
+        auto job = running.find(jobId);
+        if (job != running.end()) {
+            job->second.cancelRequested = true;
+            sessionId = job->second.sessionId;
+            found = true;
+        }
+    }
+
+    if (!found) {
+        return false;
+    }
+
+    // A JOB THAT IS STILL STARTING IS CANCELLED AS SOON AS ITS SESSION ID IS KNOWN
+    if (sessionId >= 0) {
+        canceller(sessionId);
+    }
+
+    notifyStateChanged();
+    idle.notify_all();
+    return true;
+}
+
+void ffmpegkittest::JobScheduler::cancelAll() {
+    std::vector<long> sessionIds;
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        queued.clear();
+        for (auto& job : running) {
+            job.second.cancelRequested = true;
+            if (job.second.sessionId >= 0) {
+                sessionIds.push_back(job.second.sessionId);
+            }
+        }
+    }
+
+    for (const long sessionId : sessionIds) {
+        canceller(sessionId);
+    }
+
+    notifyStateChanged();
+    idle.notify_all();
+}
+
+void ffmpegkittest::JobScheduler::waitUntilIdle() {
+    std::unique_lock<std::mutex> lock(mutex);
+    idle.wait(lock, [this]() {
+        return queued.empty() && running.empty() && finishingCount == 0;
+    });
+}
+
+void ffmpegkittest::JobScheduler::setMaxRunningJobs(const int maxRunningJobs) {
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        this->maxRunningJobs = std::max(1, maxRunningJobs);
+    }
+    startJobs();
+}
+
+void ffmpegkittest::JobScheduler::setStateListener(const StateListener& stateListener) {
+    std::lock_guard<std::mutex> lock(mutex);
+    this->stateListener = stateListener;
+}
+
+void ffmpegkittest::JobScheduler::setThreadBudget(ThreadBudget* threadBudget) {
+    std::lock_guard<std::mutex> lock(mutex);
+    this->threadBudget = threadBudget;
+}
+
+int ffmpegkittest::JobScheduler::getMaxRunningJobs() {
+    std::lock_guard<std::mutex> lock(mutex);
+    return maxRunningJobs;
+}
+
+int ffmpegkittest::JobScheduler::getQueuedCount() {
+    std::lock_guard<std::mutex> lock(mutex);
+    return (int)queued.size();
+}
+
+int ffmpegkittest::JobScheduler::getRunningCount() {
+    std::lock_guard<std::mutex> lock(mutex);
+    return (int)running.size();
+}
+
+int ffmpegkittest::JobScheduler::getDoneCount() {
+    std::lock_guard<std::mutex> lock(mutex);
+    return doneCount;
+}
+
+void ffmpegkittest::JobScheduler::startJobs() {
+    std::vector<Job> starting;
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        while (!queued.empty() && (int)running.size() < maxRunningJobs) {
+            Job& job = queued.front();
+            running[job.jobId] = job;
+            starting.push_back(job);
+            queued.pop_front();
+        }
+    }
+
+    if (starting.empty()) {
+        return;
+    }
+    notifyStateChanged();
+
+    // STARTERS RUN OUTSIDE THE LOCK, A JOB MAY EVEN FINISH BEFORE ITS STARTER RETURNS
+    for (auto& job : starting) {
+        const long jobId = job.jobId;
+        const long sessionId = job.starter([this, jobId]() {
+            finish(jobId);
+        });
+
+        bool cancelRequested = false;
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            auto runningJob = running.find(jobId);
+            if (runningJob != running.end()) {
+                runningJob->second.sessionId = sessionId;
+                cancelRequested = runningJob->second.cancelRequested;
+            }
+        }
+        if (cancelRequested) {
+            canceller(sessionId);
+        }
+    }
+}
+
+void ffmpegkittest::JobScheduler::finish(const long jobId) {
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        if (running.erase(jobId) > 0) {
+            doneCount++;
+        }
+        finishingCount++;
+    }
+
+    notifyStateChanged();
+    startJobs();
+
+    // A WAITER MAY DESTROY THE SCHEDULER AS SOON AS IT SEES THE LAST FINISH, SO SIGNALLING IT UNDER THE LOCK IS THE LAST
+    // ACCESS TO THIS OBJECT
+    std::lock_guard<std::mutex> lock(mutex);
+    finishingCount--;
+    idle.notify_all();
+}
+
+void ffmpegkittest::JobScheduler::notifyStateChanged() {
+    StateListener listener;
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        listener = stateListener;
+    }
+    if (listener != nullptr) {
+        listener();
+    }
+}
+
+int ffmpegkittest::JobScheduler::getExpectedRunningJobs() {
+    std::lock_guard<std::mutex> lock(mutex);
+    return std::min(maxRunningJobs, (int)(running.size() + queued.size()));
+}
@@ -0,0 +1,102 @@
+/*
+ * Copyright (c) 2022 Taner Sener
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#ifndef FFMPEG_KIT_TEST_JOB_SCHEDULER_H
+#define FFMPEG_KIT_TEST_JOB_SCHEDULER_H
+
+#include "ThreadBudget.h"
+#include <FFmpegSession.h>
+#include <condition_variable>
+#include <functional>
+#include <list>
+#include <map>
+#include <mutex>
+#include <string>
+
+namespace ffmpegkittest {
+
+    /**
+     * Runs submitted jobs with a bounded number of them running at the same time. Waiting
+     * jobs start in priority order, FIFO within the same priority. A job is started through
+     * its starter, which returns the session id used to cancel it and calls the given
+     * function exactly once when the job has finished. FFmpeg jobs are given an explicit
+     * thread budget when a ThreadBudget is set. Once waitUntilIdle returns no finishing job
+     * touches the scheduler any more, so it may be destroyed.
+     */
+    class JobScheduler {
+        public:
+            static constexpr const int DefaultJobThreads = 2;
+            static constexpr const int PriorityNormal = 0;
+            static constexpr const int PriorityHigh = 10;
+
+            typedef std::function<long(const std::function<void()>& finished)> Starter;
+            typedef std::function<void(const long sessionId)> Canceller;
+            typedef std::function<void()> StateListener;
+
+            static JobScheduler& getInstance();
+            static int getPhysicalCoreCount();
+
+            JobScheduler(const int maxRunningJobs, const Canceller& canceller, ThreadBudget* threadBudget = nullptr);
+            long submit(const Starter& starter, const int priority = PriorityNormal);
+            long submitFFmpeg(const std::string& command, ffmpegkit::FFmpegSessionCompleteCallback completeCallback, const int priority = PriorityNormal, const int logConsumerId = 0, const int statisticsConsumerId = 0, const int logEventConsumerId = 0, const int logFilterId = 0);
+            long submitFFmpeg(const std::list<std::string>& arguments, ffmpegkit::FFmpegSessionCompleteCallback completeCallback, const int priority = PriorityNormal, const int logConsumerId = 0, const int statisticsConsumerId = 0, const int logEventConsumerId = 0, const int logFilterId = 0);
+            bool cancel(const long jobId);
+            void cancelAll();
+            void waitUntilIdle();
+            void setMaxRunningJobs(const int maxRunningJobs);
+            void setStateListener(const StateListener& stateListener);
+            void setThreadBudget(ThreadBudget* threadBudget);
+            int getMaxRunningJobs();
+            int getQueuedCount();
+            int getRunningCount();
+            int getDoneCount();
+
+        private:
+            struct Job {
+                long jobId;
+                int priority;
+                Starter starter;
+                long sessionId;
+                bool cancelRequested;
+            };
+
+            void startJobs();
+            void finish(const long jobId);
+            void notifyStateChanged();
+            int getExpectedRunningJobs();
+
+            std::mutex mutex;
+            std::condition_variable idle;
+            std::list<Job> queued;
+            std::map<long, Job> running;
+            int maxRunningJobs;
+            int doneCount;
+            int finishingCount;
+            long nextJobId;
+            Canceller canceller;
+            StateListener stateListener;
+            ThreadBudget* threadBudget;
+    };
+
+}
+
+#endif // FFMPEG_KIT_TEST_JOB_SCHEDULER_H
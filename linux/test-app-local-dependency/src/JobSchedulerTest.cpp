@@ -0,0 +1,187 @@
+/*
+ * Copyright (c) 2022 Taner Sener
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#include "JobSchedulerTest.h"
+#include "JobScheduler.h"
+#include <iostream>
+#include <memory>
+#include <thread>
+#include <vector>
+
+using namespace ffmpegkittest;
+
+struct FakeJobs {
+    std::vector<long> started;
+    std::vector<long> cancelled;
+    std::vector<std::function<void()>> finished;
+
+    JobScheduler::Starter starter(const long sessionId) {
+        return [this, sessionId](const std::function<void()>& finished) {
+            started.push_back(sessionId);
+            this->finished.push_back(finished);
+            return sessionId;
+        };
+    }
+};
+
+void testRunningJobsAreBounded() {
+    FakeJobs jobs;
+    JobScheduler scheduler(2, [](const long) {});
+
+    for (long sessionId = 1; sessionId <= 5; sessionId++) {
+        scheduler.submit(jobs.starter(sessionId));
+    }
+    assert(jobs.started.size() == 2);
+    assert(scheduler.getRunningCount() == 2);
+    assert(scheduler.getQueuedCount() == 3);
+
+    jobs.finished[0]();
+    assert(jobs.started.size() == 3);
+    assert(jobs.started[2] == 3);
+    assert(scheduler.getRunningCount() == 2);
+    assert(scheduler.getDoneCount() == 1);
+
+    // A SECOND CALL FOR THE SAME JOB IS IGNORED
+    jobs.finished[0]();
+    assert(scheduler.getDoneCount() == 1);
+
+    scheduler.setMaxRunningJobs(4);
+    assert(jobs.started.size() == 5);
+    assert(scheduler.getQueuedCount() == 0);
+
+    for (size_t i = 1; i < jobs.finished.size(); i++) {
+        jobs.finished[i]();
+    }
+    scheduler.waitUntilIdle();
+    assert(scheduler.getDoneCount() == 5);
+}
+
+void testQueueOrdersByPriority() {
+    FakeJobs jobs;
+    JobScheduler scheduler(1, [](const long) {});
+
+    scheduler.submit(jobs.starter(1));
+    scheduler.submit(jobs.starter(2));
+    scheduler.submit(jobs.starter(3), JobScheduler::PriorityHigh);
+    scheduler.submit(jobs.starter(4));
+    scheduler.submit(jobs.starter(5), JobScheduler::PriorityHigh);
+
+    for (size_t i = 0; i < 5; i++) {
+        jobs.finished[i]();
+    }
+
+    const std::vector<long> expected{1, 3, 5, 2, 4};
+    assert(jobs.started == expected);
+}
+
+void testCancelQueuedAndRunningJobs() {
+    FakeJobs jobs;
+    JobScheduler scheduler(1, [&jobs](const long sessionId) {
+        jobs.cancelled.push_back(sessionId);
+    });
+
+    const long runningJobId = scheduler.submit(jobs.starter(11));
+    const long queuedJobId = scheduler.submit(jobs.starter(12));
+    scheduler.submit(jobs.starter(13));
+
+    // A QUEUED JOB IS DROPPED WITHOUT EVER STARTING
+    assert(scheduler.cancel(queuedJobId));
+    assert(!scheduler.cancel(queuedJobId));
+    assert(!scheduler.cancel(999));
+    assert(scheduler.getQueuedCount() == 1);
+    assert(jobs.cancelled.empty());
+
+    assert(scheduler.cancel(runningJobId));
+    assert(jobs.cancelled.size() == 1 && jobs.cancelled[0] == 11);
+
+    jobs.finished[0]();
+    assert(!scheduler.cancel(runningJobId));
+    assert(jobs.started.size() == 2 && jobs.started[1] == 13);
+
+    scheduler.submit(jobs.starter(14));
+    scheduler.submit(jobs.starter(15));
+    scheduler.cancelAll();
+    assert(scheduler.getQueuedCount() == 0);
+    assert(jobs.cancelled.size() == 2 && jobs.cancelled[1] == 13);
+
+    jobs.finished[1]();
+    scheduler.waitUntilIdle();
+    assert(jobs.started.size() == 2);
+    assert(scheduler.getDoneCount() == 2);
+}
+
+void testCancelWhileStarting() {
+    std::vector<long> cancelled;
+    std::function<void()> finished;
+    JobScheduler scheduler(1, [&cancelled](const long sessionId) {
+        cancelled.push_back(sessionId);
+    });
+
+    // THE SESSION ID IS NOT KNOWN YET WHEN CANCEL IS CALLED FROM INSIDE THE STARTER
+    scheduler.submit([&](const std::function<void()>& jobFinished) {
+        finished = jobFinished;
+        scheduler.cancelAll();
+        assert(cancelled.empty());
+        return 21L;
+    });
+    assert(cancelled.size() == 1 && cancelled[0] == 21);
+
+    finished();
+    scheduler.waitUntilIdle();
+    assert(scheduler.getDoneCount() == 1);
+}
+
+void testDestroyAfterConcurrentFinishes() {
+    for (int round = 0; round < 100; round++) {
+        FakeJobs jobs;
+        std::unique_ptr<JobScheduler> scheduler(new JobScheduler(4, [](const long) {}));
+        for (long sessionId = 1; sessionId <= 4; sessionId++) {
+            scheduler->submit(jobs.starter(sessionId));
+        }
+
+        // THE LISTENER WIDENS THE WINDOW BETWEEN A JOB LEAVING THE RUNNING SET AND ITS FINISH RETURNING
+        scheduler->setStateListener([]() {
+            std::this_thread::yield();
+        });
+
+        std::vector<std::thread> threads;
+        for (auto& finished : jobs.finished) {
+            threads.push_back(std::thread(finished));
+        }
+        scheduler->waitUntilIdle();
+        scheduler.reset();
+
+        for (auto& thread : threads) {
+            thread.join();
+        }
+    }
+}
+
+void testJobScheduler(void) {
+    testRunningJobsAreBounded();
+    testQueueOrdersByPriority();
+    testCancelQueuedAndRunningJobs();
+    testCancelWhileStarting();
+    testDestroyAfterConcurrentFinishes();
+
+    std::cout << "JobSchedulerTest passed." << std::endl;
+}
@@ -0,0 +1,92 @@
+/*
+ * Copyright (c) 2022 Taner Sener
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#include "LogFilter.h"
+#include <algorithm>
+#include <cstring>
+
+using namespace ffmpegkit;
+
+ffmpegkittest::LogCategory ffmpegkittest::LogFilter::categorise(const char* message, const size_t length) {
+    size_t position = 0;
+    while (position < length && message[position] == ' ') {
+        position++;
+    }
+    if (position == length) {
+        return LogCategoryOther;
+    }
+
+    const char* start = message + position;
+    const size_t remaining = length - position;
+
+    // [libx264 @ 0x55d1c4a3e2c0] ...
+    if (*start == '[' && memchr(start, '@', std::min(remaining, (size_t)64)) != nullptr) {
+        return LogCategoryContext;
+    }
+    if ((remaining >= 6 && memcmp(start, "frame=", 6) == 0) || (remaining >= 5 && memcmp(start, "size=", 5) == 0) || (remaining >= 6 && memcmp(start, "Lsize=", 6) == 0)) {
+        return LogCategoryProgress;
+    }
+    if ((remaining >= 7 && memcmp(start, "Input #", 7) == 0) || (remaining >= 8 && memcmp(start, "Output #", 8) == 0) || (remaining >= 8 && memcmp(start, "Stream #", 8) == 0) || (remaining >= 9 && memcmp(start, "Metadata:", 9) == 0) || (remaining >= 9 && memcmp(start, "Duration:", 9) == 0)) {
+        return LogCategoryHeader;
+    }
+
+    return LogCategoryOther;
+}
+
+ffmpegkittest::LogFilter::LogFilter() : LogFilter(LevelAVLogTrace) {
+}
+
+ffmpegkittest::LogFilter::LogFilter(const Level level, const unsigned categories, const std::string& substring) : level(level), categories(categories) {
+    substringLength = std::min(substring.size(), (size_t)MaxSubstringLength);
+    memcpy(this->substring, substring.data(), substringLength);
+    this->substring[substringLength] = '\0';
+}
+
+bool ffmpegkittest::LogFilter::acceptsLevel(const int level) const {
+
+    // LOWER LEVELS ARE MORE SEVERE
+    return level <= this->level;
+}
+
+bool ffmpegkittest::LogFilter::acceptsMessage(const char* message, const size_t length) const {
+    if (categories != LogCategoryAll && (categorise(message, length) & categories) == 0) {
+        return false;
+    }
+    if (substringLength == 0) {
+        return true;
+    }
+    if (length < substringLength) {
+        return false;
+    }
+
+    const char* last = message + length - substringLength;
+    for (const char* position = message; position <= last; position++) {
+        position = (const char*)memchr(position, substring[0], (size_t)(last - position) + 1);
+        if (position == nullptr) {
+            return false;
+        }
+        if (memcmp(position, substring, substringLength) == 0) {
+            return true;
+        }
+    }
+    return false;
+}
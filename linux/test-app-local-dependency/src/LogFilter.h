@@ -0,0 +1,64 @@
+/*
+ * Copyright (c) 2022 Taner Sener
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#ifndef FFMPEG_KIT_TEST_LOG_FILTER_H
+#define FFMPEG_KIT_TEST_LOG_FILTER_H
+
+#include <Log.h>
+#include <string>
+
+namespace ffmpegkittest {
+
+    enum LogCategory {
+        LogCategoryProgress = 1,
+        LogCategoryHeader = 2,
+        LogCategoryContext = 4,
+        LogCategoryOther = 8,
+        LogCategoryAll = 15
+    };
+
+    /**
+     * Decides on the FFmpeg thread whether a log line is worth sending to the main loop. The
+     * level is checked before the message is even read; categories and the substring only
+     * for lines that pass it.
+     */
+    class LogFilter {
+        public:
+            static constexpr const size_t MaxSubstringLength = 63;
+
+            static LogCategory categorise(const char* message, const size_t length);
+
+            LogFilter();
+            LogFilter(const ffmpegkit::Level level, const unsigned categories = LogCategoryAll, const std::string& substring = "");
+            bool acceptsLevel(const int level) const;
+            bool acceptsMessage(const char* message, const size_t length) const;
+
+        private:
+            int level;
+            unsigned categories;
+            char substring[MaxSubstringLength + 1];
+            size_t substringLength;
+    };
+
+}
+
+#endif // FFMPEG_KIT_TEST_LOG_FILTER_H
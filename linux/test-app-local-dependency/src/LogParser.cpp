@@ -0,0 +1,414 @@
+/*
+ * Copyright (c) 2022 Taner Sener
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#include "LogParser.h"
+#include <algorithm>
+#include <cstring>
+
+static const char* skipSpaces(const char* position, const char* end) {
+    while (position < end && *position == ' ') {
+        position++;
+    }
+    return position;
+}
+
+static bool startsWith(const char* position, const char* end, const char* prefix) {
+    while (*prefix != '\0') {
+        if (position >= end || *position != *prefix) {
+            return false;
+        }
+        position++;
+        prefix++;
+    }
+    return true;
+}
+
+static bool isDigit(const char character) {
+    return character >= '0' && character <= '9';
+}
+
+static bool parseInteger(const char*& position, const char* end, int64_t& value) {
+    const char* start = position;
+    value = 0;
+    while (position < end && isDigit(*position)) {
+        value = value * 10 + (*position - '0');
+        position++;
+    }
+    return position != start;
+}
+
+static bool parseDecimal(const char*& position, const char* end, double& value) {
+    bool negative = false;
+    if (position < end && *position == '-') {
+        negative = true;
+        position++;
+    }
+
+    int64_t integer;
+    const bool hasInteger = parseInteger(position, end, integer);
+    value = hasInteger ? (double)integer : 0;
+
+    if (position < end && *position == '.') {
+        position++;
+        double scale = 0.1;
+        while (position < end && isDigit(*position)) {
+            value += (*position - '0') * scale;
+            scale /= 10;
+            position++;
+        }
+    } else if (!hasInteger) {
+        return false;
+    }
+
+    if (negative) {
+        value = -value;
+    }
+    return true;
+}
+
+static double parseTime(const char* position, const char* end) {
+    bool negative = false;
+    if (position < end && *position == '-') {
+        negative = true;
+        position++;
+    }
+
+    // HH:MM:SS.FF
+    double seconds = 0;
+    for (int field = 0; field < 3; field++) {
+        double value;
+        if (!parseDecimal(position, end, value)) {
+            return -1;
+        }
+        seconds = seconds * 60 + value;
+        if (field < 2) {
+            if (position >= end || *position != ':') {
+                return -1;
+            }
+            position++;
+        }
+    }
+
+    return negative ? -seconds * 1000 : seconds * 1000;
+}
+
+static double parseSize(const char* position, const char* end) {
+    double value;
+    if (!parseDecimal(position, end, value)) {
+        return -1;
+    }
+
+    if (startsWith(position, end, "kB") || startsWith(position, end, "KiB") || startsWith(position, end, "kiB")) {
+        return value * 1024;
+    } else if (startsWith(position, end, "MB") || startsWith(position, end, "MiB")) {
+        return value * 1024 * 1024;
+    }
+    return value;
+}
+
+static void copyText(char* destination, const size_t capacity, const char* start, const char* end) {
+    size_t length = (size_t)(end - start);
+    if (length > capacity - 1) {
+        length = capacity - 1;
+    }
+    memcpy(destination, start, length);
+    destination[length] = '\0';
+}
+
+static bool parseProgress(const char* position, const char* end, ffmpegkittest::ProgressEvent& progress) {
+    bool recognised = false;
+    bool qualitySeen = false;
+
+    progress.frame = -1;
+    progress.fps = -1;
+    progress.quality = -1;
+    progress.size = -1;
+    progress.time = -1;
+    progress.bitrate = -1;
+    progress.speed = -1;
+    progress.last = false;
+
+    while (position < end) {
+        const char* key = skipSpaces(position, end);
+        const char* equals = key;
+        while (equals < end && *equals != '=' && *equals != ' ') {
+            equals++;
+        }
+        if (equals >= end || *equals != '=') {
+            position = equals;
+            continue;
+        }
+
+        // VALUES MAY BE RIGHT ALIGNED, e.g. "frame=   12"
+        const char* value = skipSpaces(equals + 1, end);
+        const char* valueEnd = value;
+        while (valueEnd < end && *valueEnd != ' ') {
+            valueEnd++;
+        }
+        position = valueEnd;
+
+        const size_t keyLength = (size_t)(equals - key);
+        const bool available = !startsWith(value, valueEnd, "N/A");
+        double number = -1;
+
+        if (keyLength == 5 && memcmp(key, "frame", 5) == 0) {
+            if (available && parseDecimal(value, valueEnd, number)) {
+                progress.frame = (int64_t)number;
+            }
+            recognised = true;
+        } else if (keyLength == 3 && memcmp(key, "fps", 3) == 0) {
+            if (available && parseDecimal(value, valueEnd, number)) {
+                progress.fps = (float)number;
+            }
+        } else if (keyLength == 1 && key[0] == 'q') {
+            if (!qualitySeen && available && parseDecimal(value, valueEnd, number)) {
+                progress.quality = (float)number;
+            }
+            qualitySeen = true;
+        } else if ((keyLength == 4 && memcmp(key, "size", 4) == 0) || (keyLength == 5 && memcmp(key, "Lsize", 5) == 0)) {
+            if (available) {
+                progress.size = (int64_t)parseSize(value, valueEnd);
+            }
+            progress.last = (key[0] == 'L');
+            recognised = true;
+        } else if (keyLength == 4 && memcmp(key, "time", 4) == 0) {
+            if (available) {
+                progress.time = parseTime(value, valueEnd);
+            }
+            recognised = true;
+        } else if (keyLength == 7 && memcmp(key, "bitrate", 7) == 0) {
+            if (available && parseDecimal(value, valueEnd, number)) {
+                progress.bitrate = number;
+            }
+        } else if (keyLength == 5 && memcmp(key, "speed", 5) == 0) {
+            if (available && parseDecimal(value, valueEnd, number)) {
+                progress.speed = number;
+            }
+        }
+    }
+
+    return recognised;
+}
+
+static bool parseFile(const char* position, const char* end, ffmpegkittest::FileEvent& file) {
+    int64_t index;
+    if (!parseInteger(position, end, index) || !startsWith(position, end, ", ")) {
+        return false;
+    }
+    position += 2;
+
+    // Input #0, mov,mp4,m4a, from 'file':    Output #0, mp4, to 'file':
+    const char* urlStart = (const char*)memchr(position, '\'', (size_t)(end - position));
+    const char* urlEnd = end;
+    while (urlEnd > position && *(urlEnd - 1) != '\'') {
+        urlEnd--;
+    }
+    if (urlStart == nullptr || urlEnd - 1 <= urlStart) {
+        return false;
+    }
+
+    const char* formatEnd = urlStart;
+    while (formatEnd > position && *(formatEnd - 1) != ',') {
+        formatEnd--;
+    }
+    if (formatEnd > position) {
+        formatEnd--;
+    }
+
+    file.fileIndex = (int)index;
+    copyText(file.format, sizeof(file.format), position, formatEnd);
+    copyText(file.url, sizeof(file.url), urlStart + 1, urlEnd - 1);
+    return true;
+}
+
+static bool parseStream(const char* position, const char* end, ffmpegkittest::StreamEvent& stream) {
+    int64_t fileIndex;
+    int64_t streamIndex;
+    if (!parseInteger(position, end, fileIndex) || position >= end || *position != ':') {
+        return false;
+    }
+    position++;
+    if (!parseInteger(position, end, streamIndex)) {
+        return false;
+    }
+
+    // SKIPS OPTIONAL [0x1] AND (und) PARTS
+    while (position < end && !startsWith(position, end, ": ")) {
+        position++;
+    }
+    if (position >= end) {
+        return false;
+    }
+    position += 2;
+
+    const char* typeEnd = position;
+    while (typeEnd < end && *typeEnd != ':') {
+        typeEnd++;
+    }
+    if (typeEnd >= end) {
+        return false;
+    }
+    const char* codec = skipSpaces(typeEnd + 1, end);
+    const char* codecEnd = codec;
+    while (codecEnd < end && *codecEnd != ' ' && *codecEnd != ',') {
+        codecEnd++;
+    }
+
+    stream.fileIndex = (int)fileIndex;
+    stream.streamIndex = (int)streamIndex;
+    stream.output = false;
+    copyText(stream.mediaType, sizeof(stream.mediaType), position, typeEnd);
+    copyText(stream.codec, sizeof(stream.codec), codec, codecEnd);
+    stream.width = -1;
+    stream.height = -1;
+    stream.frameRate = -1;
+    stream.sampleRate = -1;
+
+    // REMAINING PROPERTIES ARE SEPARATED BY COMMAS, e.g. ", 640x424 [SAR 1:1 DAR 80:53], 30 fps"
+    position = codecEnd;
+    while (position < end) {
+        const char* property = skipSpaces(position, end);
+        const char* propertyEnd = property;
+        while (propertyEnd < end && *propertyEnd != ',') {
+            propertyEnd++;
+        }
+        position = propertyEnd + 1;
+
+        const char* cursor = property;
+        int64_t first;
+        int64_t second;
+        double number;
+        if (parseInteger(cursor, propertyEnd, first) && cursor < propertyEnd && *cursor == 'x') {
+            cursor++;
+            if (parseInteger(cursor, propertyEnd, second) && (cursor == propertyEnd || *cursor == ' ')) {
+                stream.width = (int)first;
+                stream.height = (int)second;
+            }
+            continue;
+        }
+
+        cursor = property;
+        if (parseDecimal(cursor, propertyEnd, number)) {
+            if (startsWith(cursor, propertyEnd, " fps")) {
+                stream.frameRate = number;
+            } else if (startsWith(cursor, propertyEnd, " Hz")) {
+                stream.sampleRate = (int)number;
+            }
+        }
+    }
+
+    return true;
+}
+
+bool ffmpegkittest::LogParser::parseLine(const char* line, const size_t length, LogEvent& event) {
+    const char* end = line + length;
+    const char* position = skipSpaces(line, end);
+
+    if (position >= end) {
+        return false;
+    }
+
+    // FIRST CHARACTER REJECTS ALMOST EVERY OTHER LINE
+    switch (*position) {
+        case 'f':
+        case 's':
+        case 'L':
+            if (startsWith(position, end, "frame=") || startsWith(position, end, "size=") || startsWith(position, end, "Lsize=")) {
+                event.type = LogEventProgress;
+                return parseProgress(position, end, event.progress);
+            }
+            return false;
+        case 'I':
+            if (startsWith(position, end, "Input #")) {
+                event.type = LogEventInput;
+                return parseFile(position + 7, end, event.file);
+            }
+            return false;
+        case 'O':
+            if (startsWith(position, end, "Output #")) {
+                event.type = LogEventOutput;
+                return parseFile(position + 8, end, event.file);
+            }
+            return false;
+        case 'S':
+            if (startsWith(position, end, "Stream #")) {
+                event.type = LogEventStream;
+                return parseStream(position + 8, end, event.stream);
+            }
+            return false;
+        default:
+            return false;
+    }
+}
+
+ffmpegkittest::LogParser::LogParser() {
+    reset(0);
+}
+
+void ffmpegkittest::LogParser::reset(const long sessionId) {
+    this->sessionId = sessionId;
+    lineLength = 0;
+    outputSection = false;
+}
+
+long ffmpegkittest::LogParser::getSessionId() const {
+    return sessionId;
+}
+
+int ffmpegkittest::LogParser::feed(const char* fragment, const size_t length, const Listener& listener) {
+    const char* position = fragment;
+    const char* end = fragment + length;
+    int events = 0;
+
+    while (position < end) {
+        const char* lineEnd = position;
+        while (lineEnd < end && *lineEnd != '\n' && *lineEnd != '\r') {
+            lineEnd++;
+        }
+
+        // OVERLONG LINES ARE TRUNCATED, NONE OF THE PARSED LINES GET THAT LONG
+        const size_t copied = std::min((size_t)(lineEnd - position), MaxLineLength - lineLength);
+        memcpy(line + lineLength, position, copied);
+        lineLength += copied;
+
+        if (lineEnd == end) {
+            break;
+        }
+
+        LogEvent event;
+        if (lineLength > 0 && parseLine(line, lineLength, event)) {
+            event.sessionId = sessionId;
+            if (event.type == LogEventInput || event.type == LogEventOutput) {
+                outputSection = (event.type == LogEventOutput);
+            } else if (event.type == LogEventStream) {
+                event.stream.output = outputSection;
+            }
+            listener(event);
+            events++;
+        }
+
+        lineLength = 0;
+        position = lineEnd + 1;
+    }
+
+    return events;
+}
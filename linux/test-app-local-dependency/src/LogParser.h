@@ -0,0 +1,105 @@
+/*
+ * Copyright (c) 2022 Taner Sener
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#ifndef FFMPEG_KIT_TEST_LOG_PARSER_H
+#define FFMPEG_KIT_TEST_LOG_PARSER_H
+
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+
+namespace ffmpegkittest {
+
+    enum LogEventType {
+        LogEventProgress,
+        LogEventInput,
+        LogEventOutput,
+        LogEventStream
+    };
+
+    struct ProgressEvent {
+        int64_t frame;
+        float fps;
+        float quality;
+        int64_t size;
+        double time;
+        double bitrate;
+        double speed;
+        bool last;
+    };
+
+    struct FileEvent {
+        int fileIndex;
+        char format[64];
+        char url[256];
+    };
+
+    struct StreamEvent {
+        int fileIndex;
+        int streamIndex;
+        bool output;
+        char mediaType[16];
+        char codec[32];
+        int width;
+        int height;
+        double frameRate;
+        int sampleRate;
+    };
+
+    struct LogEvent {
+        LogEventType type;
+        long sessionId;
+        union {
+            ProgressEvent progress;
+            FileEvent file;
+            StreamEvent stream;
+        };
+    };
+
+    /**
+     * Turns FFmpeg log output into typed events without regular expressions or allocations.
+     * FFmpeg prints some lines in several log calls, so fragments are joined into complete
+     * lines before they are parsed. Unavailable numeric values are reported as -1.
+     */
+    class LogParser {
+        public:
+            static constexpr const size_t MaxLineLength = 1024;
+
+            typedef std::function<void(const LogEvent& event)> Listener;
+
+            static bool parseLine(const char* line, const size_t length, LogEvent& event);
+
+            LogParser();
+            void reset(const long sessionId);
+            long getSessionId() const;
+            int feed(const char* fragment, const size_t length, const Listener& listener);
+
+        private:
+            long sessionId;
+            char line[MaxLineLength];
+            size_t lineLength;
+            bool outputSection;
+    };
+
+}
+
+#endif // FFMPEG_KIT_TEST_LOG_PARSER_H
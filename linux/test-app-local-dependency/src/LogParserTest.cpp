@@ -0,0 +1,137 @@
+/*
+ * Copyright (c) 2022 Taner Sener
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#include "LogParserTest.h"
+#include "LogParser.h"
+#include <chrono>
+#include <cstring>
+#include <iostream>
+#include <vector>
+
+using namespace ffmpegkittest;
+
+static const int BenchmarkRounds = 20000;
+
+/**
+ * Log callback fragments of a VideoTab mpeg4 encode, in the order FFmpeg prints them.
+ */
+static const char* VideoTabLog[] = {
+    "Input #0, image2, from '/usr/local/share/images/machupicchu.jpg':\n",
+    "  Duration: ", "00:00:00.04", ", start: ", "0.000000", ", bitrate: ", "21894 kb/s", "\n",
+    "  Stream #0:0", ": Video: mjpeg (Baseline), yuvj420p(pc, bt470bg/unknown/unknown), 640x427 [SAR 1:1 DAR 640:427], 25 fps, 25 tbr, 25 tbn", "\n",
+    "Stream mapping:\n",
+    "  Stream #0:0 (mjpeg) -> setpts:default\n",
+    "Press [q] to stop, [?] for help\n",
+    "[mpeg4 @ 0x55d1c4a3e2c0] intra_quant_bias = 0 inter_quant_bias = -64\n",
+    "Output #0, mp4, to '/home/user/.cache/ffmpegkittest/video.mp4':\n",
+    "  Metadata:\n",
+    "    encoder         : Lavf60.3.100\n",
+    "  Stream #0:0", ": Video: mpeg4 (mp4v / 0x7634706D), yuv420p(progressive), 640x424 [SAR 1:1 DAR 80:53], q=2-31, 200 kb/s", ", 30 fps, ", "15360 tbn", "\n",
+    "    Metadata:\n",
+    "      encoder         : Lavc60.3.100 mpeg4\n",
+    "frame=   46 fps=0.0 q=4.3 size=     256kB time=00:00:01.50 bitrate=1397.4kbits/s speed=2.97x    \r",
+    "frame=  101 fps=100 q=31.0 size=     512kB time=00:00:03.33 bitrate=1258.1kbits/s speed=3.31x    \r",
+    "frame=  270 fps=119 q=31.0 Lsize=    1236kB time=00:00:08.96 bitrate=1129.0kbits/s speed=3.95x    \n",
+    "video:1233kB audio:0kB subtitle:0kB other streams:0kB global headers:0kB muxing overhead: 0.257863%\n"
+};
+
+void testProgressLineIsParsed() {
+    const char* line = "frame=  270 fps=119 q=31.0 Lsize=    1236kB time=00:00:08.96 bitrate=1129.0kbits/s speed=3.95x    ";
+    LogEvent event;
+
+    const bool parsed = LogParser::parseLine(line, strlen(line), event);
+    assert(parsed);
+    assert(event.type == LogEventProgress);
+    assert(event.progress.frame == 270);
+    assert(event.progress.fps == 119.0f);
+    assert(event.progress.quality == 31.0f);
+    assert(event.progress.size == 1236 * 1024);
+    assert(event.progress.time > 8959.9 && event.progress.time < 8960.1);
+    assert(event.progress.bitrate > 1128.9 && event.progress.bitrate < 1129.1);
+    assert(event.progress.speed > 3.949 && event.progress.speed < 3.951);
+    assert(event.progress.last);
+
+    const char* unavailable = "size=N/A time=N/A bitrate=N/A speed=N/A";
+    const bool parsedUnavailable = LogParser::parseLine(unavailable, strlen(unavailable), event);
+    assert(parsedUnavailable);
+    assert(event.progress.frame == -1 && event.progress.size == -1 && event.progress.time == -1 && event.progress.speed == -1);
+
+    const char* other = "[mpeg4 @ 0x55d1c4a3e2c0] frame=not a progress line";
+    assert(!LogParser::parseLine(other, strlen(other), event));
+}
+
+void testFragmentedLogBecomesEvents() {
+    LogParser parser;
+    std::vector<LogEvent> events;
+    parser.reset(42);
+
+    for (auto fragment : VideoTabLog) {
+        parser.feed(fragment, strlen(fragment), [&events](const LogEvent& event) {
+            events.push_back(event);
+        });
+    }
+
+    assert(events.size() == 7);
+    assert(events[0].type == LogEventInput && events[0].sessionId == 42);
+    assert(strcmp(events[0].file.format, "image2") == 0);
+    assert(strcmp(events[0].file.url, "/usr/local/share/images/machupicchu.jpg") == 0);
+    assert(events[1].type == LogEventStream && !events[1].stream.output);
+    assert(strcmp(events[1].stream.codec, "mjpeg") == 0 && events[1].stream.width == 640 && events[1].stream.height == 427);
+    assert(events[2].type == LogEventOutput && strcmp(events[2].file.format, "mp4") == 0);
+    assert(events[3].type == LogEventStream && events[3].stream.output);
+    assert(strcmp(events[3].stream.mediaType, "Video") == 0 && strcmp(events[3].stream.codec, "mpeg4") == 0);
+    assert(events[3].stream.width == 640 && events[3].stream.height == 424 && events[3].stream.frameRate == 30);
+    assert(events[4].type == LogEventProgress && !events[4].progress.last && events[4].progress.frame == 46);
+    assert(events[6].type == LogEventProgress && events[6].progress.last && events[6].progress.frame == 270);
+}
+
+void benchmarkLogParser(void) {
+    LogParser parser;
+    int lines = 0;
+    int events = 0;
+    parser.reset(1);
+
+    for (auto fragment : VideoTabLog) {
+        for (const char* character = fragment; *character != '\0'; character++) {
+            lines += (*character == '\n' || *character == '\r');
+        }
+    }
+
+    const auto start = std::chrono::steady_clock::now();
+    for (int round = 0; round < BenchmarkRounds; round++) {
+        for (auto fragment : VideoTabLog) {
+            events += parser.feed(fragment, strlen(fragment), [](const LogEvent&) {});
+        }
+    }
+    const double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+    assert(events == 7 * BenchmarkRounds);
+
+    std::cout << "Log parser benchmark, " << lines * BenchmarkRounds << " lines of VideoTab output: " << (long)(lines * BenchmarkRounds / seconds) << " lines per second." << std::endl;
+}
+
+void testLogParser(void) {
+    testProgressLineIsParsed();
+    testFragmentedLogBecomesEvents();
+
+    std::cout << "LogParserTest passed." << std::endl;
+}
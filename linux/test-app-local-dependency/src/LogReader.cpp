@@ -0,0 +1,55 @@
+/*
+ * Copyright (c) 2022 Taner Sener
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#include "LogRingFile.h"
+#include <iostream>
+
+/**
+ * Prints session log ring files written by the test application in order, oldest line
+ * first.
+ */
+int main(int argc, char** argv) {
+    if (argc < 2) {
+        std::cerr << "Usage: " << argv[0] << " <session log file>..." << std::endl;
+        return 1;
+    }
+
+    int failed = 0;
+
+    for (int i = 1; i < argc; i++) {
+        long sessionId;
+        std::string log;
+
+        if (!ffmpegkittest::LogRingFile::read(argv[i], sessionId, log)) {
+            std::cerr << argv[i] << ": not a session log file." << std::endl;
+            failed++;
+            continue;
+        }
+
+        if (argc > 2) {
+            std::cout << "==> " << argv[i] << " (session " << sessionId << ") <==" << std::endl;
+        }
+        std::cout << log;
+    }
+
+    return failed == 0 ? 0 : 1;
+}
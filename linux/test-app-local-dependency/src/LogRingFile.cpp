@@ -0,0 +1,174 @@
+/*
+ * Copyright (c) 2022 Taner Sener
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#include "LogRingFile.h"
+#include <algorithm>
+#include <cerrno>
+#include <cstring>
+#include <fcntl.h>
+#include <iostream>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+static const size_t HeaderSize = 64;
+static const char Magic[8] = {'F', 'F', 'K', 'T', 'L', 'O', 'G', '1'};
+
+std::shared_ptr<ffmpegkittest::LogRingFile> ffmpegkittest::LogRingFile::create(const std::string& path, const long sessionId, const size_t capacity) {
+    static_assert(sizeof(Header) <= HeaderSize, "log ring file header does not fit");
+
+    const int fd = open(path.c_str(), O_RDWR | O_CREAT | O_TRUNC, S_IRUSR | S_IWUSR | S_IRGRP);
+    if (fd < 0) {
+        std::cout << "Failed to create log file: " << path << ". Operation failed with " << errno << "." << std::endl;
+        return nullptr;
+    }
+
+    const size_t mappingSize = HeaderSize + capacity;
+    if (ftruncate(fd, (off_t)mappingSize) != 0) {
+        std::cout << "Failed to resize log file: " << path << ". Operation failed with " << errno << "." << std::endl;
+        close(fd);
+        return nullptr;
+    }
+
+    void* mapping = mmap(nullptr, mappingSize, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    close(fd);
+    if (mapping == MAP_FAILED) {
+        std::cout << "Failed to map log file: " << path << ". Operation failed with " << errno << "." << std::endl;
+        return nullptr;
+    }
+
+    auto logRingFile = std::shared_ptr<LogRingFile>(new LogRingFile(path, mapping, mappingSize));
+    Header* header = logRingFile->header;
+    header->headerSize = HeaderSize;
+    header->reserved = 0;
+    header->capacity = capacity;
+    header->sessionId = sessionId;
+    header->writeOffset.store(0, std::memory_order_relaxed);
+
+    // MAGIC IS WRITTEN LAST SO THAT A HALF INITIALISED FILE IS NEVER ACCEPTED
+    memcpy(header->magic, Magic, sizeof(header->magic));
+
+    return logRingFile;
+}
+
+bool ffmpegkittest::LogRingFile::read(const std::string& path, long& sessionId, std::string& log) {
+    const int fd = open(path.c_str(), O_RDONLY);
+    if (fd < 0) {
+        return false;
+    }
+
+    struct stat fileInfo;
+    if (fstat(fd, &fileInfo) != 0 || (size_t)fileInfo.st_size < HeaderSize) {
+        close(fd);
+        return false;
+    }
+
+    const size_t mappingSize = (size_t)fileInfo.st_size;
+    void* mapping = mmap(nullptr, mappingSize, PROT_READ, MAP_SHARED, fd, 0);
+    close(fd);
+    if (mapping == MAP_FAILED) {
+        return false;
+    }
+
+    const Header* header = static_cast<const Header*>(mapping);
+    const char* data = static_cast<const char*>(mapping) + HeaderSize;
+    const uint64_t capacity = header->capacity;
+    const uint64_t written = header->writeOffset.load(std::memory_order_acquire);
+
+    if (memcmp(header->magic, Magic, sizeof(header->magic)) != 0 || header->headerSize != HeaderSize || capacity == 0 || HeaderSize + capacity > mappingSize) {
+        munmap(mapping, mappingSize);
+        return false;
+    }
+
+    sessionId = (long)header->sessionId;
+    log.clear();
+
+    if (written <= capacity) {
+        log.assign(data, (size_t)written);
+    } else {
+
+        // THE OLDEST BYTE FOLLOWS THE NEWEST ONE, A PARTIALLY OVERWRITTEN FIRST LINE IS SKIPPED
+        const size_t start = (size_t)(written % capacity);
+        log.reserve((size_t)capacity);
+        log.append(data + start, (size_t)capacity - start);
+        log.append(data, start);
+
+        const size_t firstLineEnd = log.find('\n');
+        if (firstLineEnd != std::string::npos) {
+            log.erase(0, firstLineEnd + 1);
+        }
+    }
+
+    munmap(mapping, mappingSize);
+    return true;
+}
+
+ffmpegkittest::LogRingFile::LogRingFile(const std::string& path, void* mapping, const size_t mappingSize) :
+    path(path),
+    mapping(mapping),
+    mappingSize(mappingSize),
+    header(static_cast<Header*>(mapping)),
+    data(static_cast<char*>(mapping) + HeaderSize) {
+}
+
+ffmpegkittest::LogRingFile::~LogRingFile() {
+    munmap(mapping, mappingSize);
+}
+
+void ffmpegkittest::LogRingFile::write(const char* message, const size_t length) {
+    const size_t capacity = (size_t)header->capacity;
+
+    // ONLY THE LAST CAPACITY BYTES OF AN OVERSIZED MESSAGE CAN SURVIVE
+    const char* source = message;
+    size_t remaining = length;
+    if (remaining > capacity) {
+        source += remaining - capacity;
+        remaining = capacity;
+    }
+
+    std::lock_guard<std::mutex> lock(writeMutex);
+
+    const uint64_t offset = header->writeOffset.load(std::memory_order_relaxed) + (length - remaining);
+    const size_t position = (size_t)(offset % capacity);
+    const size_t firstPart = std::min(remaining, capacity - position);
+
+    memcpy(data + position, source, firstPart);
+    memcpy(data, source + firstPart, remaining - firstPart);
+
+    header->writeOffset.store(offset + remaining, std::memory_order_release);
+}
+
+void ffmpegkittest::LogRingFile::write(const std::string& message) {
+    write(message.data(), message.size());
+}
+
+long ffmpegkittest::LogRingFile::getSessionId() const {
+    return (long)header->sessionId;
+}
+
+uint64_t ffmpegkittest::LogRingFile::getWrittenBytes() const {
+    return header->writeOffset.load(std::memory_order_relaxed);
+}
+
+const std::string& ffmpegkittest::LogRingFile::getPath() const {
+    return path;
+}
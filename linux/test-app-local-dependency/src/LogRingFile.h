@@ -0,0 +1,74 @@
+/*
+ * Copyright (c) 2022 Taner Sener
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#ifndef FFMPEG_KIT_TEST_LOG_RING_FILE_H
+#define FFMPEG_KIT_TEST_LOG_RING_FILE_H
+
+#include <atomic>
+#include <memory>
+#include <mutex>
+#include <string>
+
+namespace ffmpegkittest {
+
+    /**
+     * Fixed-size log file mapped into memory and written as a ring. The header stores the
+     * total number of bytes written, which is enough for a reader to find the oldest byte
+     * still in the file. Writers only copy into the mapping; the kernel writes pages back.
+     */
+    class LogRingFile {
+        public:
+            static constexpr const size_t DefaultCapacity = 1024 * 1024;
+
+            static std::shared_ptr<LogRingFile> create(const std::string& path, const long sessionId, const size_t capacity = DefaultCapacity);
+            static bool read(const std::string& path, long& sessionId, std::string& log);
+
+            ~LogRingFile();
+            void write(const char* message, const size_t length);
+            void write(const std::string& message);
+            long getSessionId() const;
+            uint64_t getWrittenBytes() const;
+            const std::string& getPath() const;
+
+        private:
+            struct Header {
+                char magic[8];
+                uint32_t headerSize;
+                uint32_t reserved;
+                uint64_t capacity;
+                int64_t sessionId;
+                std::atomic<uint64_t> writeOffset;
+            };
+
+            LogRingFile(const std::string& path, void* mapping, const size_t mappingSize);
+
+            const std::string path;
+            void* mapping;
+            const size_t mappingSize;
+            Header* header;
+            char* data;
+            std::mutex writeMutex;
+    };
+
+}
+
+#endif // FFMPEG_KIT_TEST_LOG_RING_FILE_H
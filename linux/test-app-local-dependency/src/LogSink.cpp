@@ -0,0 +1,240 @@
+/*
+ * Copyright (c) 2022 Taner Sener
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#include "LogSink.h"
+#include <algorithm>
+#include <cstring>
+#include <iostream>
+
+namespace ffmpegkittest {
+
+    gboolean drainLogSink(LogSink* logSink) {
+        logSink->drain();
+
+        const uint64_t dropped = logSink->getDroppedCount();
+        if (dropped != logSink->reportedDroppedCount) {
+            std::cout << "Log sink dropped " << dropped - logSink->reportedDroppedCount << " lines, queue depth is " << logSink->getQueueDepth() << ", high water mark is " << logSink->getHighWaterMark() << "." << std::endl;
+            logSink->reportedDroppedCount = dropped;
+        }
+
+        return TRUE;
+    }
+
+}
+
+static size_t roundUpToPowerOfTwo(const size_t value) {
+    size_t power = 2;
+    while (power < value) {
+        power <<= 1;
+    }
+    return power;
+}
+
+ffmpegkittest::LogSink& ffmpegkittest::LogSink::getInstance() {
+    static LogSink instance;
+    return instance;
+}
+
+ffmpegkittest::LogSink::LogSink(const size_t capacity) :
+    slots(new Slot[roundUpToPowerOfTwo(capacity)]),
+    mask(roundUpToPowerOfTwo(capacity) - 1),
+    enqueuePosition(0),
+    dequeuePosition(0),
+    highWaterMark(0),
+    pushedCount(0),
+    deliveredCount(0),
+    droppedCount(0),
+    reportedDroppedCount(0),
+    draining(false),
+    nextConsumerId(1),
+    timeoutId(0) {
+    for (size_t i = 0; i <= mask; i++) {
+        slots[i].sequence.store(i, std::memory_order_relaxed);
+        slots[i].consumerId = 0;
+        slots[i].length = 0;
+    }
+}
+
+ffmpegkittest::LogSink::~LogSink() {
+    stop();
+}
+
+int ffmpegkittest::LogSink::registerConsumer(const Consumer& consumer) {
+    const int consumerId = nextConsumerId++;
+    consumers[consumerId] = consumer;
+    return consumerId;
+}
+
+void ffmpegkittest::LogSink::unregisterConsumer(const int consumerId) {
+
+    // THE DRAIN IS ITERATING THE BATCHES AND MAY BE RUNNING THIS CONSUMER, SO IT IS REMOVED WHEN THE DRAIN ENDS
+    if (draining) {
+        unregisteredConsumerIds.push_back(consumerId);
+        return;
+    }
+
+    consumers.erase(consumerId);
+    for (auto batch = batches.begin(); batch != batches.end(); ++batch) {
+        if (batch->consumerId == consumerId) {
+            batches.erase(batch);
+            break;
+        }
+    }
+}
+
+bool ffmpegkittest::LogSink::push(const int consumerId, const std::string& message) {
+    return push(consumerId, message.data(), message.size());
+}
+
+bool ffmpegkittest::LogSink::push(const int consumerId, const char* message, const size_t length) {
+    size_t position = enqueuePosition.load(std::memory_order_relaxed);
+
+    for (;;) {
+        Slot& slot = slots[position & mask];
+        const size_t sequence = slot.sequence.load(std::memory_order_acquire);
+        const intptr_t difference = (intptr_t)sequence - (intptr_t)position;
+
+        if (difference == 0) {
+            if (enqueuePosition.compare_exchange_weak(position, position + 1, std::memory_order_relaxed)) {
+                slot.consumerId = consumerId;
+                slot.length = (uint32_t)length;
+
+                // RARE LONG LINES USE THE SLOT'S OWN STRING, WHICH KEEPS ITS CAPACITY WHEN THE SLOT IS REUSED
+                if (length <= InlineMessageLength) {
+                    memcpy(slot.message, message, length);
+                } else {
+                    slot.overflow.assign(message, length);
+                }
+                slot.sequence.store(position + 1, std::memory_order_release);
+                break;
+            }
+        } else if (difference < 0) {
+
+            // QUEUE IS FULL, THE MAIN LOOP IS NOT KEEPING UP
+            droppedCount.fetch_add(1, std::memory_order_relaxed);
+            return false;
+        } else {
+            position = enqueuePosition.load(std::memory_order_relaxed);
+        }
+    }
+
+    pushedCount.fetch_add(1, std::memory_order_relaxed);
+
+    const size_t dequeued = dequeuePosition.load(std::memory_order_relaxed);
+    const size_t depth = (position + 1 > dequeued) ? position + 1 - dequeued : 0;
+    size_t currentHighWaterMark = highWaterMark.load(std::memory_order_relaxed);
+    while (depth > currentHighWaterMark && !highWaterMark.compare_exchange_weak(currentHighWaterMark, depth, std::memory_order_relaxed)) {
+    }
+
+    return true;
+}
+
+size_t ffmpegkittest::LogSink::drain() {
+    size_t position = dequeuePosition.load(std::memory_order_relaxed);
+    size_t count = 0;
+
+    // CONSUMES AT MOST ONE QUEUE LENGTH PER TICK SO A BUSY PRODUCER CANNOT STARVE THE MAIN LOOP
+    while (count <= mask) {
+        Slot& slot = slots[position & mask];
+        if (slot.sequence.load(std::memory_order_acquire) != position + 1) {
+            break;
+        }
+
+        auto batch = batches.begin();
+        while (batch != batches.end() && batch->consumerId != slot.consumerId) {
+            ++batch;
+        }
+        if (batch == batches.end()) {
+            batches.push_back(Batch{slot.consumerId, std::string()});
+            batch = batches.end() - 1;
+        }
+        if (slot.length <= InlineMessageLength) {
+            batch->buffer.append(slot.message, slot.length);
+        } else {
+            batch->buffer.append(slot.overflow);
+        }
+
+        slot.sequence.store(position + mask + 1, std::memory_order_release);
+        position++;
+        count++;
+    }
+
+    dequeuePosition.store(position, std::memory_order_relaxed);
+    deliveredCount.fetch_add(count, std::memory_order_relaxed);
+
+    // BATCH BUFFERS ARE RELEASED IN BULK, ONLY AN UNUSUALLY LARGE ONE GIVES ITS MEMORY BACK
+    draining = true;
+    for (auto& batch : batches) {
+        if (batch.buffer.empty()) {
+            continue;
+        }
+        auto consumer = consumers.find(batch.consumerId);
+        if (consumer != consumers.end() && std::find(unregisteredConsumerIds.begin(), unregisteredConsumerIds.end(), batch.consumerId) == unregisteredConsumerIds.end()) {
+            consumer->second(batch.buffer);
+        }
+        batch.buffer.clear();
+        if (batch.buffer.capacity() > MaxRetainedBatchCapacity) {
+            batch.buffer.shrink_to_fit();
+        }
+    }
+    draining = false;
+
+    for (const int consumerId : unregisteredConsumerIds) {
+        unregisterConsumer(consumerId);
+    }
+    unregisteredConsumerIds.clear();
+
+    return count;
+}
+
+void ffmpegkittest::LogSink::start(const guint interval) {
+    if (timeoutId == 0) {
+        timeoutId = g_timeout_add(interval, (GSourceFunc)drainLogSink, this);
+    }
+}
+
+void ffmpegkittest::LogSink::stop() {
+    if (timeoutId != 0) {
+        g_source_remove(timeoutId);
+        timeoutId = 0;
+    }
+}
+
+size_t ffmpegkittest::LogSink::getQueueDepth() const {
+    return enqueuePosition.load(std::memory_order_relaxed) - dequeuePosition.load(std::memory_order_relaxed);
+}
+
+size_t ffmpegkittest::LogSink::getHighWaterMark() const {
+    return highWaterMark.load(std::memory_order_relaxed);
+}
+
+uint64_t ffmpegkittest::LogSink::getPushedCount() const {
+    return pushedCount.load(std::memory_order_relaxed);
+}
+
+uint64_t ffmpegkittest::LogSink::getDeliveredCount() const {
+    return deliveredCount.load(std::memory_order_relaxed);
+}
+
+uint64_t ffmpegkittest::LogSink::getDroppedCount() const {
+    return droppedCount.load(std::memory_order_relaxed);
+}
@@ -0,0 +1,108 @@
+/*
+ * Copyright (c) 2022 Taner Sener
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#ifndef FFMPEG_KIT_TEST_LOG_SINK_H
+#define FFMPEG_KIT_TEST_LOG_SINK_H
+
+#include <gtkmm.h>
+#include <atomic>
+#include <functional>
+#include <map>
+#include <memory>
+#include <string>
+#include <vector>
+
+namespace ffmpegkittest {
+
+    /**
+     * Collects log lines produced on FFmpeg threads and delivers them to the main loop in
+     * batches. Producers never lock or allocate queue nodes; lines that do not fit into the
+     * queue are dropped and counted. Message bytes are copied into slot storage that is
+     * recycled with the slot and batches are built in per-consumer buffers that keep their
+     * capacity between drains, so steady-state logging does not touch the heap. A consumer
+     * may unregister itself or another consumer while it is being called; it is removed once
+     * the drain has delivered every batch and gets no further batches in the meantime.
+     */
+    class LogSink {
+        public:
+            static constexpr const size_t DefaultCapacity = 8192;
+            static constexpr const guint DefaultDrainInterval = 33;
+            static constexpr const size_t InlineMessageLength = 208;
+            static constexpr const size_t MaxRetainedBatchCapacity = 1024 * 1024;
+
+            typedef std::function<void(const std::string& batch)> Consumer;
+
+            static LogSink& getInstance();
+
+            explicit LogSink(const size_t capacity = DefaultCapacity);
+            ~LogSink();
+
+            int registerConsumer(const Consumer& consumer);
+            void unregisterConsumer(const int consumerId);
+            bool push(const int consumerId, const char* message, const size_t length);
+            bool push(const int consumerId, const std::string& message);
+            size_t drain();
+            void start(const guint interval = DefaultDrainInterval);
+            void stop();
+
+            size_t getQueueDepth() const;
+            size_t getHighWaterMark() const;
+            uint64_t getPushedCount() const;
+            uint64_t getDeliveredCount() const;
+            uint64_t getDroppedCount() const;
+
+            friend gboolean drainLogSink(LogSink* logSink);
+
+        private:
+            struct Slot {
+                std::atomic<size_t> sequence;
+                int consumerId;
+                uint32_t length;
+                std::string overflow;
+                char message[InlineMessageLength];
+            };
+
+            struct Batch {
+                int consumerId;
+                std::string buffer;
+            };
+
+            std::unique_ptr<Slot[]> slots;
+            const size_t mask;
+            std::atomic<size_t> enqueuePosition;
+            std::atomic<size_t> dequeuePosition;
+            std::atomic<size_t> highWaterMark;
+            std::atomic<uint64_t> pushedCount;
+            std::atomic<uint64_t> deliveredCount;
+            std::atomic<uint64_t> droppedCount;
+            uint64_t reportedDroppedCount;
+            std::map<int, Consumer> consumers;
+            std::vector<Batch> batches;
+            bool draining;
+            std::vector<int> unregisteredConsumerIds;
+            int nextConsumerId;
+            guint timeoutId;
+    };
+
+}
+
+#endif // FFMPEG_KIT_TEST_LOG_SINK_H
@@ -0,0 +1,226 @@
+/*
+ * Copyright (c) 2022 Taner Sener
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#include "LogSinkTest.h"
+#include "LogSink.h"
+#include <chrono>
+#include <algorithm>
+#include <atomic>
+#include <fstream>
+#include <iostream>
+#include <thread>
+#include <unistd.h>
+#include <vector>
+
+using namespace ffmpegkittest;
+
+static const int BenchmarkLineCount = 200000;
+static const int DrainEvery = 4095;
+static const int ProducerCount = 4;
+static const int LinesPerProducer = 250000;
+
+static long getResidentSetSize() {
+    long pages = 0;
+    long residentPages = 0;
+    std::ifstream statm("/proc/self/statm");
+    statm >> pages >> residentPages;
+    return residentPages * sysconf(_SC_PAGESIZE) / 1024;
+}
+
+void testShortAndLongLinesKeepTheirOrder() {
+    LogSink logSink(16);
+    std::string first;
+    std::string second;
+    const std::string longLine(LogSink::InlineMessageLength * 3, 'x');
+
+    const int firstConsumerId = logSink.registerConsumer([&first](const std::string& batch) {
+        first.append(batch);
+    });
+    const int secondConsumerId = logSink.registerConsumer([&second](const std::string& batch) {
+        second.append(batch);
+    });
+
+    for (int round = 0; round < 3; round++) {
+        logSink.push(firstConsumerId, "a\n");
+        logSink.push(secondConsumerId, longLine);
+        logSink.push(firstConsumerId, "b\n");
+        assert(logSink.drain() == 3);
+    }
+
+    assert(first == "a\nb\na\nb\na\nb\n");
+    assert(second == longLine + longLine + longLine);
+}
+
+void testConsumersUnregisteredWhileDraining() {
+    LogSink logSink(16);
+    std::string first;
+    std::string second;
+    int secondConsumerId = 0;
+
+    // THE FIRST CONSUMER REMOVES ITSELF AND THE SECOND ONE WHILE ITS BATCH IS DELIVERED
+    int firstConsumerId = 0;
+    firstConsumerId = logSink.registerConsumer([&](const std::string& batch) {
+        first.append(batch);
+        logSink.unregisterConsumer(firstConsumerId);
+        logSink.unregisterConsumer(secondConsumerId);
+    });
+    secondConsumerId = logSink.registerConsumer([&second](const std::string& batch) {
+        second.append(batch);
+    });
+
+    logSink.push(firstConsumerId, "a\n");
+    logSink.push(secondConsumerId, "b\n");
+    assert(logSink.drain() == 2);
+    assert(first == "a\n");
+    assert(second.empty());
+
+    logSink.push(firstConsumerId, "c\n");
+    logSink.push(secondConsumerId, "d\n");
+    assert(logSink.drain() == 2);
+    assert(first == "a\n");
+    assert(second.empty());
+}
+
+void benchmarkLogPaths() {
+    const std::string line = "[libx264 @ 0x55d1c4a3e2c0] frame I:1     Avg QP:20.43  size: 41542\n";
+    std::string output;
+
+    // PREVIOUS PATH, A SHARED STRING AND A HEAP PAIR PER LINE WAITING FOR THE MAIN LOOP
+    const long legacyResidentSetSize = getResidentSetSize();
+    long legacyPeak = 0;
+    auto start = std::chrono::steady_clock::now();
+    std::vector<std::pair<void*, std::shared_ptr<std::string>>*> pending;
+    for (int i = 0; i < BenchmarkLineCount; i++) {
+        pending.push_back(new std::pair<void*, std::shared_ptr<std::string>>(nullptr, std::make_shared<std::string>(line)));
+        if ((i & DrainEvery) == DrainEvery) {
+            legacyPeak = std::max(legacyPeak, getResidentSetSize() - legacyResidentSetSize);
+            for (auto parameters : pending) {
+                output.assign(*parameters->second);
+                delete parameters;
+            }
+            pending.clear();
+        }
+    }
+    const double legacyNanoseconds = std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - start).count();
+    for (auto parameters : pending) {
+        delete parameters;
+    }
+
+    LogSink logSink;
+    const int consumerId = logSink.registerConsumer([&output](const std::string& batch) {
+        output.assign(batch);
+    });
+    const long sinkResidentSetSize = getResidentSetSize();
+    long sinkPeak = 0;
+    start = std::chrono::steady_clock::now();
+    for (int i = 0; i < BenchmarkLineCount; i++) {
+        logSink.push(consumerId, line);
+        if ((i & DrainEvery) == DrainEvery) {
+            sinkPeak = std::max(sinkPeak, getResidentSetSize() - sinkResidentSetSize);
+            logSink.drain();
+        }
+    }
+    const double sinkNanoseconds = std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - start).count();
+
+    assert(logSink.getDroppedCount() == 0);
+
+    std::cout << "Log path benchmark, " << BenchmarkLineCount << " lines: shared string and pair "
+              << (long)(legacyNanoseconds / BenchmarkLineCount) << " ns per line, +" << legacyPeak << " KB resident; log sink "
+              << (long)(sinkNanoseconds / BenchmarkLineCount) << " ns per line, +" << sinkPeak << " KB resident." << std::endl;
+}
+
+void benchmarkSustainedThroughput() {
+    const std::string line = "frame=  112 fps= 56 q=23.0 size=    1024kB time=00:00:03.73 bitrate=2247.6kbits/s speed=1.87x\n";
+    double linesPerSecond = 0;
+    double deliveredPerSecond = 0;
+    uint64_t rejected = 0;
+
+    // PRODUCERS WRITE AS FAST AS THEY CAN, ONCE INTO A THREAD LOCAL STRING AND ONCE INTO THE SINK. THE SINK IS DRAINED
+    // WITHOUT PAUSES AND A PRODUCER RETRIES A LINE THE FULL QUEUE REJECTED, SO EVERY LINE IS DELIVERED AND THE RATE
+    // MEASURES DELIVERY AND NOT THE DROP PATH
+    for (int sink = 0; sink < 2; sink++) {
+        LogSink logSink;
+        std::atomic<size_t> deliveredBytes(0);
+        const int consumerId = logSink.registerConsumer([&deliveredBytes](const std::string& batch) {
+            deliveredBytes += batch.size();
+        });
+
+        std::atomic<bool> producing(true);
+        std::thread drainThread([&logSink, &producing, sink]() {
+            while (sink == 1 && producing.load()) {
+                if (logSink.drain() == 0) {
+                    std::this_thread::yield();
+                }
+            }
+        });
+
+        const auto start = std::chrono::steady_clock::now();
+        std::vector<std::thread> producers;
+        for (int i = 0; i < ProducerCount; i++) {
+            producers.emplace_back([&logSink, &line, consumerId, sink]() {
+                std::string output;
+                for (int count = 0; count < LinesPerProducer; count++) {
+                    if (sink == 1) {
+                        while (!logSink.push(consumerId, line)) {
+                            std::this_thread::yield();
+                        }
+                    } else {
+                        output.assign(line);
+                    }
+                }
+            });
+        }
+        for (auto& producer : producers) {
+            producer.join();
+        }
+        producing = false;
+        drainThread.join();
+        while (logSink.drain() > 0) {
+        }
+        const double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+        if (sink == 0) {
+            linesPerSecond = ProducerCount * LinesPerProducer / seconds;
+        } else {
+            rejected = logSink.getDroppedCount();
+            deliveredPerSecond = logSink.getDeliveredCount() / seconds;
+            assert(logSink.getDeliveredCount() == (uint64_t)ProducerCount * LinesPerProducer);
+            assert(deliveredBytes.load() == logSink.getDeliveredCount() * line.size());
+        }
+    }
+
+    std::cout << "Sustained log throughput, " << ProducerCount << " producers: " << (long)linesPerSecond << " lines per second without the sink, "
+              << (long)deliveredPerSecond << " lines per second delivered by a continuously drained sink, which rejected " << rejected
+              << " pushes into its full queue." << std::endl;
+}
+
+void testLogSink(void) {
+    testShortAndLongLinesKeepTheirOrder();
+    testConsumersUnregisteredWhileDraining();
+
+    std::cout << "LogSinkTest passed." << std::endl;
+}
+
+void benchmarkLogSink(void) {
+    benchmarkLogPaths();
+    benchmarkSustainedThroughput();
+}
@@ -23,10 +23,17 @@
 #include "OtherTab.h"
 #include "Application.h"
 #include "Constants.h"
+#include "Fingerprinter.h"
+#include "LogSink.h"
 #include "Popup.h"
+#include "SessionRouter.h"
+#include "ToneMapLut.h"
 #include "Video.h"
 #include <FFmpegKit.h>
 #include <FFmpegKitConfig.h>
+#include <algorithm>
+#include <chrono>
+#include <thread>
 
 using namespace ffmpegkit;
 
@@ -46,15 +53,7 @@ static gboolean showTestFailedPopup(const std::pair<Gtk::Window*,const std::stri
     return FALSE;
 }
 
-static gboolean appendLog(const std::pair<ffmpegkittest::OtherTab*,const std::shared_ptr<Log>>* parameters) {
-    ffmpegkittest::OtherTab* otherTab = parameters->first;
-    auto log = parameters->second;
-    otherTab->appendOutput(log->getMessage());
-    delete parameters;
-    return FALSE;
-}
-
-ffmpegkittest::OtherTab::OtherTab() : selectedTest(-1) {
+ffmpegkittest::OtherTab::OtherTab() : selectedTest(-1), outputView("other") {
     testModel = Gtk::ListStore::create(testModelColumn);
     test.set_model(testModel);
     test.set_size_request(240, 30);
@@ -70,19 +69,18 @@ ffmpegkittest::OtherTab::OtherTab() : selectedTest(-1) {
     Util::applyButtonStyle(runButton);
     runButtonBox.pack_start(runButton, Gtk::PACK_EXPAND_PADDING);
 
-    outputText.set_editable(false);
-    Util::applyOutputTextStyle(outputText);
-    outputTextWindow.add(outputText);
+    logConsumerId = LogSink::getInstance().registerConsumer([this](const std::string& batch) {
+        appendOutput(batch);
+    });
+    fingerprinter.reset(new Fingerprinter(Application::getApplicationCacheDirectory(), logConsumerId));
 
     pack_start(testBox, Gtk::PACK_SHRINK);
     pack_start(runButtonBox, Gtk::PACK_SHRINK);
-    add(outputTextWindow);
+    add(outputView);
 }
 
 void ffmpegkittest::OtherTab::setActive() {
     std::cout << "Other Tab Activated" << std::endl;
-    FFmpegKitConfig::enableLogCallback(nullptr);
-    FFmpegKitConfig::enableStatisticsCallback(nullptr);
 }
 
 void ffmpegkittest::OtherTab::setParentWindow(Gtk::Window* parentWindow) {
@@ -90,13 +88,11 @@ void ffmpegkittest::OtherTab::setParentWindow(Gtk::Window* parentWindow) {
 }
 
 void ffmpegkittest::OtherTab::appendOutput(const std::string& string) {
-    outputText.get_buffer()->set_text(outputText.get_buffer()->get_text() + string);
-    Glib::RefPtr<Gtk::Adjustment> adj = outputText.get_vadjustment();
-    adj->set_value(adj->get_upper());
+    outputView.append(string);
 }
 
 void ffmpegkittest::OtherTab::clearOutput() {
-    outputText.get_buffer()->set_text("");
+    outputView.clear();
 }
 
 void ffmpegkittest::OtherTab::initTestData() {
@@ -116,6 +112,14 @@ void ffmpegkittest::OtherTab::initTestData() {
     row[testModelColumn.columnId] = "4";
     row[testModelColumn.columnName] = "zscale";
 
+    row = *(testModel->append());
+    row[testModelColumn.columnId] = "5";
+    row[testModelColumn.columnName] = "chromaprint batch";
+
+    row = *(testModel->append());
+    row[testModelColumn.columnId] = "6";
+    row[testModelColumn.columnName] = "zscale lut";
+
     test.pack_start(testModelColumn.columnName);
     test.set_entry_text_column(testModelColumn.columnId);
     test.set_active(0);
@@ -136,6 +140,8 @@ std::string ffmpegkittest::OtherTab::getSelectedTest() {
         case 1: return "dav1d";
         case 2: return "webp";
         case 3: return "zscale";
+        case 4: return "chromaprint batch";
+        case 5: return "zscale lut";
         default: return "";
     }
 }
@@ -152,44 +158,51 @@ void ffmpegkittest::OtherTab::runTest() {
         testWebp();
     } else if (selectedTest.compare("zscale") == 0) {
         testZscale();
+    } else if (selectedTest.compare("chromaprint batch") == 0) {
+        testChromaprintBatch();
+    } else if (selectedTest.compare("zscale lut") == 0) {
+        testZscaleLut();
     }
 }
 
 void ffmpegkittest::OtherTab::testChromaprint() {
     std::cout << "Testing 'chromaprint' mutex." << std::endl;
 
-    std::string audioSampleFile = getChromaprintSampleFile();
-    std::remove(audioSampleFile.c_str());
-
-    std::string ffmpegCommand = "-hide_banner -y -f lavfi -i sine=frequency=1000:duration=5 -c:a pcm_s16le " + audioSampleFile;
-
-    std::cout << "Creating audio sample with '" << ffmpegCommand << "'." << std::endl;
-
-    FFmpegKit::executeAsync(ffmpegCommand, [this,audioSampleFile](auto session) {
-        std::cout << "FFmpeg process exited with state " << FFmpegKitConfig::sessionStateToString(session->getState()) << " and rc " << session->getReturnCode() << "." << session->getFailStackTrace() << std::endl;
-
-        if (ReturnCode::isSuccess(session->getReturnCode())) {
-            std::cout << "AUDIO sample created." << std::endl;
+    // THE GENERATED SAMPLE IS FINGERPRINTED DIRECTLY, WITHOUT AN INTERMEDIATE WAV FILE
+    fingerprinter->fingerprint("-f lavfi -i sine=frequency=1000:duration=5", [this](const Fingerprint& fingerprint) {
+        if (fingerprint.succeeded) {
+            std::cout << "Chromaprint fingerprint created in " << fingerprint.duration << " ms: " << fingerprint.fingerprint << std::endl;
+            g_idle_add((GSourceFunc)showTestSuccessPopup, new std::pair<Gtk::Window*,const std::string>(this->parentWindow, "Testing chromaprint completed successfully."));
+        } else {
+            g_idle_add((GSourceFunc)showTestFailedPopup, new std::pair<Gtk::Window*,const std::string>(this->parentWindow, "Testing chromaprint failed. Please check logs for the details."));
+        }
+    });
+}
 
-            std::string chromaprintCommand = "-hide_banner -y -i " + audioSampleFile + " -f chromaprint -fp_format 2 " + getChromaprintOutputFile();
+void ffmpegkittest::OtherTab::testChromaprintBatch() {
+    const std::string directory = Application::getApplicationCacheDirectory();
+    const std::vector<std::string> extensions{".aac", ".flac", ".m4a", ".mp2", ".mp3", ".ogg", ".opus", ".wav", ".wv"};
+    const auto start = std::chrono::steady_clock::now();
 
-            std::cout << "FFmpeg process started with arguments: '" << chromaprintCommand << "'." << std::endl;
+    std::cout << "Testing 'chromaprint' on the audio files of " << directory << "." << std::endl;
 
-            FFmpegKit::executeAsync(chromaprintCommand, [this](auto secondSession) {
-                std::cout << "FFmpeg process exited with state " << FFmpegKitConfig::sessionStateToString(secondSession->getState()) << " and rc " << secondSession->getReturnCode() << "." << secondSession->getFailStackTrace() << std::endl;
-                if (ReturnCode::isSuccess(secondSession->getReturnCode())) {
-                    g_idle_add((GSourceFunc)showTestSuccessPopup, new std::pair<Gtk::Window*,const std::string>(this->parentWindow, "Testing chromaprint completed successfully."));
-                } else {
-                    g_idle_add((GSourceFunc)showTestFailedPopup, new std::pair<Gtk::Window*,const std::string>(this->parentWindow, "Testing chromaprint failed. Please check logs for the details."));
-                }
-            }, [this](auto log) {
-                g_idle_add((GSourceFunc)appendLog, new std::pair<OtherTab*,const std::shared_ptr<Log>>(this, log));
-            }, nullptr);
+    const int fileCount = fingerprinter->fingerprintDirectory(directory, std::max(1, JobScheduler::getPhysicalCoreCount()), extensions, [](const Fingerprint& fingerprint) {
+        std::cout << "Fingerprint of " << fingerprint.input << (fingerprint.succeeded ? ": " + fingerprint.fingerprint : " failed") << std::endl;
+    }, [this, start](const std::vector<Fingerprint>& fingerprints) {
+        const long elapsed = (long)std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::steady_clock::now() - start).count();
+        const long succeeded = std::count_if(fingerprints.begin(), fingerprints.end(), [](const Fingerprint& fingerprint) {
+            return fingerprint.succeeded;
+        });
 
+        std::cout << "Fingerprinted " << succeeded << " of " << fingerprints.size() << " files in " << elapsed << " ms." << std::endl;
+        if (succeeded == (long)fingerprints.size()) {
+            g_idle_add((GSourceFunc)showTestSuccessPopup, new std::pair<Gtk::Window*,const std::string>(this->parentWindow, "Testing chromaprint batch completed successfully."));
         } else {
-            g_idle_add((GSourceFunc)showTestFailedPopup, new std::pair<Gtk::Window*,const std::string>(this->parentWindow, "Creating AUDIO sample failed. Please check logs for the details."));
+            g_idle_add((GSourceFunc)showTestFailedPopup, new std::pair<Gtk::Window*,const std::string>(this->parentWindow, "Testing chromaprint batch failed. Please check logs for the details."));
         }
     });
+
+    std::cout << fileCount << " audio files queued for fingerprinting." << std::endl;
 }
 
 void ffmpegkittest::OtherTab::testDav1d() {
@@ -199,11 +212,9 @@ void ffmpegkittest::OtherTab::testDav1d() {
 
     std::cout << "FFmpeg process started with arguments: '" << ffmpegCommand << "'." << std::endl;
 
-    FFmpegKit::executeAsync(ffmpegCommand, [this](auto session) {
+    SessionRouter::getInstance().executeAsync(ffmpegCommand, [this](auto session) {
         std::cout << "FFmpeg process exited with state " << FFmpegKitConfig::sessionStateToString(session->getState()) << " and rc " << session->getReturnCode() << "." << session->getFailStackTrace() << std::endl;
-    }, [this](auto log) {
-        g_idle_add((GSourceFunc)appendLog, new std::pair<OtherTab*,const std::shared_ptr<Log>>(this, log));
-    }, nullptr);
+    }, logConsumerId);
 }
 
 void ffmpegkittest::OtherTab::testWebp() {
@@ -216,7 +227,7 @@ void ffmpegkittest::OtherTab::testWebp() {
 
     std::cout << "FFmpeg process started with arguments: '" << ffmpegCommand << "'." << std::endl;
 
-    auto session = FFmpegKit::executeAsync(ffmpegCommand, [this](auto session) {
+    auto session = SessionRouter::getInstance().executeAsync(ffmpegCommand, [this](auto session) {
         std::cout << "FFmpeg process exited with state " << FFmpegKitConfig::sessionStateToString(session->getState()) << " and rc " << session->getReturnCode() << "." << session->getFailStackTrace() << std::endl;
 
         if (ReturnCode::isSuccess(session->getReturnCode())) {
@@ -224,9 +235,7 @@ void ffmpegkittest::OtherTab::testWebp() {
         } else {
             g_idle_add((GSourceFunc)showTestFailedPopup, new std::pair<Gtk::Window*,const std::string>(this->parentWindow, "Encode webp failed. Please check logs for the details."));
         }
-    }, [this](auto log) {
-        g_idle_add((GSourceFunc)appendLog, new std::pair<OtherTab*,const std::shared_ptr<Log>>(this, log));
-    }, nullptr);
+    }, logConsumerId);
 }
 
 void ffmpegkittest::OtherTab::testZscale() {
@@ -239,7 +248,7 @@ void ffmpegkittest::OtherTab::testZscale() {
 
     std::cout << "FFmpeg process started with arguments: '" << ffmpegCommand << "'." << std::endl;
 
-    auto session = FFmpegKit::executeAsync(ffmpegCommand, [this](auto session) {
+    auto session = SessionRouter::getInstance().executeAsync(ffmpegCommand, [this](auto session) {
         std::cout << "FFmpeg process exited with state " << FFmpegKitConfig::sessionStateToString(session->getState()) << " and rc " << session->getReturnCode() << "." << session->getFailStackTrace() << std::endl;
 
         if (ReturnCode::isSuccess(session->getReturnCode())) {
@@ -247,19 +256,52 @@ void ffmpegkittest::OtherTab::testZscale() {
         } else {
             g_idle_add((GSourceFunc)showTestFailedPopup, new std::pair<Gtk::Window*,const std::string>(this->parentWindow, "zscale failed. Please check logs for the details."));
         }
-    }, [this](auto log) {
-        g_idle_add((GSourceFunc)appendLog, new std::pair<OtherTab*,const std::shared_ptr<Log>>(this, log));
-    }, nullptr);
+    }, logConsumerId);
 }
 
-std::string ffmpegkittest::OtherTab::getChromaprintSampleFile() {
-    return Application::getApplicationCacheDirectory() + "/audio-sample.wav";
+void ffmpegkittest::OtherTab::testZscaleLut() {
+    std::cout << "Testing 'zscale' tone mapping through a baked 3D LUT." << std::endl;
+
+    // BAKING, THE QUALITY CHECK AND THE BENCHMARK ARE SYNCHRONOUS, SO THEY RUN OUTSIDE THE MAIN LOOP
+    std::thread([this]() {
+        const std::string lutFile = ToneMapLut::prepare(Application::getApplicationCacheDirectory(), ToneMapLut::DefaultTransfer, ToneMapLut::DefaultPrimaries, ToneMapLut::DefaultMatrix);
+        if (lutFile.empty()) {
+            g_idle_add((GSourceFunc)showTestFailedPopup, new std::pair<Gtk::Window*,const std::string>(this->parentWindow, "Baking the zscale lut failed. Please check logs for the details."));
+            return;
+        }
+
+        // ONE 4K 10 BIT FRAME IS GENERATED AND REPLAYED, SO THE SOURCE COSTS ALMOST NOTHING NEXT TO THE TONE MAPPING
+        const int frameCount = 100;
+        const std::string hdrSource = "-f lavfi -i testsrc2=s=3840x2160:r=25:d=0.04,format=yuv420p10le,loop=loop=" + std::to_string(frameCount - 1) + ":size=1";
+        const std::string toneMapFilters = ToneMapLut::generateToneMapFilters(ToneMapLut::DefaultTransfer, ToneMapLut::DefaultPrimaries, ToneMapLut::DefaultMatrix) + ",format=yuv420p";
+
+        // BOTH PATHS READ THE SAME FRAMES IN ONE GRAPH AND ARE COMPARED FRAME BY FRAME
+        auto psnrSession = FFmpegKit::execute("-hide_banner " + hdrSource + " -i \"" + lutFile + "\" -filter_complex \"" + ToneMapLut::generateApplyFilterGraph(ToneMapLut::DefaultMatrix) + ";[0:v]" + toneMapFilters + "[zscaled];[video][zscaled]psnr\" -f null -");
+        const std::string logs = psnrSession->getAllLogsAsString();
+        const size_t average = logs.rfind("average:");
+        const std::string psnr = (average == std::string::npos) ? "unknown" : logs.substr(average + 8, logs.find(' ', average) - average - 8);
+
+        auto zscaleSession = FFmpegKit::execute("-hide_banner " + hdrSource + " -vf " + toneMapFilters + " -c:v wrapped_avframe -f null -");
+        auto lutSession = FFmpegKit::execute("-hide_banner " + hdrSource + " -i \"" + lutFile + "\" -filter_complex \"" + ToneMapLut::generateApplyFilterGraph(ToneMapLut::DefaultMatrix) + "\" -map [video] -c:v wrapped_avframe -f null -");
+        const double zscaleFps = zscaleSession->getDuration() > 0 ? frameCount * 1000.0 / zscaleSession->getDuration() : 0;
+        const double lutFps = lutSession->getDuration() > 0 ? frameCount * 1000.0 / lutSession->getDuration() : 0;
+
+        std::cout << "Tone mapped 4K frames at " << zscaleFps << " fps with zscale and at " << lutFps << " fps with the lut, PSNR " << psnr << " dB" << (ReturnCode::isSuccess(zscaleSession->getReturnCode()) && ReturnCode::isSuccess(lutSession->getReturnCode()) ? "" : " (failed)") << "." << std::endl;
+
+        // THE VIDEO CREATED ON THE VIDEO TAB IS TONE MAPPED THE SAME WAY AS THE ZSCALE TEST DOES IT
+        std::string videoFile = Application::getApplicationCacheDirectory() + "/video.mp4";
+        std::string lutVideoFile = Application::getApplicationCacheDirectory() + "/video-zscaled-lut.mp4";
+        auto session = FFmpegKit::execute(ToneMapLut::generateApplyScript(videoFile, lutVideoFile, lutFile, ToneMapLut::DefaultMatrix));
+        std::cout << "FFmpeg process exited with state " << FFmpegKitConfig::sessionStateToString(session->getState()) << " and rc " << session->getReturnCode() << "." << session->getFailStackTrace() << std::endl;
+
+        if (ReturnCode::isSuccess(session->getReturnCode())) {
+            g_idle_add((GSourceFunc)showTestSuccessPopup, new std::pair<Gtk::Window*,const std::string>(this->parentWindow, "zscale lut completed successfully."));
+        } else {
+            g_idle_add((GSourceFunc)showTestFailedPopup, new std::pair<Gtk::Window*,const std::string>(this->parentWindow, "zscale lut failed. Please check logs for the details."));
+        }
+    }).detach();
 }
 
 std::string ffmpegkittest::OtherTab::getDav1dOutputFile() {
     return Application::getApplicationCacheDirectory() + "/video.mp4";
 }
-
-std::string ffmpegkittest::OtherTab::getChromaprintOutputFile() {
-    return Application::getApplicationCacheDirectory() + "/chromaprint.txt";
-}
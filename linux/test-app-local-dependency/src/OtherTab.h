@@ -23,8 +23,11 @@
 #ifndef FFMPEG_KIT_TEST_OTHER_TAB_H
 #define FFMPEG_KIT_TEST_OTHER_TAB_H
 
+#include "Fingerprinter.h"
+#include "OutputView.h"
 #include "Util.h"
 #include <gtkmm.h>
+#include <memory>
 
 namespace ffmpegkittest {
 
@@ -45,12 +48,12 @@ namespace ffmpegkittest {
             std::string getSelectedTest();
             void runTest();
             void testChromaprint();
+            void testChromaprintBatch();
             void testDav1d();
             void testWebp();
             void testZscale();
-            std::string getChromaprintSampleFile();
+            void testZscaleLut();
             std::string getDav1dOutputFile();
-            std::string getChromaprintOutputFile();
 
             Glib::RefPtr<Gtk::ListStore> testModel;
             ComboBoxModelColumn testModelColumn;
@@ -59,9 +62,10 @@ namespace ffmpegkittest {
             int selectedTest;
             Gtk::Button runButton;
             Gtk::HBox runButtonBox;
-            Gtk::TextView outputText;
-            Gtk::ScrolledWindow outputTextWindow;
+            OutputView outputView;
             Gtk::Window* parentWindow;
+            int logConsumerId;
+            std::unique_ptr<Fingerprinter> fingerprinter;
     };
 
 }
@@ -0,0 +1,91 @@
+/*
+ * Copyright (c) 2022 Taner Sener
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#include "OutputView.h"
+#include "Application.h"
+#include "Util.h"
+#include <algorithm>
+#include <cstdio>
+
+ffmpegkittest::OutputView::OutputView(const std::string& name, const int maxLines, const int maxCharacters) : name(name), maxLines(maxLines), maxCharacters(maxCharacters) {
+    textView.set_editable(false);
+    Util::applyOutputTextStyle(textView);
+    add(textView);
+
+    auto buffer = textView.get_buffer();
+    endMark = buffer->create_mark(buffer->end(), false);
+
+    // SPILLED LINES ARE APPENDED, SO THE OUTPUT OF AN EARLIER RUN IS DELETED FIRST
+    std::remove(getSpillFile().c_str());
+}
+
+void ffmpegkittest::OutputView::append(const std::string& string) {
+    auto buffer = textView.get_buffer();
+    buffer->insert(buffer->end(), string);
+
+    // TRIMS IN CHUNKS SO THAT THE COST OF ERASING IS SPREAD OVER MANY APPENDS
+    if (buffer->get_line_count() > maxLines + maxLines / 4 || buffer->get_char_count() > maxCharacters + maxCharacters / 4) {
+        trim();
+    }
+
+    textView.scroll_to(endMark);
+}
+
+void ffmpegkittest::OutputView::clear() {
+    textView.get_buffer()->set_text("");
+    if (spillStream.is_open()) {
+        spillStream.close();
+    }
+    std::remove(getSpillFile().c_str());
+}
+
+std::string ffmpegkittest::OutputView::getSpillFile() const {
+    return Application::getApplicationCacheDirectory() + "/" + name + "-output.txt";
+}
+
+void ffmpegkittest::OutputView::trim() {
+    auto buffer = textView.get_buffer();
+
+    int removedLines = buffer->get_line_count() - maxLines;
+    if (buffer->get_char_count() > maxCharacters) {
+        const int lineCount = buffer->get_line_count();
+        const int averageLineLength = buffer->get_char_count() / (lineCount > 0 ? lineCount : 1) + 1;
+        removedLines = std::max(removedLines, (buffer->get_char_count() - maxCharacters) / averageLineLength + 1);
+    }
+    if (removedLines <= 0) {
+        return;
+    }
+
+    auto start = buffer->begin();
+    auto end = buffer->get_iter_at_line(removedLines);
+
+    if (!spillStream.is_open()) {
+        spillStream.open(getSpillFile(), std::ios::out | std::ios::app);
+    }
+    if (spillStream.is_open()) {
+        const Glib::ustring removedText = buffer->get_text(start, end);
+        spillStream.write(removedText.data(), removedText.bytes());
+        spillStream.flush();
+    }
+
+    buffer->erase(start, end);
+}
@@ -0,0 +1,60 @@
+/*
+ * Copyright (c) 2022 Taner Sener
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#ifndef FFMPEG_KIT_TEST_OUTPUT_VIEW_H
+#define FFMPEG_KIT_TEST_OUTPUT_VIEW_H
+
+#include <gtkmm.h>
+#include <fstream>
+#include <string>
+
+namespace ffmpegkittest {
+
+    /**
+     * Scrollable read-only text output that appends at the end of its buffer and keeps only
+     * the most recent lines on screen. Older lines are spilled into a file under the
+     * application cache directory, which holds only the output of the current run.
+     */
+    class OutputView: public Gtk::ScrolledWindow {
+        public:
+            static constexpr const int DefaultMaxLines = 2000;
+            static constexpr const int DefaultMaxCharacters = 256 * 1024;
+
+            OutputView(const std::string& name, const int maxLines = DefaultMaxLines, const int maxCharacters = DefaultMaxCharacters);
+            void append(const std::string& string);
+            void clear();
+            std::string getSpillFile() const;
+
+        private:
+            void trim();
+
+            Gtk::TextView textView;
+            Glib::RefPtr<Gtk::TextBuffer::Mark> endMark;
+            const std::string name;
+            const int maxLines;
+            const int maxCharacters;
+            std::ofstream spillStream;
+    };
+
+}
+
+#endif // FFMPEG_KIT_TEST_OUTPUT_VIEW_H
@@ -24,8 +24,10 @@
 #include "Application.h"
 #include "Constants.h"
 #include "Log.h"
+#include "LogSink.h"
 #include "Popup.h"
-#include "Statistics.h"
+#include "ProgressEstimator.h"
+#include "SessionRouter.h"
 #include "Video.h"
 #include <FFmpegKit.h>
 #include <FFmpegKitConfig.h>
@@ -38,22 +40,6 @@ static gboolean showCreateFailedPopup(Gtk::Window* window) {
     return FALSE;
 }
 
-static gboolean saveStatistics(const std::pair<ffmpegkittest::PipeTab*,const std::shared_ptr<Statistics>>* parameters) {
-    ffmpegkittest::PipeTab* videoTab = parameters->first;
-    auto statistics = parameters->second;
-    videoTab->updateProgressDialog(statistics);
-    delete parameters;
-    return FALSE;
-}
-
-static gboolean appendLog(const std::pair<ffmpegkittest::PipeTab*,const std::shared_ptr<Log>>* parameters) {
-    ffmpegkittest::PipeTab* videoTab = parameters->first;
-    auto log = parameters->second;
-    videoTab->appendOutput(log->getMessage());
-    delete parameters;
-    return FALSE;
-}
-
 static void startAsyncCatImageProcess(std::string imagePath, std::shared_ptr<std::string> namedPipePath) {
     auto thread = std::thread([imagePath,namedPipePath]() {
         std::string asyncCommand = "cat " + imagePath + " > " + *namedPipePath;
@@ -67,7 +53,7 @@ static void startAsyncCatImageProcess(std::string imagePath, std::shared_ptr<std
     thread.detach();
 }
 
-ffmpegkittest::PipeTab::PipeTab() : statistics(nullptr) {
+ffmpegkittest::PipeTab::PipeTab() : outputView("pipe"), statistics() {
     createButton.set_label("CREATE");
     createButton.set_size_request(120, 30);
     createButton.set_tooltip_text(Constants::PipeTestTooltipText);
@@ -75,22 +61,19 @@ ffmpegkittest::PipeTab::PipeTab() : statistics(nullptr) {
     Util::applyButtonStyle(createButton);
     createButtonBox.pack_start(createButton, Gtk::PACK_EXPAND_PADDING);
 
-    outputText.set_editable(false);
-    Util::applyOutputTextStyle(outputText);
-    outputTextWindow.add(outputText);
+    logConsumerId = LogSink::getInstance().registerConsumer([this](const std::string& batch) {
+        appendOutput(batch);
+    });
+    statisticsConsumerId = SessionRouter::getInstance().registerStatisticsConsumer([this](const StatisticsSnapshot& statistics) {
+        updateProgressDialog(statistics);
+    });
 
     pack_start(createButtonBox, Gtk::PACK_SHRINK);
-    add(outputTextWindow);
+    add(outputView);
 }
 
 void ffmpegkittest::PipeTab::setActive() {
     std::cout << "Pipe Tab Activated" << std::endl;
-    FFmpegKitConfig::enableLogCallback([this](auto log) {
-        g_idle_add((GSourceFunc)appendLog, new std::pair<PipeTab*,const std::shared_ptr<Log>>(this, log));
-    });
-    FFmpegKitConfig::enableStatisticsCallback([this](auto statistics) {
-        g_idle_add((GSourceFunc)saveStatistics, new std::pair<PipeTab*,const std::shared_ptr<Statistics>>(this, statistics));
-    });
 }
 
 void ffmpegkittest::PipeTab::setParentWindow(Gtk::Window* parentWindow) {
@@ -98,26 +81,22 @@ void ffmpegkittest::PipeTab::setParentWindow(Gtk::Window* parentWindow) {
 }
 
 void ffmpegkittest::PipeTab::appendOutput(const std::string& string) {
-    outputText.get_buffer()->set_text(outputText.get_buffer()->get_text() + string);
-    Glib::RefPtr<Gtk::Adjustment> adj = outputText.get_vadjustment();
-    adj->set_value(adj->get_upper());
+    outputView.append(string);
 }
 
-void ffmpegkittest::PipeTab::updateProgressDialog(const std::shared_ptr<ffmpegkit::Statistics> statistics) {
-    if (statistics == nullptr || statistics->getTime() < 0) {
+void ffmpegkittest::PipeTab::updateProgressDialog(const StatisticsSnapshot& statistics) {
+    if (statistics.time < 0) {
         return;
     }
 
     this->statistics = statistics;
-    double timeInMilliseconds = this->statistics->getTime();
-    int totalVideoDuration = 9000;
-    double completePercentage = timeInMilliseconds*100/totalVideoDuration;
-    // progressDialog.update(completePercentage);
-    std::cout << "Creating video: " << completePercentage << "%" << std::endl;
+    auto progress = ProgressEstimator::getInstance().update(statistics);
+    // progressDialog.update(progress.percentage);
+    std::cout << "Creating video: " << ProgressEstimator::format(progress) << std::endl;
 }
 
 void ffmpegkittest::PipeTab::clearOutput() {
-    outputText.get_buffer()->set_text("");
+    outputView.clear();
 }
 
 void ffmpegkittest::PipeTab::createVideo() {
@@ -142,7 +121,7 @@ void ffmpegkittest::PipeTab::createVideo() {
 
     std::cout << "FFmpeg process started with arguments: '" << ffmpegCommand << "'." << std::endl;
 
-    auto session = FFmpegKit::executeAsync(ffmpegCommand, [this,pipe1,pipe2,pipe3](auto session) {
+    auto session = SessionRouter::getInstance().executeAsync(ffmpegCommand, [this,pipe1,pipe2,pipe3](auto session) {
         const auto state = session->getState();
         auto returnCode = session->getReturnCode();
 
@@ -160,11 +139,8 @@ void ffmpegkittest::PipeTab::createVideo() {
         } else {
             g_idle_add((GSourceFunc)showCreateFailedPopup, this->parentWindow);
         }
-    }, [this](auto log) {
-        g_idle_add((GSourceFunc)appendLog, new std::pair<PipeTab*,const std::shared_ptr<Log>>(this, log));
-    }, [this](auto statistics) {
-        g_idle_add((GSourceFunc)saveStatistics, new std::pair<PipeTab*,const std::shared_ptr<Statistics>>(this, statistics));
-    });
+    }, logConsumerId, statisticsConsumerId);
+    ProgressEstimator::getInstance().expectDuration(session->getSessionId(), Video::getEncodeVideoDuration());
 
     // START ASYNC PROCESSES AFTER INITIATING FFMPEG COMMAND
     startAsyncCatImageProcess(image1File, pipe1);
@@ -23,8 +23,9 @@
 #ifndef FFMPEG_KIT_TEST_PIPE_TAB_H
 #define FFMPEG_KIT_TEST_PIPE_TAB_H
 
+#include "OutputView.h"
 #include "ProgressDialog.h"
-#include "Statistics.h"
+#include "StatisticsAggregator.h"
 #include "Util.h"
 #include <gtkmm.h>
 
@@ -36,7 +37,7 @@ namespace ffmpegkittest {
             void setActive();
             void setParentWindow(Gtk::Window* parentWindow);
             void appendOutput(const std::string& string);
-            void updateProgressDialog(const std::shared_ptr<ffmpegkit::Statistics> statistics);
+            void updateProgressDialog(const StatisticsSnapshot& statistics);
 
         private:
             void clearOutput();
@@ -47,11 +48,12 @@ namespace ffmpegkittest {
 
             Gtk::Button createButton;
             Gtk::HBox createButtonBox;
-            Gtk::TextView outputText;
-            Gtk::ScrolledWindow outputTextWindow;
+            OutputView outputView;
             ffmpegkittest::ProgressDialog progressDialog;
             Gtk::Window* parentWindow;
-            std::shared_ptr<ffmpegkit::Statistics> statistics;
+            int logConsumerId;
+            int statisticsConsumerId;
+            StatisticsSnapshot statistics;
     };
 
 }
@@ -0,0 +1,451 @@
+/*
+ * Copyright (c) 2022 Taner Sener
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#include "Pipeline.h"
+#include "CommandTemplate.h"
+#include "SessionRouter.h"
+#include <FFmpegKit.h>
+#include <FFmpegKitConfig.h>
+#include <cstdio>
+#include <iostream>
+#include <sys/stat.h>
+#include <unistd.h>
+
+using namespace ffmpegkit;
+
+std::shared_ptr<ffmpegkittest::Pipeline> ffmpegkittest::Pipeline::create(const int logConsumerId, const int statisticsConsumerId) {
+    return create([logConsumerId, statisticsConsumerId](const PipelineNode& node, const NodeFinished& finished) {
+        std::cout << "FFmpeg process started for " << node.name << " with arguments: '" << node.command << "'." << std::endl;
+
+        // NODES ADDED AS ARGUMENTS ARE NOT PARSED AGAIN, THEIR COMMAND IS ONLY KEPT FOR LOGGING
+        auto session = SessionRouter::getInstance().executeAsync(node.arguments.empty() ? FFmpegKitConfig::parseArguments(node.command) : node.arguments, [finished](auto session) {
+            std::cout << "FFmpeg process exited with state " << FFmpegKitConfig::sessionStateToString(session->getState()) << " and rc " << session->getReturnCode() << "." << session->getFailStackTrace() << std::endl;
+
+            if (ReturnCode::isSuccess(session->getReturnCode())) {
+                finished(NodeSucceeded);
+            } else if (ReturnCode::isCancel(session->getReturnCode())) {
+                finished(NodeCancelled);
+            } else {
+                finished(NodeFailed);
+            }
+        }, logConsumerId, statisticsConsumerId);
+
+        return session->getSessionId();
+    }, [](const long sessionId) {
+        FFmpegKit::cancel(sessionId);
+    });
+}
+
+std::shared_ptr<ffmpegkittest::Pipeline> ffmpegkittest::Pipeline::create(const Executor& executor, const Canceller& canceller) {
+    return std::shared_ptr<Pipeline>(new Pipeline(executor, canceller));
+}
+
+const char* ffmpegkittest::Pipeline::nodeStateToString(const PipelineNodeState state) {
+    switch (state) {
+        case NodePending: return "pending";
+        case NodeRunning: return "running";
+        case NodeSucceeded: return "succeeded";
+        case NodeFailed: return "failed";
+        case NodeCancelled: return "cancelled";
+        default: return "skipped";
+    }
+}
+
+ffmpegkittest::Pipeline::Pipeline(const Executor& executor, const Canceller& canceller) :
+    executor(executor),
+    canceller(canceller),
+    endTime(-1),
+    started(false),
+    cancelled(false),
+    finished(false),
+    delivered(false) {
+}
+
+int ffmpegkittest::Pipeline::addNode(const std::string& name, const std::string& command, const int retries) {
+    std::lock_guard<std::mutex> lock(mutex);
+    const int id = (int)nodes.size();
+    nodes.push_back(PipelineNode{id, name, command, std::list<std::string>(), retries, 0, NodePending, -1, -1, -1});
+    return id;
+}
+
+int ffmpegkittest::Pipeline::addNode(const std::string& name, const std::list<std::string>& arguments, const int retries) {
+    std::lock_guard<std::mutex> lock(mutex);
+    const int id = (int)nodes.size();
+    nodes.push_back(PipelineNode{id, name, CommandTemplate::toString(arguments), arguments, retries, 0, NodePending, -1, -1, -1});
+    return id;
+}
+
+void ffmpegkittest::Pipeline::addFileEdge(const int from, const int to, const std::string& path) {
+    std::lock_guard<std::mutex> lock(mutex);
+    edges.push_back(Edge{from, to, EdgeFile, path});
+}
+
+void ffmpegkittest::Pipeline::addPipeEdge(const int from, const int to, const std::string& path) {
+    std::lock_guard<std::mutex> lock(mutex);
+    edges.push_back(Edge{from, to, EdgePipe, path});
+}
+
+void ffmpegkittest::Pipeline::setNodeListener(const NodeListener& nodeListener) {
+    std::lock_guard<std::mutex> lock(mutex);
+    this->nodeListener = nodeListener;
+}
+
+bool ffmpegkittest::Pipeline::start(const CompleteCallback& completeCallback) {
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        if (started) {
+            return false;
+        }
+
+        // A GRAPH WITH A CYCLE WOULD NEVER FINISH
+        std::vector<int> inDegree(nodes.size(), 0);
+        for (const Edge& edge : edges) {
+            if (edge.from < 0 || edge.to < 0 || edge.from >= (int)nodes.size() || edge.to >= (int)nodes.size()) {
+                std::cout << "Pipeline edge " << edge.from << " -> " << edge.to << " refers to an unknown node." << std::endl;
+                return false;
+            }
+            inDegree[edge.to]++;
+        }
+        std::vector<int> ready;
+        for (size_t id = 0; id < nodes.size(); id++) {
+            if (inDegree[id] == 0) {
+                ready.push_back((int)id);
+            }
+        }
+        size_t visited = 0;
+        while (!ready.empty()) {
+            const int id = ready.back();
+            ready.pop_back();
+            visited++;
+            for (const Edge& edge : edges) {
+                if (edge.from == id && --inDegree[edge.to] == 0) {
+                    ready.push_back(edge.to);
+                }
+            }
+        }
+        if (visited != nodes.size()) {
+            std::cout << "Pipeline has a cycle." << std::endl;
+            return false;
+        }
+
+        // STALE FILES MUST NOT LOOK LIKE OUTPUT OF THIS RUN
+        for (const Edge& edge : edges) {
+            if (edge.path.empty()) {
+                continue;
+            }
+            std::remove(edge.path.c_str());
+            if (edge.type == EdgePipe && mkfifo(edge.path.c_str(), 0600) != 0) {
+                std::cout << "Failed to create pipe " << edge.path << "." << std::endl;
+                return false;
+            }
+        }
+
+        this->completeCallback = completeCallback;
+        startTime = std::chrono::steady_clock::now();
+        started = true;
+    }
+
+    advance();
+    return true;
+}
+
+void ffmpegkittest::Pipeline::cancel() {
+    std::vector<long> sessionIds;
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        if (!started || finished) {
+            return;
+        }
+        cancelled = true;
+        for (const PipelineNode& node : nodes) {
+            if (node.state == NodeRunning && node.sessionId >= 0) {
+                sessionIds.push_back(node.sessionId);
+            }
+        }
+    }
+
+    for (const long sessionId : sessionIds) {
+        canceller(sessionId);
+    }
+    advance();
+}
+
+void ffmpegkittest::Pipeline::waitUntilFinished() {
+    std::unique_lock<std::mutex> lock(mutex);
+    finishedCondition.wait(lock, [this]() {
+        return delivered;
+    });
+}
+
+bool ffmpegkittest::Pipeline::isFinished() {
+    std::lock_guard<std::mutex> lock(mutex);
+    return finished;
+}
+
+bool ffmpegkittest::Pipeline::isSucceeded() {
+    std::lock_guard<std::mutex> lock(mutex);
+    if (!finished) {
+        return false;
+    }
+    for (const PipelineNode& node : nodes) {
+        if (node.state != NodeSucceeded) {
+            return false;
+        }
+    }
+    return true;
+}
+
+std::vector<ffmpegkittest::PipelineNode> ffmpegkittest::Pipeline::getNodes() {
+    std::lock_guard<std::mutex> lock(mutex);
+    return nodes;
+}
+
+long ffmpegkittest::Pipeline::getElapsedTime() {
+    std::lock_guard<std::mutex> lock(mutex);
+    if (!started) {
+        return 0;
+    }
+    return finished ? endTime : now();
+}
+
+std::string ffmpegkittest::Pipeline::describeTimings() {
+    std::lock_guard<std::mutex> lock(mutex);
+    std::string timings;
+    long busyTime = 0;
+
+    for (const PipelineNode& node : nodes) {
+        timings.append(node.name).append(": ").append(nodeStateToString(node.state));
+        if (node.startTime >= 0) {
+            timings.append(", started at ").append(std::to_string(node.startTime)).append(" ms");
+        }
+        if (node.startTime >= 0 && node.endTime >= 0) {
+            timings.append(", took ").append(std::to_string(node.endTime - node.startTime)).append(" ms");
+            busyTime += node.endTime - node.startTime;
+        }
+        if (node.attempts > 1) {
+            timings.append(", ").append(std::to_string(node.attempts)).append(" attempts");
+        }
+        timings.append("\n");
+    }
+
+    // STAGES OVERLAPPED WHEN THE WALL TIME IS BELOW THE SUM OF STAGE TIMES
+    const long wallTime = started ? (finished ? endTime : now()) : 0;
+    timings.append("pipeline: ").append(std::to_string(wallTime)).append(" ms wall time, ").append(std::to_string(busyTime)).append(" ms in stages\n");
+    return timings;
+}
+
+void ffmpegkittest::Pipeline::advance() {
+    std::vector<int> starting;
+    std::vector<PipelineNode> changed;
+    std::vector<long> cancelling;
+    CompleteCallback callback;
+    bool completed = false;
+    bool succeeded = true;
+    NodeListener listener;
+    Executor nodeExecutor;
+
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        if (finished) {
+            return;
+        }
+
+        // STARTING A PIPE WRITER MAKES ITS READER READY, SO REPEAT UNTIL NOTHING CHANGES
+        bool progress = true;
+        while (progress) {
+            progress = false;
+            for (PipelineNode& node : nodes) {
+                if (node.state != NodePending) {
+                    continue;
+                }
+                if (cancelled) {
+                    node.state = NodeCancelled;
+                    node.endTime = now();
+                    changed.push_back(node);
+                    progress = true;
+                    continue;
+                }
+
+                bool ready = true;
+                bool blocked = false;
+                for (const Edge& edge : edges) {
+                    if (edge.to != node.id) {
+                        continue;
+                    }
+                    const PipelineNodeState dependency = nodes[edge.from].state;
+                    if (dependency == NodeFailed || dependency == NodeCancelled || dependency == NodeSkipped) {
+                        blocked = true;
+                    } else if (dependency != NodeSucceeded && !(edge.type == EdgePipe && dependency == NodeRunning)) {
+                        ready = false;
+                    }
+                }
+
+                if (blocked) {
+                    node.state = NodeSkipped;
+                    node.endTime = now();
+                    changed.push_back(node);
+                    progress = true;
+                } else if (ready) {
+                    node.state = NodeRunning;
+                    node.attempts++;
+                    node.sessionId = -1;
+                    node.startTime = now();
+                    node.endTime = -1;
+                    starting.push_back(node.id);
+                    progress = true;
+                }
+            }
+        }
+
+        // THE OTHER END OF A BROKEN PIPE WOULD WAIT FOREVER
+        for (const Edge& edge : edges) {
+            if (edge.type != EdgePipe) {
+                continue;
+            }
+            const PipelineNode& writer = nodes[edge.from];
+            const PipelineNode& reader = nodes[edge.to];
+            const bool writerBroken = (writer.state == NodeFailed || writer.state == NodeCancelled);
+            const bool readerBroken = (reader.state == NodeFailed || reader.state == NodeCancelled);
+            if (writerBroken && reader.state == NodeRunning && reader.sessionId >= 0) {
+                cancelling.push_back(reader.sessionId);
+            }
+            if (readerBroken && writer.state == NodeRunning && writer.sessionId >= 0) {
+                cancelling.push_back(writer.sessionId);
+            }
+        }
+
+        bool terminal = true;
+        for (const PipelineNode& node : nodes) {
+            if (node.state == NodePending || node.state == NodeRunning) {
+                terminal = false;
+            }
+            if (node.state != NodeSucceeded) {
+                succeeded = false;
+            }
+        }
+        if (terminal) {
+            finished = true;
+            completed = true;
+            endTime = now();
+            callback = completeCallback;
+            for (const Edge& edge : edges) {
+                if (edge.type == EdgePipe) {
+                    unlink(edge.path.c_str());
+                }
+            }
+        }
+
+        listener = nodeListener;
+        nodeExecutor = executor;
+    }
+
+    for (const PipelineNode& node : changed) {
+        if (listener != nullptr) {
+            listener(node);
+        }
+    }
+
+    for (const long sessionId : cancelling) {
+        canceller(sessionId);
+    }
+
+    // EXECUTORS RUN OUTSIDE THE LOCK, A NODE MAY EVEN FINISH BEFORE ITS EXECUTOR RETURNS
+    auto self = shared_from_this();
+    for (const int id : starting) {
+        PipelineNode node;
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            node = nodes[id];
+        }
+
+        const int attempt = node.attempts;
+        const long sessionId = nodeExecutor(node, [self, id, attempt](const PipelineNodeState state) {
+            self->finish(id, attempt, state);
+        });
+
+        bool cancelRequested = false;
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            if (nodes[id].attempts == attempt && nodes[id].state == NodeRunning) {
+                nodes[id].sessionId = sessionId;
+                cancelRequested = cancelled;
+            }
+            node = nodes[id];
+        }
+        if (cancelRequested) {
+            canceller(sessionId);
+        }
+        if (listener != nullptr && node.state == NodeRunning) {
+            listener(node);
+        }
+    }
+
+    // WAITERS RETURN ONLY AFTER THE COMPLETE CALLBACK HAS RUN
+    if (completed) {
+        if (callback != nullptr) {
+            callback(succeeded);
+        }
+        std::lock_guard<std::mutex> lock(mutex);
+        delivered = true;
+        finishedCondition.notify_all();
+    }
+}
+
+void ffmpegkittest::Pipeline::finish(const int id, const int attempt, const PipelineNodeState state) {
+    PipelineNode node;
+    NodeListener listener;
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        if (nodes[id].attempts != attempt || nodes[id].state != NodeRunning) {
+            return;
+        }
+
+        // NODES READING OR WRITING A PIPE CANNOT BE RESTARTED ALONE
+        if (state == NodeFailed && !cancelled && nodes[id].attempts <= nodes[id].retries && !hasPipeEdge(id)) {
+            std::cout << "Pipeline node " << nodes[id].name << " failed, retrying." << std::endl;
+            nodes[id].state = NodePending;
+        } else {
+            nodes[id].state = state;
+            nodes[id].endTime = now();
+        }
+        node = nodes[id];
+        listener = nodeListener;
+    }
+
+    if (listener != nullptr && node.state != NodePending) {
+        listener(node);
+    }
+    advance();
+}
+
+bool ffmpegkittest::Pipeline::hasPipeEdge(const int id) {
+    for (const Edge& edge : edges) {
+        if (edge.type == EdgePipe && (edge.from == id || edge.to == id)) {
+            return true;
+        }
+    }
+    return false;
+}
+
+long ffmpegkittest::Pipeline::now() {
+    return (long)std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::steady_clock::now() - startTime).count();
+}
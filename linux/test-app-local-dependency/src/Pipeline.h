@@ -0,0 +1,128 @@
+/*
+ * Copyright (c) 2022 Taner Sener
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#ifndef FFMPEG_KIT_TEST_PIPELINE_H
+#define FFMPEG_KIT_TEST_PIPELINE_H
+
+#include <chrono>
+#include <condition_variable>
+#include <functional>
+#include <list>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+
+namespace ffmpegkittest {
+
+    enum PipelineNodeState {
+        NodePending,
+        NodeRunning,
+        NodeSucceeded,
+        NodeFailed,
+        NodeCancelled,
+        NodeSkipped
+    };
+
+    enum PipelineEdgeType {
+        EdgeFile,
+        EdgePipe
+    };
+
+    struct PipelineNode {
+        int id;
+        std::string name;
+        std::string command;
+        std::list<std::string> arguments;
+        int retries;
+        int attempts;
+        PipelineNodeState state;
+        long sessionId;
+        long startTime;
+        long endTime;
+    };
+
+    /**
+     * Runs FFmpeg commands as nodes of a dependency graph. A node connected by a file edge
+     * starts after the node writing the file succeeded, a node connected by a pipe edge
+     * starts together with the writer and reads from a named pipe. Nodes without a path
+     * between them run at the same time.
+     */
+    class Pipeline: public std::enable_shared_from_this<Pipeline> {
+        public:
+            typedef std::function<void(const PipelineNodeState state)> NodeFinished;
+            typedef std::function<long(const PipelineNode& node, const NodeFinished& finished)> Executor;
+            typedef std::function<void(const long sessionId)> Canceller;
+            typedef std::function<void(const PipelineNode& node)> NodeListener;
+            typedef std::function<void(const bool succeeded)> CompleteCallback;
+
+            static std::shared_ptr<Pipeline> create(const int logConsumerId = 0, const int statisticsConsumerId = 0);
+            static std::shared_ptr<Pipeline> create(const Executor& executor, const Canceller& canceller);
+            static const char* nodeStateToString(const PipelineNodeState state);
+
+            int addNode(const std::string& name, const std::string& command, const int retries = 0);
+            int addNode(const std::string& name, const std::list<std::string>& arguments, const int retries = 0);
+            void addFileEdge(const int from, const int to, const std::string& path = "");
+            void addPipeEdge(const int from, const int to, const std::string& path);
+            void setNodeListener(const NodeListener& nodeListener);
+            bool start(const CompleteCallback& completeCallback);
+            void cancel();
+            void waitUntilFinished();
+            bool isFinished();
+            bool isSucceeded();
+            std::vector<PipelineNode> getNodes();
+            long getElapsedTime();
+            std::string describeTimings();
+
+        private:
+            struct Edge {
+                int from;
+                int to;
+                PipelineEdgeType type;
+                std::string path;
+            };
+
+            Pipeline(const Executor& executor, const Canceller& canceller);
+            void advance();
+            void finish(const int id, const int attempt, const PipelineNodeState state);
+            bool hasPipeEdge(const int id);
+            long now();
+
+            std::mutex mutex;
+            std::condition_variable finishedCondition;
+            std::vector<PipelineNode> nodes;
+            std::vector<Edge> edges;
+            Executor executor;
+            Canceller canceller;
+            NodeListener nodeListener;
+            CompleteCallback completeCallback;
+            std::chrono::steady_clock::time_point startTime;
+            long endTime;
+            bool started;
+            bool cancelled;
+            bool finished;
+            bool delivered;
+    };
+
+}
+
+#endif // FFMPEG_KIT_TEST_PIPELINE_H
@@ -0,0 +1,250 @@
+/*
+ * Copyright (c) 2022 Taner Sener
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#include "PipelineTest.h"
+#include "Application.h"
+#include "Pipeline.h"
+#include <algorithm>
+#include <atomic>
+#include <iostream>
+#include <set>
+#include <sys/stat.h>
+#include <thread>
+#include <unistd.h>
+
+using namespace ffmpegkittest;
+
+/**
+ * Runs "sleep <ms>", "fail" and "flaky" commands on threads instead of FFmpeg sessions.
+ */
+class FakeSessions {
+    public:
+        FakeSessions() : nextSessionId(1), flakyAttempts(0) {
+        }
+
+        ~FakeSessions() {
+            for (auto& thread : threads) {
+                thread.join();
+            }
+        }
+
+        std::shared_ptr<Pipeline> createPipeline() {
+            return Pipeline::create([this](const PipelineNode& node, const Pipeline::NodeFinished& finished) {
+                const long sessionId = nextSessionId++;
+                std::lock_guard<std::mutex> lock(mutex);
+                threads.push_back(std::thread([this, sessionId, node, finished]() {
+                    run(sessionId, node.command, finished);
+                }));
+                return sessionId;
+            }, [this](const long sessionId) {
+                std::lock_guard<std::mutex> lock(mutex);
+                cancelledIds.insert(sessionId);
+                cancelCondition.notify_all();
+            });
+        }
+
+    private:
+        void run(const long sessionId, const std::string& command, const Pipeline::NodeFinished& finished) {
+            if (command == "fail" || (command == "flaky" && flakyAttempts++ == 0)) {
+                finished(NodeFailed);
+                return;
+            }
+
+            const int duration = (command.compare(0, 6, "sleep ") == 0) ? std::stoi(command.substr(6)) : 0;
+            std::unique_lock<std::mutex> lock(mutex);
+            const bool cancelled = cancelCondition.wait_for(lock, std::chrono::milliseconds(duration), [this, sessionId]() {
+                return cancelledIds.count(sessionId) > 0;
+            });
+            lock.unlock();
+            finished(cancelled ? NodeCancelled : NodeSucceeded);
+        }
+
+        std::mutex mutex;
+        std::condition_variable cancelCondition;
+        std::set<long> cancelledIds;
+        std::vector<std::thread> threads;
+        std::atomic<long> nextSessionId;
+        std::atomic<int> flakyAttempts;
+};
+
+void testIndependentBranchesOverlap() {
+    FakeSessions sessions;
+    auto pipeline = sessions.createPipeline();
+
+    const int source = pipeline->addNode("source", "sleep 10");
+    const int left = pipeline->addNode("left", "sleep 60");
+    const int right = pipeline->addNode("right", "sleep 60");
+    const int join = pipeline->addNode("join", "sleep 10");
+    pipeline->addFileEdge(source, left);
+    pipeline->addFileEdge(source, right);
+    pipeline->addFileEdge(left, join);
+    pipeline->addFileEdge(right, join);
+
+    bool succeeded = false;
+    assert(pipeline->start([&succeeded](const bool pipelineSucceeded) {
+        succeeded = pipelineSucceeded;
+    }));
+    pipeline->waitUntilFinished();
+    assert(succeeded && pipeline->isSucceeded());
+
+    const auto nodes = pipeline->getNodes();
+    assert(nodes[left].startTime >= nodes[source].endTime);
+    assert(nodes[left].startTime < nodes[right].endTime && nodes[right].startTime < nodes[left].endTime);
+    assert(nodes[join].startTime >= nodes[left].endTime && nodes[join].startTime >= nodes[right].endTime);
+    assert(pipeline->getElapsedTime() < 130);
+}
+
+void testFailureSkipsDependentsAndRetries() {
+    FakeSessions sessions;
+    auto pipeline = sessions.createPipeline();
+
+    const int flaky = pipeline->addNode("flaky", "flaky", 1);
+    const int broken = pipeline->addNode("broken", "fail");
+    const int afterFlaky = pipeline->addNode("after flaky", "sleep 0");
+    const int afterBroken = pipeline->addNode("after broken", "sleep 0");
+    pipeline->addFileEdge(flaky, afterFlaky);
+    pipeline->addFileEdge(broken, afterBroken);
+
+    std::vector<std::string> events;
+    std::mutex eventsMutex;
+    pipeline->setNodeListener([&](const PipelineNode& node) {
+        std::lock_guard<std::mutex> lock(eventsMutex);
+        events.push_back(node.name + " " + Pipeline::nodeStateToString(node.state));
+    });
+
+    assert(pipeline->start(nullptr));
+    pipeline->waitUntilFinished();
+    assert(!pipeline->isSucceeded());
+
+    const auto nodes = pipeline->getNodes();
+    assert(nodes[flaky].state == NodeSucceeded && nodes[flaky].attempts == 2);
+    assert(nodes[afterFlaky].state == NodeSucceeded);
+    assert(nodes[broken].state == NodeFailed && nodes[broken].attempts == 1);
+    assert(nodes[afterBroken].state == NodeSkipped && nodes[afterBroken].attempts == 0);
+
+    std::lock_guard<std::mutex> lock(eventsMutex);
+    assert(std::count(events.begin(), events.end(), "after broken skipped") == 1);
+    assert(std::count(events.begin(), events.end(), "flaky running") == 2);
+}
+
+void testCancelReachesWholeGraph() {
+    FakeSessions sessions;
+    auto pipeline = sessions.createPipeline();
+
+    const int first = pipeline->addNode("first", "sleep 5000");
+    const int parallel = pipeline->addNode("parallel", "sleep 5000");
+    const int second = pipeline->addNode("second", "sleep 0");
+    pipeline->addFileEdge(first, second);
+
+    bool completed = false;
+    assert(pipeline->start([&completed](const bool succeeded) {
+        completed = !succeeded;
+    }));
+    pipeline->cancel();
+    pipeline->waitUntilFinished();
+    assert(completed);
+
+    const auto nodes = pipeline->getNodes();
+    assert(nodes[first].state == NodeCancelled);
+    assert(nodes[parallel].state == NodeCancelled);
+    assert(nodes[second].state == NodeCancelled && nodes[second].attempts == 0);
+    assert(pipeline->getElapsedTime() < 1000);
+}
+
+void testPipeReaderStartsWithWriter() {
+    FakeSessions sessions;
+    auto pipeline = sessions.createPipeline();
+    std::string pipeDirectory = Application::getApplicationCacheDirectory() + "/pipeline-test-XXXXXX";
+    const bool created = (mkdtemp(&pipeDirectory[0]) != nullptr);
+    assert(created);
+    const std::string pipePath = pipeDirectory + "/pipeline.pipe";
+
+    const int writer = pipeline->addNode("writer", "sleep 50");
+    const int reader = pipeline->addNode("reader", "sleep 50");
+    pipeline->addPipeEdge(writer, reader, pipePath);
+
+    bool pipeCreated = false;
+    pipeline->setNodeListener([&](const PipelineNode& node) {
+        struct stat pipeStat;
+        if (node.id == reader && node.state == NodeRunning) {
+            pipeCreated = (stat(pipePath.c_str(), &pipeStat) == 0 && S_ISFIFO(pipeStat.st_mode));
+        }
+    });
+
+    assert(pipeline->start(nullptr));
+    pipeline->waitUntilFinished();
+    assert(pipeline->isSucceeded() && pipeCreated);
+
+    const auto nodes = pipeline->getNodes();
+    assert(nodes[reader].startTime < nodes[writer].endTime);
+
+    struct stat pipeStat;
+    assert(stat(pipePath.c_str(), &pipeStat) != 0);
+    rmdir(pipeDirectory.c_str());
+
+    // A CYCLE IS REJECTED BEFORE ANYTHING RUNS
+    auto cyclic = sessions.createPipeline();
+    const int a = cyclic->addNode("a", "sleep 0");
+    const int b = cyclic->addNode("b", "sleep 0");
+    cyclic->addFileEdge(a, b);
+    cyclic->addFileEdge(b, a);
+    assert(!cyclic->start(nullptr));
+}
+
+void benchmarkPipeline(void) {
+    FakeSessions sessions;
+    const int stageCount = 4;
+    const std::string stage = "sleep 25";
+
+    // THE SAME FOUR STAGES CHAINED ONE AFTER ANOTHER AND AS TWO INDEPENDENT BRANCHES
+    auto chain = sessions.createPipeline();
+    for (int i = 0; i < stageCount; i++) {
+        const int node = chain->addNode("stage " + std::to_string(i), stage);
+        if (i > 0) {
+            chain->addFileEdge(node - 1, node);
+        }
+    }
+    chain->start(nullptr);
+    chain->waitUntilFinished();
+
+    auto branches = sessions.createPipeline();
+    for (int i = 0; i < stageCount; i++) {
+        const int node = branches->addNode("stage " + std::to_string(i), stage);
+        if (i % 2 == 1) {
+            branches->addFileEdge(node - 1, node);
+        }
+    }
+    branches->start(nullptr);
+    branches->waitUntilFinished();
+
+    std::cout << "Pipeline of " << stageCount << " 25 ms stages took " << chain->getElapsedTime() << " ms chained and " << branches->getElapsedTime() << " ms as two branches." << std::endl;
+    std::cout << branches->describeTimings();
+}
+
+void testPipeline(void) {
+    testIndependentBranchesOverlap();
+    testFailureSkipsDependentsAndRetries();
+    testCancelReachesWholeGraph();
+    testPipeReaderStartsWithWriter();
+
+    std::cout << "PipelineTest passed." << std::endl;
+}
@@ -0,0 +1,218 @@
+/*
+ * Copyright (c) 2022 Taner Sener
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#include "ProgressEstimator.h"
+#include <FFmpegKitConfig.h>
+#include <FFprobeKit.h>
+#include <algorithm>
+#include <cstdlib>
+#include <iomanip>
+#include <iostream>
+#include <sstream>
+
+using namespace ffmpegkit;
+
+ffmpegkittest::ProgressEstimator& ffmpegkittest::ProgressEstimator::getInstance() {
+    static ProgressEstimator instance;
+    return instance;
+}
+
+double ffmpegkittest::ProgressEstimator::parseDuration(const std::string& duration) {
+    const char* position = duration.c_str();
+    bool negative = false;
+    double seconds = 0;
+    int fields = 0;
+
+    if (*position == '-') {
+        negative = true;
+        position++;
+    }
+
+    // ACCEPTS BOTH [[HH:]MM:]SS[.m...] AND PLAIN SECONDS
+    while (*position != '\0') {
+        char* end;
+        const double value = std::strtod(position, &end);
+        if (end == position || ++fields > 3) {
+            return -1;
+        }
+        seconds = seconds * 60 + value;
+        position = end;
+
+        if (*position == ':') {
+            position++;
+        } else if (*position == 's' && *(position + 1) == '\0') {
+            position++;
+        } else if (*position != '\0') {
+            return -1;
+        }
+    }
+
+    if (fields == 0 || negative) {
+        return -1;
+    }
+
+    return seconds * 1000;
+}
+
+std::string ffmpegkittest::ProgressEstimator::format(const ProgressEstimate& estimate) {
+    std::ostringstream stream;
+    stream << std::fixed << std::setprecision(1);
+
+    if (estimate.percentage >= 0) {
+        stream << estimate.percentage << "%";
+    } else {
+        stream << "unknown duration";
+    }
+    stream << ", " << estimate.smoothedFps << " fps, " << std::setprecision(2) << estimate.smoothedSpeed << "x";
+    if (estimate.remainingTime >= 0) {
+        stream << ", " << (estimate.remainingTime + 999) / 1000 << " s remaining";
+    }
+
+    return stream.str();
+}
+
+void ffmpegkittest::ProgressEstimator::expectDuration(const long sessionId, const double durationInMilliseconds) {
+    std::lock_guard<std::mutex> lock(mutex);
+    getTracker(sessionId).estimate.expectedDuration = durationInMilliseconds;
+}
+
+void ffmpegkittest::ProgressEstimator::expectDurationOf(const long sessionId, const std::string& command) {
+    auto arguments = FFmpegKitConfig::parseArguments(command.c_str());
+    std::string firstInput;
+
+    // AN OUTPUT DURATION LIMIT WINS, OTHERWISE THE OUTPUT IS ASSUMED TO BE AS LONG AS THE FIRST INPUT
+    for (auto argument = arguments.begin(); argument != arguments.end(); ++argument) {
+        auto value = std::next(argument);
+        if (value == arguments.end()) {
+            break;
+        }
+        if (*argument == "-t") {
+            const double duration = parseDuration(*value);
+            if (duration > 0) {
+                expectDuration(sessionId, duration);
+                return;
+            }
+        } else if (*argument == "-i" && firstInput.empty()) {
+            firstInput = *value;
+        }
+    }
+
+    if (!firstInput.empty()) {
+        probeDuration(sessionId, firstInput);
+    }
+}
+
+void ffmpegkittest::ProgressEstimator::probeDuration(const long sessionId, const std::string& inputPath) {
+    FFprobeKit::getMediaInformationAsync(inputPath, [this, sessionId](auto session) {
+        auto information = session->getMediaInformation();
+        if (information == nullptr || information->getDuration() == nullptr) {
+            std::cout << "Duration of session " << sessionId << " input could not be probed." << std::endl;
+            return;
+        }
+
+        const double duration = parseDuration(*information->getDuration());
+        if (duration > 0) {
+            expectDuration(sessionId, duration);
+        }
+    });
+}
+
+ffmpegkittest::ProgressEstimate ffmpegkittest::ProgressEstimator::update(const StatisticsSnapshot& statistics) {
+    return update(statistics, std::chrono::steady_clock::now());
+}
+
+ffmpegkittest::ProgressEstimate ffmpegkittest::ProgressEstimator::update(const StatisticsSnapshot& statistics, const std::chrono::steady_clock::time_point now) {
+    std::lock_guard<std::mutex> lock(mutex);
+
+    Tracker& tracker = getTracker(statistics.sessionId);
+    ProgressEstimate& estimate = tracker.estimate;
+
+    if (statistics.videoFps > 0) {
+        estimate.smoothedFps = (estimate.smoothedFps <= 0) ? statistics.videoFps : estimate.smoothedFps + SmoothingFactor * (statistics.videoFps - estimate.smoothedFps);
+    }
+
+    // SPEED IS DERIVED FROM WALL CLOCK TIME WHEN FFMPEG DOES NOT REPORT IT
+    double speed = statistics.speed;
+    if (speed <= 0 && tracker.lastTime >= 0 && statistics.time > tracker.lastTime) {
+        const double elapsed = std::chrono::duration<double, std::milli>(now - tracker.lastUpdate).count();
+        if (elapsed > 0) {
+            speed = (statistics.time - tracker.lastTime) / elapsed;
+        }
+    }
+    if (speed > 0) {
+        estimate.smoothedSpeed = (estimate.smoothedSpeed <= 0) ? speed : estimate.smoothedSpeed + SmoothingFactor * (speed - estimate.smoothedSpeed);
+    }
+
+    if (estimate.expectedDuration > 0 && statistics.time >= 0) {
+        estimate.percentage = std::min(100.0, statistics.time * 100 / estimate.expectedDuration);
+        if (estimate.smoothedSpeed > 0) {
+            estimate.remainingTime = (long)(std::max(0.0, estimate.expectedDuration - statistics.time) / estimate.smoothedSpeed);
+        }
+    }
+
+    tracker.lastTime = statistics.time;
+    tracker.lastUpdate = now;
+    tracker.estimateTime = now;
+
+    return estimate;
+}
+
+bool ffmpegkittest::ProgressEstimator::getEstimate(const long sessionId, ProgressEstimate& estimate) {
+    std::lock_guard<std::mutex> lock(mutex);
+
+    auto tracker = trackers.find(sessionId);
+    if (tracker == trackers.end()) {
+        return false;
+    }
+
+    estimate = tracker->second.estimate;
+    return true;
+}
+
+std::chrono::steady_clock::time_point ffmpegkittest::ProgressEstimator::getEstimatedCompletionTime(const long sessionId) {
+    std::lock_guard<std::mutex> lock(mutex);
+
+    auto tracker = trackers.find(sessionId);
+    if (tracker == trackers.end() || tracker->second.estimate.remainingTime < 0) {
+        return std::chrono::steady_clock::time_point::max();
+    }
+
+    return tracker->second.estimateTime + std::chrono::milliseconds(tracker->second.estimate.remainingTime);
+}
+
+ffmpegkittest::ProgressEstimator::Tracker& ffmpegkittest::ProgressEstimator::getTracker(const long sessionId) {
+    auto existing = trackers.find(sessionId);
+    if (existing != trackers.end()) {
+        return existing->second;
+    }
+
+    // SESSION IDS ONLY GROW, SO THE OLDEST SESSION IS FORGOTTEN FIRST
+    if ((int)trackers.size() >= MaxTrackedSessions) {
+        trackers.erase(trackers.begin());
+    }
+
+    Tracker& tracker = trackers[sessionId];
+    tracker.estimate = ProgressEstimate{sessionId, -1, -1, 0, 0, -1};
+    tracker.lastTime = -1;
+    tracker.estimateTime = std::chrono::steady_clock::now();
+    return tracker;
+}
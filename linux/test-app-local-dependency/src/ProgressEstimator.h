@@ -0,0 +1,81 @@
+/*
+ * Copyright (c) 2022 Taner Sener
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#ifndef FFMPEG_KIT_TEST_PROGRESS_ESTIMATOR_H
+#define FFMPEG_KIT_TEST_PROGRESS_ESTIMATOR_H
+
+#include "StatisticsAggregator.h"
+#include <chrono>
+#include <map>
+#include <mutex>
+#include <string>
+
+namespace ffmpegkittest {
+
+    struct ProgressEstimate {
+        long sessionId;
+        double expectedDuration;
+        double percentage;
+        double smoothedFps;
+        double smoothedSpeed;
+        long remainingTime;
+    };
+
+    /**
+     * Turns statistics snapshots into percent complete, smoothed fps and speed and an ETA
+     * using the expected output duration of each session. Durations are given by the caller,
+     * parsed from the command or probed from the first input.
+     */
+    class ProgressEstimator {
+        public:
+            static constexpr const double SmoothingFactor = 0.2;
+            static constexpr const int MaxTrackedSessions = 64;
+
+            static ProgressEstimator& getInstance();
+            static double parseDuration(const std::string& duration);
+            static std::string format(const ProgressEstimate& estimate);
+
+            void expectDuration(const long sessionId, const double durationInMilliseconds);
+            void expectDurationOf(const long sessionId, const std::string& command);
+            void probeDuration(const long sessionId, const std::string& inputPath);
+            ProgressEstimate update(const StatisticsSnapshot& statistics);
+            ProgressEstimate update(const StatisticsSnapshot& statistics, const std::chrono::steady_clock::time_point now);
+            bool getEstimate(const long sessionId, ProgressEstimate& estimate);
+            std::chrono::steady_clock::time_point getEstimatedCompletionTime(const long sessionId);
+
+        private:
+            struct Tracker {
+                ProgressEstimate estimate;
+                double lastTime;
+                std::chrono::steady_clock::time_point lastUpdate;
+                std::chrono::steady_clock::time_point estimateTime;
+            };
+
+            Tracker& getTracker(const long sessionId);
+
+            std::mutex mutex;
+            std::map<long, Tracker> trackers;
+    };
+
+}
+
+#endif // FFMPEG_KIT_TEST_PROGRESS_ESTIMATOR_H
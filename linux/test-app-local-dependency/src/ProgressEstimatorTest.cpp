@@ -0,0 +1,81 @@
+/*
+ * Copyright (c) 2022 Taner Sener
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#include "ProgressEstimatorTest.h"
+#include "ProgressEstimator.h"
+#include <iostream>
+
+using namespace ffmpegkittest;
+
+void testParseDuration() {
+    assert(ProgressEstimator::parseDuration("9") == 9000);
+    assert(ProgressEstimator::parseDuration("9.5s") == 9500);
+    assert(ProgressEstimator::parseDuration("00:01:02.5") == 62500);
+    assert(ProgressEstimator::parseDuration("01:30") == 90000);
+    assert(ProgressEstimator::parseDuration("12.034000") == 12034);
+    assert(ProgressEstimator::parseDuration("N/A") < 0);
+    assert(ProgressEstimator::parseDuration("") < 0);
+    assert(ProgressEstimator::parseDuration("-5") < 0);
+    assert(ProgressEstimator::parseDuration("1:2:3:4") < 0);
+}
+
+void testEstimateFollowsSpeed() {
+    ProgressEstimator progressEstimator;
+    const auto start = std::chrono::steady_clock::now();
+    StatisticsSnapshot statistics{};
+    statistics.sessionId = 3;
+
+    progressEstimator.expectDuration(3, 9000);
+
+    // TWO SECONDS OF OUTPUT PER SECOND, SPEED NOT REPORTED
+    for (int second = 0; second <= 3; second++) {
+        statistics.time = second * 2000;
+        statistics.videoFps = 60;
+        progressEstimator.update(statistics, start + std::chrono::seconds(second));
+    }
+
+    ProgressEstimate estimate;
+    const bool found = progressEstimator.getEstimate(3, estimate);
+    assert(found);
+    assert(estimate.percentage > 66.6 && estimate.percentage < 66.7);
+    assert(estimate.smoothedFps == 60);
+    assert(estimate.smoothedSpeed == 2.0);
+    assert(estimate.remainingTime == 1500);
+
+    // REPORTED SPEED IS SMOOTHED
+    statistics.time = 7000;
+    statistics.speed = 1.0;
+    estimate = progressEstimator.update(statistics, start + std::chrono::seconds(4));
+    assert(estimate.smoothedSpeed > 1.79 && estimate.smoothedSpeed < 1.81);
+
+    StatisticsSnapshot unknown{};
+    unknown.sessionId = 4;
+    unknown.time = 1000;
+    assert(progressEstimator.update(unknown).percentage < 0);
+}
+
+void testProgressEstimator(void) {
+    testParseDuration();
+    testEstimateFollowsSpeed();
+
+    std::cout << "ProgressEstimatorTest passed." << std::endl;
+}
@@ -0,0 +1,199 @@
+/*
+ * Copyright (c) 2022 Taner Sener
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#include "SessionHistory.h"
+#include <FFmpegKit.h>
+#include <FFmpegKitConfig.h>
+#include <Log.h>
+#include <Statistics.h>
+#include <algorithm>
+#include <sstream>
+
+using namespace ffmpegkit;
+
+ffmpegkittest::SessionHistory& ffmpegkittest::SessionHistory::getInstance() {
+    static SessionHistory instance(DefaultMaxSessions, DefaultMaxRetainedBytes);
+    return instance;
+}
+
+ffmpegkittest::SessionMemory ffmpegkittest::SessionHistory::measure(const std::shared_ptr<FFmpegSession>& session) {
+    SessionMemory memory{0, 0, 0, sizeof(FFmpegSession)};
+
+    auto logs = session->getLogs();
+    std::for_each(logs->begin(), logs->end(), [&](const std::shared_ptr<Log> log) {
+        memory.logCount++;
+        memory.logBytes += log->getMessage().size();
+    });
+    memory.statisticsCount = (long)session->getStatistics()->size();
+
+    // EVERY LOG LINE AND STATISTICS ENTRY ALSO COSTS A LIST NODE AND A SHARED POINTER CONTROL BLOCK
+    memory.retainedBytes += memory.logBytes + memory.logCount * (sizeof(Log) + EntryOverhead) + memory.statisticsCount * (sizeof(Statistics) + EntryOverhead);
+
+    return memory;
+}
+
+std::string ffmpegkittest::SessionHistory::formatMemory(const SessionMemory& memory) {
+    std::ostringstream stream;
+    stream << memory.logCount << " logs/" << memory.logBytes << " bytes, " << memory.statisticsCount << " statistics, " << memory.retainedBytes << " bytes retained";
+    return stream.str();
+}
+
+ffmpegkittest::SessionHistory::SessionHistory(const int maxSessions, const size_t maxRetainedBytes) : retainedBytes(0), evictedCount(0), maxSessions(maxSessions), maxRetainedBytes(maxRetainedBytes), enabled(false), internalHistorySize(0) {
+}
+
+void ffmpegkittest::SessionHistory::enable() {
+    std::lock_guard<std::mutex> lock(mutex);
+    enabled = true;
+    resizeInternalHistory();
+}
+
+void ffmpegkittest::SessionHistory::setLimits(const int maxSessions, const size_t maxRetainedBytes) {
+    std::lock_guard<std::mutex> lock(mutex);
+    this->maxSessions = maxSessions;
+    this->maxRetainedBytes = maxRetainedBytes;
+    evict();
+}
+
+void ffmpegkittest::SessionHistory::add(const std::shared_ptr<FFmpegSession>& session) {
+    std::lock_guard<std::mutex> lock(mutex);
+    running[session->getSessionId()] = RunningEntry{session, Unpinned};
+    resizeInternalHistory();
+}
+
+void ffmpegkittest::SessionHistory::setPlacement(const long sessionId, const std::string& placement) {
+    std::lock_guard<std::mutex> lock(mutex);
+    auto runningSession = running.find(sessionId);
+    if (runningSession != running.end()) {
+        runningSession->second.placement = placement;
+    }
+}
+
+void ffmpegkittest::SessionHistory::complete(const long sessionId) {
+    std::shared_ptr<FFmpegSession> session;
+    std::string placement;
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        auto runningSession = running.find(sessionId);
+        if (runningSession == running.end()) {
+            return;
+        }
+        session = runningSession->second.session;
+        placement = runningSession->second.placement;
+        running.erase(runningSession);
+        resizeInternalHistory();
+    }
+
+    // LOGS ARE MEASURED OUTSIDE THE LOCK, THEY ARE COPIED OUT OF THE SESSION
+    const SessionMemory memory = measure(session);
+
+    std::lock_guard<std::mutex> lock(mutex);
+    recentlyUsed.push_front(sessionId);
+    completed[sessionId] = Entry{session, memory, placement, recentlyUsed.begin()};
+    retainedBytes += memory.retainedBytes;
+    evict();
+}
+
+std::shared_ptr<FFmpegSession> ffmpegkittest::SessionHistory::getSession(const long sessionId) {
+    std::lock_guard<std::mutex> lock(mutex);
+
+    auto runningSession = running.find(sessionId);
+    if (runningSession != running.end()) {
+        return runningSession->second.session;
+    }
+
+    auto entry = completed.find(sessionId);
+    if (entry == completed.end()) {
+        return nullptr;
+    }
+
+    recentlyUsed.splice(recentlyUsed.begin(), recentlyUsed, entry->second.position);
+    return entry->second.session;
+}
+
+std::vector<ffmpegkittest::SessionRecord> ffmpegkittest::SessionHistory::listSessions() {
+    std::vector<SessionRecord> records;
+    std::vector<RunningEntry> runningSessions;
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        for (auto entry = completed.begin(); entry != completed.end(); ++entry) {
+            records.push_back(SessionRecord{entry->second.session, entry->second.memory, entry->second.placement, true});
+        }
+        for (auto session = running.begin(); session != running.end(); ++session) {
+            runningSessions.push_back(session->second);
+        }
+    }
+
+    // RUNNING SESSIONS ARE STILL GROWING, SO THEY ARE MEASURED WHEN LISTED
+    std::for_each(runningSessions.begin(), runningSessions.end(), [&](const RunningEntry& entry) {
+        records.push_back(SessionRecord{entry.session, measure(entry.session), entry.placement, false});
+    });
+
+    // SESSIONS EXECUTED DIRECTLY THROUGH FFMPEGKIT ARE ONLY KEPT IN ITS OWN HISTORY
+    auto internalSessions = FFmpegKit::listSessions();
+    std::for_each(internalSessions->begin(), internalSessions->end(), [&](const std::shared_ptr<FFmpegSession> session) {
+        const long sessionId = session->getSessionId();
+        if (std::none_of(records.begin(), records.end(), [sessionId](const SessionRecord& record) { return record.session->getSessionId() == sessionId; })) {
+            records.push_back(SessionRecord{session, measure(session), Unpinned, session->getState() == SessionStateCompleted || session->getState() == SessionStateFailed});
+        }
+    });
+
+    return records;
+}
+
+int ffmpegkittest::SessionHistory::getRetainedCount() {
+    std::lock_guard<std::mutex> lock(mutex);
+    return (int)completed.size();
+}
+
+size_t ffmpegkittest::SessionHistory::getRetainedBytes() {
+    std::lock_guard<std::mutex> lock(mutex);
+    return retainedBytes;
+}
+
+long ffmpegkittest::SessionHistory::getEvictedCount() {
+    std::lock_guard<std::mutex> lock(mutex);
+    return evictedCount;
+}
+
+void ffmpegkittest::SessionHistory::evict() {
+    while (!recentlyUsed.empty() && ((int)completed.size() > maxSessions || retainedBytes > maxRetainedBytes)) {
+        auto entry = completed.find(recentlyUsed.back());
+        retainedBytes -= entry->second.memory.retainedBytes;
+        completed.erase(entry);
+        recentlyUsed.pop_back();
+        evictedCount++;
+    }
+}
+
+void ffmpegkittest::SessionHistory::resizeInternalHistory() {
+    if (!enabled) {
+        return;
+    }
+
+    // FFMPEGKIT EVICTS ITS OLDEST SESSION WHEN A NEW ONE IS CREATED, RUNNING OR NOT. AN EVICTED SESSION NO LONGER GETS ITS
+    // LOGS AND STATISTICS, SO EVERY RUNNING SESSION MUST STAY IN THE NEWEST ONES
+    const int size = std::max((int)InternalHistorySize, (int)running.size() + InternalHistoryMargin);
+    if (size != internalHistorySize) {
+        FFmpegKitConfig::setSessionHistorySize(size);
+        internalHistorySize = size;
+    }
+}
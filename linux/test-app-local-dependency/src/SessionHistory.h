@@ -0,0 +1,115 @@
+/*
+ * Copyright (c) 2022 Taner Sener
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#ifndef FFMPEG_KIT_TEST_SESSION_HISTORY_H
+#define FFMPEG_KIT_TEST_SESSION_HISTORY_H
+
+#include <FFmpegSession.h>
+#include <list>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+
+namespace ffmpegkittest {
+
+    struct SessionMemory {
+        long logCount;
+        size_t logBytes;
+        long statisticsCount;
+        size_t retainedBytes;
+    };
+
+    struct SessionRecord {
+        std::shared_ptr<ffmpegkit::FFmpegSession> session;
+        SessionMemory memory;
+        std::string placement;
+        bool completed;
+    };
+
+    /**
+     * Retention policy for FFmpeg sessions. Completed sessions are kept in least recently used
+     * order and evicted once there are more than the maximum number of them or their logs and
+     * statistics use more than the retained byte budget. FFmpegKit itself only keeps the
+     * newest sessions and stops attaching logs and statistics to a session it dropped, so once
+     * enabled its history is resized to the running sessions plus a margin for sessions that
+     * are created outside this history, e.g. probes. Old sessions are released as soon as they
+     * leave this history. The placement of a session is recorded when
+     * it is placed, so it is still listed after the session released its cores.
+     */
+    class SessionHistory {
+        public:
+            static constexpr const int DefaultMaxSessions = 100;
+            static constexpr const size_t DefaultMaxRetainedBytes = 16 * 1024 * 1024;
+            static constexpr const int InternalHistorySize = 64;
+            static constexpr const int InternalHistoryMargin = 32;
+            static constexpr const size_t EntryOverhead = 64;
+            static constexpr const char* Unpinned = "unpinned";
+
+            static SessionHistory& getInstance();
+            static SessionMemory measure(const std::shared_ptr<ffmpegkit::FFmpegSession>& session);
+            static std::string formatMemory(const SessionMemory& memory);
+
+            SessionHistory(const int maxSessions, const size_t maxRetainedBytes);
+            void enable();
+            void setLimits(const int maxSessions, const size_t maxRetainedBytes);
+            void add(const std::shared_ptr<ffmpegkit::FFmpegSession>& session);
+            void setPlacement(const long sessionId, const std::string& placement);
+            void complete(const long sessionId);
+            std::shared_ptr<ffmpegkit::FFmpegSession> getSession(const long sessionId);
+            std::vector<SessionRecord> listSessions();
+            int getRetainedCount();
+            size_t getRetainedBytes();
+            long getEvictedCount();
+
+        private:
+            struct RunningEntry {
+                std::shared_ptr<ffmpegkit::FFmpegSession> session;
+                std::string placement;
+            };
+
+            struct Entry {
+                std::shared_ptr<ffmpegkit::FFmpegSession> session;
+                SessionMemory memory;
+                std::string placement;
+                std::list<long>::iterator position;
+            };
+
+            void evict();
+            void resizeInternalHistory();
+
+            std::mutex mutex;
+            std::map<long, RunningEntry> running;
+            std::map<long, Entry> completed;
+            std::list<long> recentlyUsed;
+            size_t retainedBytes;
+            long evictedCount;
+            int maxSessions;
+            size_t maxRetainedBytes;
+            bool enabled;
+            int internalHistorySize;
+    };
+
+}
+
+#endif // FFMPEG_KIT_TEST_SESSION_HISTORY_H
@@ -0,0 +1,217 @@
+/*
+ * Copyright (c) 2022 Taner Sener
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#include "SessionHistoryTest.h"
+#include "SessionHistory.h"
+#include "SessionRouter.h"
+#include <FFmpegKit.h>
+#include <FFmpegKitConfig.h>
+#include <Log.h>
+#include <algorithm>
+#include <condition_variable>
+#include <fstream>
+#include <iostream>
+#include <mutex>
+#include <unistd.h>
+
+using namespace ffmpegkit;
+using namespace ffmpegkittest;
+
+static long readResidentBytes() {
+    std::ifstream statm("/proc/self/statm");
+    long size = 0;
+    long resident = 0;
+    statm >> size >> resident;
+    return resident * sysconf(_SC_PAGESIZE);
+}
+
+static std::shared_ptr<FFmpegSession> runTinySession(SessionHistory& history, const int logCount, const std::string& message) {
+    auto session = FFmpegSession::create(std::list<std::string>{"-version"});
+    history.add(session);
+    for (int i = 0; i < logCount; i++) {
+        session->addLog(std::make_shared<Log>(session->getSessionId(), LevelAVLogInfo, message));
+    }
+    history.complete(session->getSessionId());
+    return session;
+}
+
+static const SessionRecord* findRecord(const std::vector<SessionRecord>& records, const long sessionId) {
+    for (const SessionRecord& record : records) {
+        if (record.session->getSessionId() == sessionId) {
+            return &record;
+        }
+    }
+    return nullptr;
+}
+
+void testLeastRecentlyUsedEviction() {
+    SessionHistory history(3, SessionHistory::DefaultMaxRetainedBytes);
+
+    const long first = runTinySession(history, 1, "first")->getSessionId();
+    const long second = runTinySession(history, 1, "second")->getSessionId();
+    const long third = runTinySession(history, 1, "third")->getSessionId();
+    assert(history.getRetainedCount() == 3);
+
+    // USING THE FIRST SESSION MAKES THE SECOND ONE THE LEAST RECENTLY USED
+    assert(history.getSession(first) != nullptr);
+    runTinySession(history, 1, "fourth");
+    assert(history.getRetainedCount() == 3);
+    assert(history.getEvictedCount() == 1);
+    assert(history.getSession(second) == nullptr);
+    assert(history.getSession(first) != nullptr);
+    assert(history.getSession(third) != nullptr);
+}
+
+void testRetainedByteBudget() {
+    const std::string message(1000, 'x');
+    SessionHistory history(SessionHistory::DefaultMaxSessions, 10000);
+
+    auto session = runTinySession(history, 4, message);
+    auto records = history.listSessions();
+    const SessionRecord* record = findRecord(records, session->getSessionId());
+    assert(record != nullptr);
+    assert(record->completed);
+    assert(record->memory.logCount == 4);
+    assert(record->memory.logBytes == 4000);
+    assert(record->memory.retainedBytes > 4000);
+    assert(history.getRetainedBytes() == record->memory.retainedBytes);
+
+    // EVERY SESSION RETAINS MORE THAN 4000 BYTES, SO ONLY TWO OF THEM FIT
+    runTinySession(history, 4, message);
+    runTinySession(history, 4, message);
+    assert(history.getRetainedCount() == 2);
+    assert(history.getRetainedBytes() <= 10000);
+    assert(history.getSession(session->getSessionId()) == nullptr);
+
+    // RUNNING SESSIONS ARE LISTED BUT NEVER EVICTED
+    auto running = FFmpegSession::create(std::list<std::string>{"-version"});
+    history.add(running);
+    history.setLimits(1, 0);
+    assert(history.getRetainedCount() == 0);
+    assert(history.getSession(running->getSessionId()) == running);
+    records = history.listSessions();
+    record = findRecord(records, running->getSessionId());
+    assert(record != nullptr);
+    assert(!record->completed);
+}
+
+void testPlacementOutlivesRelease() {
+    SessionHistory history(SessionHistory::DefaultMaxSessions, SessionHistory::DefaultMaxRetainedBytes);
+
+    auto session = FFmpegSession::create(std::list<std::string>{"-version"});
+    history.add(session);
+    history.setPlacement(session->getSessionId(), "round robin node 1 cpus 4-7");
+    history.complete(session->getSessionId());
+
+    auto unpinned = runTinySession(history, 1, "unpinned");
+
+    auto records = history.listSessions();
+    assert(findRecord(records, session->getSessionId())->placement == "round robin node 1 cpus 4-7");
+    assert(findRecord(records, unpinned->getSessionId())->placement == "unpinned");
+}
+
+void testInternalHistoryCoversRunningSessions() {
+    SessionHistory history(SessionHistory::DefaultMaxSessions, SessionHistory::DefaultMaxRetainedBytes);
+    history.enable();
+    assert(FFmpegKitConfig::getSessionHistorySize() == SessionHistory::InternalHistorySize);
+
+    // A BATCH LARGER THAN THE DEFAULT SIZE GROWS THE INTERNAL HISTORY, SO THE FIRST SESSION STILL COLLECTS ITS LOGS
+    std::vector<std::shared_ptr<FFmpegSession>> batch;
+    for (int i = 0; i < 2 * SessionHistory::InternalHistorySize; i++) {
+        batch.push_back(FFmpegSession::create(std::list<std::string>{"-version"}));
+        history.add(batch.back());
+    }
+    assert(FFmpegKitConfig::getSessionHistorySize() == 2 * SessionHistory::InternalHistorySize + SessionHistory::InternalHistoryMargin);
+    for (int i = 0; i < SessionHistory::InternalHistoryMargin; i++) {
+        runTinySession(history, 0, "");
+    }
+    auto internalSessions = FFmpegKit::listSessions();
+    const long firstSessionId = batch.front()->getSessionId();
+    assert(std::any_of(internalSessions->begin(), internalSessions->end(), [firstSessionId](const std::shared_ptr<FFmpegSession> session) { return session->getSessionId() == firstSessionId; }));
+
+    // ONCE THE BATCH COMPLETES THE INTERNAL HISTORY SHRINKS BACK
+    for (const auto& session : batch) {
+        history.complete(session->getSessionId());
+    }
+    assert(FFmpegKitConfig::getSessionHistorySize() == SessionHistory::InternalHistorySize);
+}
+
+void testSessionHistorySoak() {
+    const int sessionCount = 100000;
+    const int concurrency = 8;
+    SessionHistory& history = SessionHistory::getInstance();
+    const long evictedBefore = history.getEvictedCount();
+
+    // EVERY SESSION ENCODES ONE TINY FRAME, SO IT PRODUCES LOGS AND STATISTICS THROUGH THE FFMPEGKIT CALLBACKS
+    const std::list<std::string> arguments{"-hide_banner", "-f", "lavfi", "-i", "color=s=16x16:d=0.04", "-f", "null", "-"};
+    std::mutex mutex;
+    std::condition_variable sessionCompleted;
+    int running = 0;
+    int failed = 0;
+
+    long baseline = 0;
+    for (int i = 0; i < sessionCount; i++) {
+        {
+            std::unique_lock<std::mutex> lock(mutex);
+            sessionCompleted.wait(lock, [&running, concurrency]() { return running < concurrency; });
+            running++;
+        }
+        SessionRouter::getInstance().executeAsync(arguments, [&](auto session) {
+            std::lock_guard<std::mutex> lock(mutex);
+            if (!ReturnCode::isSuccess(session->getReturnCode())) {
+                failed++;
+            }
+            running--;
+            sessionCompleted.notify_all();
+        }, 0);
+
+        // THE FIRST SESSIONS FILL BOTH HISTORIES, RSS MUST NOT GROW AFTER THAT
+        if (i == sessionCount / 10) {
+            baseline = readResidentBytes();
+        }
+    }
+    {
+        std::unique_lock<std::mutex> lock(mutex);
+        sessionCompleted.wait(lock, [&running]() { return running == 0; });
+    }
+    const long growth = readResidentBytes() - baseline;
+
+    std::cout << "Session history soak ran " << sessionCount << " sessions, retained " << history.getRetainedCount() << " sessions, " << history.getRetainedBytes() << " bytes, RSS grew " << growth << " bytes." << std::endl;
+    assert(failed == 0);
+    assert(history.getRetainedCount() <= SessionHistory::DefaultMaxSessions);
+    assert(history.getRetainedBytes() <= SessionHistory::DefaultMaxRetainedBytes);
+    assert(history.getEvictedCount() - evictedBefore >= sessionCount - SessionHistory::DefaultMaxSessions);
+    assert((int)FFmpegKit::listSessions()->size() <= SessionHistory::InternalHistorySize);
+    assert(growth < 8 * 1024 * 1024);
+}
+
+void testSessionHistory(void) {
+    testLeastRecentlyUsedEviction();
+    testRetainedByteBudget();
+    testPlacementOutlivesRelease();
+    testInternalHistoryCoversRunningSessions();
+    std::cout << "SessionHistoryTest passed." << std::endl;
+}
+
+void benchmarkSessionHistory(void) {
+    testSessionHistorySoak();
+}
@@ -0,0 +1,243 @@
+/*
+ * Copyright (c) 2022 Taner Sener
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#include "SessionPlacement.h"
+#include "JobScheduler.h"
+#include <algorithm>
+#include <cstdlib>
+#include <dirent.h>
+#include <fstream>
+#include <pthread.h>
+#include <sched.h>
+
+ffmpegkittest::SessionPlacement& ffmpegkittest::SessionPlacement::getInstance() {
+    static SessionPlacement instance(readTopology(), JobScheduler::DefaultJobThreads);
+    return instance;
+}
+
+std::vector<ffmpegkittest::NumaNode> ffmpegkittest::SessionPlacement::readTopology() {
+    std::vector<NumaNode> nodes;
+
+    DIR* directory = opendir("/sys/devices/system/node");
+    if (directory != nullptr) {
+        struct dirent* entry;
+        while ((entry = readdir(directory)) != nullptr) {
+            const std::string name = entry->d_name;
+            if (name.compare(0, 4, "node") != 0 || name.size() == 4 || name.find_first_not_of("0123456789", 4) != std::string::npos) {
+                continue;
+            }
+
+            std::ifstream cpuList("/sys/devices/system/node/" + name + "/cpulist");
+            std::string line;
+            if (std::getline(cpuList, line)) {
+                NumaNode node{std::stoi(name.substr(4)), parseCpuList(line)};
+                if (!node.cpus.empty()) {
+                    nodes.push_back(node);
+                }
+            }
+        }
+        closedir(directory);
+    }
+
+    // KERNELS WITHOUT NUMA SUPPORT HAVE NO NODE DIRECTORY, ALL USABLE CPUS FORM ONE NODE
+    if (nodes.empty()) {
+        NumaNode node{0, {}};
+        cpu_set_t cpuSet;
+        CPU_ZERO(&cpuSet);
+        if (sched_getaffinity(0, sizeof(cpuSet), &cpuSet) == 0) {
+            for (int cpu = 0; cpu < CPU_SETSIZE; cpu++) {
+                if (CPU_ISSET(cpu, &cpuSet)) {
+                    node.cpus.push_back(cpu);
+                }
+            }
+        }
+        nodes.push_back(node);
+    }
+
+    std::sort(nodes.begin(), nodes.end(), [](const NumaNode& left, const NumaNode& right) {
+        return left.id < right.id;
+    });
+    return nodes;
+}
+
+std::vector<int> ffmpegkittest::SessionPlacement::parseCpuList(const std::string& cpuList) {
+    std::vector<int> cpus;
+    size_t start = 0;
+
+    // COMMA SEPARATED CPUS AND RANGES, E.G. 0-3,8,10-11
+    while (start < cpuList.size()) {
+        size_t end = cpuList.find(',', start);
+        if (end == std::string::npos) {
+            end = cpuList.size();
+        }
+
+        const std::string range = cpuList.substr(start, end - start);
+        const size_t dash = range.find('-');
+        char* rest;
+        const long first = std::strtol(range.c_str(), &rest, 10);
+        const long last = (dash == std::string::npos) ? first : std::strtol(range.c_str() + dash + 1, &rest, 10);
+        if (rest != range.c_str() && first >= 0 && last >= first && last < CPU_SETSIZE) {
+            for (long cpu = first; cpu <= last; cpu++) {
+                cpus.push_back((int)cpu);
+            }
+        }
+
+        start = end + 1;
+    }
+
+    std::sort(cpus.begin(), cpus.end());
+    cpus.erase(std::unique(cpus.begin(), cpus.end()), cpus.end());
+    return cpus;
+}
+
+std::string ffmpegkittest::SessionPlacement::formatCpuList(const std::vector<int>& cpus) {
+    std::string cpuList;
+    size_t i = 0;
+
+    while (i < cpus.size()) {
+        size_t last = i;
+        while (last + 1 < cpus.size() && cpus[last + 1] == cpus[last] + 1) {
+            last++;
+        }
+        if (!cpuList.empty()) {
+            cpuList.push_back(',');
+        }
+        cpuList.append(std::to_string(cpus[i]));
+        if (last > i) {
+            cpuList.append("-").append(std::to_string(cpus[last]));
+        }
+        i = last + 1;
+    }
+
+    return cpuList;
+}
+
+bool ffmpegkittest::SessionPlacement::pinCurrentThread(const std::vector<int>& cpus) {
+    cpu_set_t cpuSet;
+    CPU_ZERO(&cpuSet);
+    for (const int cpu : cpus) {
+        CPU_SET(cpu, &cpuSet);
+    }
+    return pthread_setaffinity_np(pthread_self(), sizeof(cpuSet), &cpuSet) == 0;
+}
+
+const char* ffmpegkittest::SessionPlacement::policyToString(const PlacementPolicy policy) {
+    switch (policy) {
+        case PlacementRoundRobin: return "round robin";
+        case PlacementPacked: return "packed";
+        case PlacementUserDefined: return "user defined";
+        default: return "none";
+    }
+}
+
+ffmpegkittest::SessionPlacement::SessionPlacement(const std::vector<NumaNode>& nodes, const int threadsPerSession) :
+    nodes(nodes),
+    nodeSessions(nodes.size(), 0),
+    policy(PlacementNone),
+    threadsPerSession(std::max(1, threadsPerSession)),
+    nextNode(0) {
+}
+
+void ffmpegkittest::SessionPlacement::setPolicy(const PlacementPolicy policy) {
+    std::lock_guard<std::mutex> lock(mutex);
+    this->policy = policy;
+}
+
+ffmpegkittest::PlacementPolicy ffmpegkittest::SessionPlacement::getPolicy() {
+    std::lock_guard<std::mutex> lock(mutex);
+    return policy;
+}
+
+void ffmpegkittest::SessionPlacement::setUserCpuSet(const std::vector<int>& cpus) {
+    std::lock_guard<std::mutex> lock(mutex);
+    userCpus = cpus;
+}
+
+std::vector<int> ffmpegkittest::SessionPlacement::place(const long sessionId) {
+    std::lock_guard<std::mutex> lock(mutex);
+    Placement placement{-1, {}};
+
+    if (policy == PlacementUserDefined) {
+        placement.cpus = userCpus;
+    } else if (nodes.size() > 1 && policy == PlacementRoundRobin) {
+        placement.node = nextNode;
+        nextNode = (nextNode + 1) % (int)nodes.size();
+    } else if (nodes.size() > 1 && policy == PlacementPacked) {
+
+        // FILL THE LOWEST NODE UP TO ONE SESSION PER BUDGET, THEN THE LEAST LOADED ONE
+        int leastLoaded = 0;
+        for (int node = 0; node < (int)nodes.size(); node++) {
+            const int capacity = std::max(1, (int)nodes[node].cpus.size() / threadsPerSession);
+            if (nodeSessions[node] < capacity) {
+                placement.node = node;
+                break;
+            }
+            if (nodeSessions[node] < nodeSessions[leastLoaded]) {
+                leastLoaded = node;
+            }
+        }
+        if (placement.node < 0) {
+            placement.node = leastLoaded;
+        }
+    }
+
+    if (placement.node >= 0) {
+        placement.cpus = nodes[placement.node].cpus;
+        nodeSessions[placement.node]++;
+    }
+    if (!placement.cpus.empty()) {
+        placements[sessionId] = placement;
+    }
+
+    return placement.cpus;
+}
+
+void ffmpegkittest::SessionPlacement::release(const long sessionId) {
+    std::lock_guard<std::mutex> lock(mutex);
+    auto placement = placements.find(sessionId);
+    if (placement == placements.end()) {
+        return;
+    }
+    if (placement->second.node >= 0) {
+        nodeSessions[placement->second.node]--;
+    }
+    placements.erase(placement);
+}
+
+std::string ffmpegkittest::SessionPlacement::describe(const long sessionId) {
+    std::lock_guard<std::mutex> lock(mutex);
+    auto placement = placements.find(sessionId);
+    if (placement == placements.end()) {
+        return "unpinned";
+    }
+
+    std::string description;
+    if (placement->second.node >= 0) {
+        description.append("node ").append(std::to_string(nodes[placement->second.node].id)).append(" ");
+    }
+    return description.append("cpus ").append(formatCpuList(placement->second.cpus));
+}
+
+int ffmpegkittest::SessionPlacement::getNodeCount() {
+    std::lock_guard<std::mutex> lock(mutex);
+    return (int)nodes.size();
+}
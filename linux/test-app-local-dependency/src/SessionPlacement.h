@@ -0,0 +1,87 @@
+/*
+ * Copyright (c) 2022 Taner Sener
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#ifndef FFMPEG_KIT_TEST_SESSION_PLACEMENT_H
+#define FFMPEG_KIT_TEST_SESSION_PLACEMENT_H
+
+#include <map>
+#include <mutex>
+#include <string>
+#include <vector>
+
+namespace ffmpegkittest {
+
+    enum PlacementPolicy {
+        PlacementNone,
+        PlacementRoundRobin,
+        PlacementPacked,
+        PlacementUserDefined
+    };
+
+    struct NumaNode {
+        int id;
+        std::vector<int> cpus;
+    };
+
+    /**
+     * Chooses the cores a session runs on. Threads created by FFmpeg inherit the affinity of
+     * the thread that executes the session, so pinning that thread places the whole session.
+     * Round robin and packed placement spread sessions over NUMA nodes and do nothing on
+     * single node machines.
+     */
+    class SessionPlacement {
+        public:
+            static SessionPlacement& getInstance();
+            static std::vector<NumaNode> readTopology();
+            static std::vector<int> parseCpuList(const std::string& cpuList);
+            static std::string formatCpuList(const std::vector<int>& cpus);
+            static bool pinCurrentThread(const std::vector<int>& cpus);
+            static const char* policyToString(const PlacementPolicy policy);
+
+            SessionPlacement(const std::vector<NumaNode>& nodes, const int threadsPerSession);
+            void setPolicy(const PlacementPolicy policy);
+            PlacementPolicy getPolicy();
+            void setUserCpuSet(const std::vector<int>& cpus);
+            std::vector<int> place(const long sessionId);
+            void release(const long sessionId);
+            std::string describe(const long sessionId);
+            int getNodeCount();
+
+        private:
+            struct Placement {
+                int node;
+                std::vector<int> cpus;
+            };
+
+            std::mutex mutex;
+            std::vector<NumaNode> nodes;
+            std::vector<int> nodeSessions;
+            std::vector<int> userCpus;
+            std::map<long, Placement> placements;
+            PlacementPolicy policy;
+            int threadsPerSession;
+            int nextNode;
+    };
+
+}
+
+#endif // FFMPEG_KIT_TEST_SESSION_PLACEMENT_H
@@ -0,0 +1,101 @@
+/*
+ * Copyright (c) 2022 Taner Sener
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#include "SessionPlacementTest.h"
+#include "SessionPlacement.h"
+#include <iostream>
+#include <sched.h>
+#include <thread>
+
+using namespace ffmpegkittest;
+
+void testCpuLists() {
+    const std::vector<int> cpus = SessionPlacement::parseCpuList("0-3,8,10-11\n");
+    const std::vector<int> expected{0, 1, 2, 3, 8, 10, 11};
+    assert(cpus == expected);
+    assert(SessionPlacement::formatCpuList(cpus) == "0-3,8,10-11");
+    assert(SessionPlacement::parseCpuList("").empty());
+    assert(SessionPlacement::parseCpuList("x").empty());
+    assert(SessionPlacement::formatCpuList({5}) == "5");
+}
+
+void testPlacementPolicies() {
+    const std::vector<NumaNode> twoNodes{{0, {0, 1, 2, 3}}, {1, {4, 5, 6, 7}}};
+    SessionPlacement placement(twoNodes, 2);
+
+    assert(placement.place(1).empty());
+    assert(placement.describe(1) == "unpinned");
+
+    placement.setPolicy(PlacementRoundRobin);
+    assert(placement.place(2) == twoNodes[0].cpus);
+    assert(placement.place(3) == twoNodes[1].cpus);
+    assert(placement.place(4) == twoNodes[0].cpus);
+    assert(placement.describe(3) == "node 1 cpus 4-7");
+    placement.release(2);
+    placement.release(3);
+    placement.release(4);
+
+    // TWO SESSIONS FILL A FOUR CORE NODE WITH TWO THREADS EACH
+    placement.setPolicy(PlacementPacked);
+    assert(placement.place(5) == twoNodes[0].cpus);
+    assert(placement.place(6) == twoNodes[0].cpus);
+    assert(placement.place(7) == twoNodes[1].cpus);
+    placement.release(5);
+    assert(placement.place(8) == twoNodes[0].cpus);
+
+    placement.setPolicy(PlacementUserDefined);
+    placement.setUserCpuSet({2, 3});
+    assert(placement.place(9) == std::vector<int>({2, 3}));
+    assert(placement.describe(9) == "cpus 2-3");
+
+    // NUMA POLICIES DO NOTHING ON A SINGLE NODE
+    SessionPlacement singleNode({{0, {0, 1, 2, 3}}}, 2);
+    singleNode.setPolicy(PlacementRoundRobin);
+    assert(singleNode.place(1).empty());
+    singleNode.setPolicy(PlacementPacked);
+    assert(singleNode.place(2).empty());
+}
+
+void testPinnedThreadKeepsAffinity() {
+    const std::vector<NumaNode> nodes = SessionPlacement::readTopology();
+    assert(!nodes.empty() && !nodes[0].cpus.empty());
+
+    const int cpu = nodes[0].cpus[0];
+    bool pinned = false;
+    bool running = false;
+    std::thread([cpu, &pinned, &running]() {
+        pinned = SessionPlacement::pinCurrentThread({cpu});
+        cpu_set_t cpuSet;
+        CPU_ZERO(&cpuSet);
+        sched_getaffinity(0, sizeof(cpuSet), &cpuSet);
+        running = (CPU_COUNT(&cpuSet) == 1 && CPU_ISSET(cpu, &cpuSet));
+    }).join();
+    assert(pinned && running);
+}
+
+void testSessionPlacement(void) {
+    testCpuLists();
+    testPlacementPolicies();
+    testPinnedThreadKeepsAffinity();
+
+    std::cout << "SessionPlacementTest passed." << std::endl;
+}
@@ -0,0 +1,438 @@
+/*
+ * Copyright (c) 2022 Taner Sener
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#include "SessionRouter.h"
+#include "SessionHistory.h"
+#include "SessionPlacement.h"
+#include <FFmpegKitConfig.h>
+#include <Log.h>
+#include <cstdio>
+#include <dirent.h>
+#include <iostream>
+#include <thread>
+
+using namespace ffmpegkit;
+
+namespace ffmpegkittest {
+
+    struct LogEventDelivery {
+        SessionRouter* sessionRouter;
+        int consumerId;
+        LogEvent event;
+    };
+
+    gboolean deliverLogEvent(void* parameters) {
+        auto delivery = static_cast<LogEventDelivery*>(parameters);
+        auto consumer = delivery->sessionRouter->logEventConsumers.find(delivery->consumerId);
+        if (consumer != delivery->sessionRouter->logEventConsumers.end()) {
+            consumer->second(delivery->event);
+        }
+        delete delivery;
+        return FALSE;
+    }
+
+    gboolean sampleRouteStatistics(void* parameters) {
+        static_cast<SessionRouter*>(parameters)->sampleStatistics();
+        return TRUE;
+    }
+
+}
+
+ffmpegkittest::SessionRouter& ffmpegkittest::SessionRouter::getInstance() {
+    static SessionRouter instance(LogSink::getInstance());
+    return instance;
+}
+
+ffmpegkittest::SessionRouter::SessionRouter(LogSink& logSink) : logSink(logSink), unroutedCount(0), filteredCount(0), defaultLogConsumerId(0), nextLogFilterId(1), nextStatisticsConsumerId(1), nextLogEventConsumerId(1), statisticsSamplingInterval(DefaultStatisticsSamplingInterval), statisticsSamplingSource(0), logFileCapacity(LogRingFile::DefaultCapacity), enabled(false) {
+    for (int i = 0; i < MaxRoutes; i++) {
+        routes[i].version.store(0, std::memory_order_relaxed);
+        routes[i].sessionId.store(0, std::memory_order_relaxed);
+        routes[i].logConsumerId.store(0, std::memory_order_relaxed);
+        routes[i].statisticsConsumerId.store(0, std::memory_order_relaxed);
+        routes[i].logEventConsumerId.store(0, std::memory_order_relaxed);
+        routes[i].logFilterId.store(0, std::memory_order_relaxed);
+        routes[i].hasLogFile.store(false, std::memory_order_relaxed);
+        routes[i].retired = false;
+    }
+}
+
+void ffmpegkittest::SessionRouter::enable() {
+    if (enabled) {
+        return;
+    }
+
+    FFmpegKitConfig::enableLogCallback([this](auto log) {
+        dispatchLog(log);
+    });
+    FFmpegKitConfig::enableStatisticsCallback([this](auto statistics) {
+        dispatchStatistics(statistics);
+    });
+    statisticsSamplingSource = g_timeout_add(statisticsSamplingInterval, (GSourceFunc)sampleRouteStatistics, this);
+
+    enabled = true;
+}
+
+void ffmpegkittest::SessionRouter::enableLogFiles(const std::string& directory, const size_t capacity) {
+    logFileDirectory = directory;
+    logFileCapacity = capacity;
+
+    // NO ROUTE OWNS THE FILES OF AN EARLIER RUN
+    DIR* handle = opendir(directory.c_str());
+    if (handle != nullptr) {
+        struct dirent* entry;
+        while ((entry = readdir(handle)) != nullptr) {
+            const std::string name = entry->d_name;
+            if (name.compare(0, 8, "session-") == 0 && name.size() > 12 && name.compare(name.size() - 4, 4, ".log") == 0) {
+                std::remove((directory + "/" + name).c_str());
+            }
+        }
+        closedir(handle);
+    }
+}
+
+std::string ffmpegkittest::SessionRouter::getLogFile(const long sessionId) const {
+    return logFileDirectory + "/session-" + std::to_string(sessionId) + ".log";
+}
+
+int ffmpegkittest::SessionRouter::registerStatisticsConsumer(const StatisticsConsumer& consumer) {
+    const int consumerId = nextStatisticsConsumerId++;
+    statisticsConsumers[consumerId] = consumer;
+    return consumerId;
+}
+
+void ffmpegkittest::SessionRouter::unregisterStatisticsConsumer(const int consumerId) {
+    statisticsConsumers.erase(consumerId);
+}
+
+int ffmpegkittest::SessionRouter::registerLogEventConsumer(const LogEventConsumer& consumer) {
+    const int consumerId = nextLogEventConsumerId++;
+    logEventConsumers[consumerId] = consumer;
+    return consumerId;
+}
+
+void ffmpegkittest::SessionRouter::unregisterLogEventConsumer(const int consumerId) {
+    logEventConsumers.erase(consumerId);
+}
+
+int ffmpegkittest::SessionRouter::registerLogFilter(const LogFilter& filter) {
+    if (nextLogFilterId > MaxLogFilters) {
+        std::cout << "Log filter table is full, the filter is ignored." << std::endl;
+        return 0;
+    }
+
+    // REGISTERED FILTERS NEVER CHANGE, SO FFMPEG THREADS READ THEM WITHOUT LOCKING
+    logFilters[nextLogFilterId - 1] = filter;
+    return nextLogFilterId++;
+}
+
+void ffmpegkittest::SessionRouter::setDefaultLogConsumer(const int consumerId) {
+    defaultLogConsumerId.store(consumerId, std::memory_order_relaxed);
+}
+
+bool ffmpegkittest::SessionRouter::addRoute(const long sessionId, const int logConsumerId, const int statisticsConsumerId, const int logEventConsumerId, const int logFilterId) {
+    std::shared_ptr<LogRingFile> logFile;
+    if (!logFileDirectory.empty()) {
+        logFile = LogRingFile::create(getLogFile(sessionId), sessionId, logFileCapacity);
+    }
+
+    std::lock_guard<std::mutex> lock(routeMutex);
+
+    const auto now = std::chrono::steady_clock::now();
+    const int home = (int)(sessionId & (MaxRoutes - 1));
+    Route* selected = nullptr;
+
+    for (int i = 0; i < MaxRoutes; i++) {
+        Route& route = routes[(home + i) & (MaxRoutes - 1)];
+        if (route.sessionId.load(std::memory_order_relaxed) == 0) {
+            selected = &route;
+            break;
+        }
+
+        // RETIRED ROUTES ARE KEPT FOR A WHILE SO THAT LATE ASYNC MESSAGES STILL FIND THEIR CONSUMER
+        if (route.retired && (selected == nullptr || !selected->retired || route.retireTime < selected->retireTime)) {
+            selected = &route;
+        }
+    }
+
+    // THE FILE WAS CREATED OUTSIDE THE LOCK, A SESSION WITHOUT A ROUTE DOES NOT KEEP IT
+    if (selected == nullptr) {
+        if (logFile != nullptr) {
+            std::remove(logFile->getPath().c_str());
+        }
+        return false;
+    }
+
+    if (selected->retired && std::chrono::duration_cast<std::chrono::milliseconds>(now - selected->retireTime).count() < RetiredRouteGracePeriod) {
+        std::cout << "Reusing route of session " << selected->sessionId.load(std::memory_order_relaxed) << " before its grace period ended." << std::endl;
+    }
+
+    // THE FILE OF THE PREVIOUS SESSION IS DELETED WITH ITS ROUTE. A LATE WRITER KEEPS ITS MAPPING UNTIL IT RETURNS
+    auto previousLogFile = std::atomic_load(&selected->logFile);
+    writeRoute(*selected, sessionId, RouteTarget{logConsumerId, statisticsConsumerId, logEventConsumerId, logFilterId, logFile != nullptr}, logFile);
+    selected->retired = false;
+    if (previousLogFile != nullptr && previousLogFile->getSessionId() != sessionId) {
+        std::remove(previousLogFile->getPath().c_str());
+    }
+
+    return true;
+}
+
+void ffmpegkittest::SessionRouter::removeRoute(const long sessionId) {
+    std::lock_guard<std::mutex> lock(routeMutex);
+
+    for (int i = 0; i < MaxRoutes; i++) {
+        if (routes[i].sessionId.load(std::memory_order_relaxed) == sessionId) {
+            routes[i].retired = true;
+            routes[i].retireTime = std::chrono::steady_clock::now();
+        }
+    }
+}
+
+void ffmpegkittest::SessionRouter::dispatchLog(const std::shared_ptr<Log> log) {
+    RouteTarget target;
+    const long sessionId = log->getSessionId();
+
+    const int index = lookup(sessionId, target);
+    if (index < 0) {
+        unroutedCount.fetch_add(1, std::memory_order_relaxed);
+        const int defaultConsumerId = defaultLogConsumerId.load(std::memory_order_relaxed);
+        if (defaultConsumerId > 0) {
+            logSink.push(defaultConsumerId, log->getMessage());
+        }
+        return;
+    }
+
+    // A LINE THAT ONLY A FILTERED CONSUMER WOULD SEE IS COUNTED AND DROPPED BEFORE ITS MESSAGE IS COPIED
+    const bool levelAccepted = (target.logFilterId == 0 || logFilters[target.logFilterId - 1].acceptsLevel(log->getLevel()));
+    if (!levelAccepted && !target.hasLogFile && target.logEventConsumerId <= 0) {
+        filteredCount.fetch_add(1, std::memory_order_relaxed);
+        return;
+    }
+
+    deliverLog(index, sessionId, target, levelAccepted, log->getMessage());
+}
+
+void ffmpegkittest::SessionRouter::dispatchLog(const long sessionId, const int level, const std::string& message) {
+    RouteTarget target;
+
+    const int index = lookup(sessionId, target);
+    if (index < 0) {
+        unroutedCount.fetch_add(1, std::memory_order_relaxed);
+        const int defaultConsumerId = defaultLogConsumerId.load(std::memory_order_relaxed);
+        if (defaultConsumerId > 0) {
+            logSink.push(defaultConsumerId, message);
+        }
+        return;
+    }
+
+    const bool levelAccepted = (target.logFilterId == 0 || logFilters[target.logFilterId - 1].acceptsLevel(level));
+    deliverLog(index, sessionId, target, levelAccepted, message);
+}
+
+void ffmpegkittest::SessionRouter::dispatchStatistics(const std::shared_ptr<Statistics> statistics) {
+    RouteTarget target;
+
+    const int index = lookup(statistics->getSessionId(), target);
+    if (index >= 0 && target.statisticsConsumerId > 0) {
+
+        // ONLY THE LATEST SAMPLE AND THE AGGREGATES ARE KEPT, CONSUMERS SEE THEM AT THE SAMPLING RATE
+        routes[index].aggregator.add(*statistics);
+    } else {
+        unroutedCount.fetch_add(1, std::memory_order_relaxed);
+    }
+}
+
+std::shared_ptr<FFmpegSession> ffmpegkittest::SessionRouter::executeAsync(const std::string& command, FFmpegSessionCompleteCallback completeCallback, const int logConsumerId, const int statisticsConsumerId, const int logEventConsumerId, const int logFilterId) {
+    return executeAsync(FFmpegKitConfig::parseArguments(command.c_str()), completeCallback, logConsumerId, statisticsConsumerId, logEventConsumerId, logFilterId);
+}
+
+std::shared_ptr<FFmpegSession> ffmpegkittest::SessionRouter::executeAsync(const std::list<std::string>& arguments, FFmpegSessionCompleteCallback completeCallback, const int logConsumerId, const int statisticsConsumerId, const int logEventConsumerId, const int logFilterId) {
+    auto session = FFmpegSession::create(arguments, [this, completeCallback](auto session) {
+        removeRoute(session->getSessionId());
+        SessionPlacement::getInstance().release(session->getSessionId());
+        SessionHistory::getInstance().complete(session->getSessionId());
+        if (completeCallback != nullptr) {
+            completeCallback(session);
+        }
+    });
+
+    // THE ROUTE MUST EXIST BEFORE THE SESSION PRODUCES ITS FIRST LOG
+    if (!addRoute(session->getSessionId(), logConsumerId, statisticsConsumerId, logEventConsumerId, logFilterId)) {
+        std::cout << "Route table is full, logs of session " << session->getSessionId() << " go to the default log consumer and its statistics and log events are not delivered." << std::endl;
+    }
+    SessionHistory::getInstance().add(session);
+
+    const std::vector<int> cpus = SessionPlacement::getInstance().place(session->getSessionId());
+
+    // THE PLACEMENT IS RELEASED BEFORE THE SESSION IS LISTED, SO THE HISTORY KEEPS ITS OWN COPY
+    if (!cpus.empty()) {
+        SessionHistory::getInstance().setPlacement(session->getSessionId(), std::string(SessionPlacement::policyToString(SessionPlacement::getInstance().getPolicy())) + " " + SessionPlacement::getInstance().describe(session->getSessionId()));
+    }
+    if (cpus.empty()) {
+        FFmpegKitConfig::asyncFFmpegExecute(session);
+        return session;
+    }
+
+    // FFMPEG THREADS INHERIT THE AFFINITY OF THE THREAD THAT EXECUTES THE SESSION
+    std::thread([session, cpus]() {
+        if (!SessionPlacement::pinCurrentThread(cpus)) {
+            std::cout << "Failed to pin session " << session->getSessionId() << " to cpus " << SessionPlacement::formatCpuList(cpus) << "." << std::endl;
+        }
+        FFmpegKitConfig::ffmpegExecute(session);
+        session->getCompleteCallback()(session);
+    }).detach();
+
+    return session;
+}
+
+int ffmpegkittest::SessionRouter::sampleStatistics() {
+    StatisticsSnapshot snapshot;
+    int delivered = 0;
+
+    for (int i = 0; i < MaxRoutes; i++) {
+        const int statisticsConsumerId = routes[i].statisticsConsumerId.load(std::memory_order_relaxed);
+        if (statisticsConsumerId <= 0 || !routes[i].aggregator.sample(snapshot)) {
+            continue;
+        }
+
+        // THE ROUTE MAY HAVE BEEN REUSED WHILE IT WAS SAMPLED
+        if (routes[i].sessionId.load(std::memory_order_relaxed) != snapshot.sessionId) {
+            continue;
+        }
+
+        auto consumer = statisticsConsumers.find(statisticsConsumerId);
+        if (consumer != statisticsConsumers.end()) {
+            consumer->second(snapshot);
+            delivered++;
+        }
+    }
+
+    return delivered;
+}
+
+bool ffmpegkittest::SessionRouter::getStatistics(const long sessionId, StatisticsSnapshot& snapshot) {
+    RouteTarget target;
+
+    const int index = lookup(sessionId, target);
+    return index >= 0 && routes[index].aggregator.peek(snapshot) && snapshot.sessionId == sessionId;
+}
+
+void ffmpegkittest::SessionRouter::setStatisticsSamplingInterval(const int intervalInMilliseconds) {
+    statisticsSamplingInterval = intervalInMilliseconds;
+
+    if (statisticsSamplingSource != 0) {
+        g_source_remove(statisticsSamplingSource);
+        statisticsSamplingSource = g_timeout_add(statisticsSamplingInterval, (GSourceFunc)sampleRouteStatistics, this);
+    }
+}
+
+uint64_t ffmpegkittest::SessionRouter::getFilteredCount() const {
+    return filteredCount.load(std::memory_order_relaxed);
+}
+
+uint64_t ffmpegkittest::SessionRouter::getUnroutedCount() const {
+    return unroutedCount.load(std::memory_order_relaxed);
+}
+
+void ffmpegkittest::SessionRouter::deliverLog(const int index, const long sessionId, const RouteTarget& target, const bool levelAccepted, const std::string& message) {
+    bool delivered = false;
+
+    if (target.hasLogFile) {
+        auto logFile = std::atomic_load(&routes[index].logFile);
+        if (logFile != nullptr && logFile->getSessionId() == sessionId) {
+            logFile->write(message);
+            delivered = true;
+        }
+    }
+    if (target.logConsumerId > 0) {
+        if (levelAccepted && (target.logFilterId == 0 || logFilters[target.logFilterId - 1].acceptsMessage(message.data(), message.size()))) {
+            logSink.push(target.logConsumerId, message);
+        } else {
+            filteredCount.fetch_add(1, std::memory_order_relaxed);
+        }
+        delivered = true;
+    }
+    if (target.logEventConsumerId > 0) {
+        std::lock_guard<std::mutex> lock(routes[index].parserMutex);
+        if (routes[index].parser.getSessionId() == sessionId) {
+            routes[index].parser.feed(message.data(), message.size(), [this, &target](const LogEvent& event) {
+                g_idle_add((GSourceFunc)deliverLogEvent, new LogEventDelivery{this, target.logEventConsumerId, event});
+            });
+            delivered = true;
+        }
+    }
+
+    if (!delivered) {
+        unroutedCount.fetch_add(1, std::memory_order_relaxed);
+    }
+}
+
+int ffmpegkittest::SessionRouter::lookup(const long sessionId, RouteTarget& target) {
+    const int home = (int)(sessionId & (MaxRoutes - 1));
+
+    for (int i = 0; i < MaxRoutes; i++) {
+        const int index = (home + i) & (MaxRoutes - 1);
+        Route& route = routes[index];
+
+        const unsigned version = route.version.load(std::memory_order_acquire);
+        if ((version & 1) != 0 || route.sessionId.load(std::memory_order_relaxed) != sessionId) {
+            continue;
+        }
+
+        target.logConsumerId = route.logConsumerId.load(std::memory_order_relaxed);
+        target.statisticsConsumerId = route.statisticsConsumerId.load(std::memory_order_relaxed);
+        target.logEventConsumerId = route.logEventConsumerId.load(std::memory_order_relaxed);
+        target.logFilterId = route.logFilterId.load(std::memory_order_relaxed);
+        target.hasLogFile = route.hasLogFile.load(std::memory_order_relaxed);
+
+        // A ROUTE REWRITTEN WHILE IT WAS BEING READ IS TREATED AS A MISS
+        std::atomic_thread_fence(std::memory_order_acquire);
+        if (route.version.load(std::memory_order_relaxed) == version) {
+            return index;
+        }
+    }
+
+    return -1;
+}
+
+void ffmpegkittest::SessionRouter::writeRoute(Route& route, const long sessionId, const RouteTarget& target, const std::shared_ptr<LogRingFile> logFile) {
+    const unsigned version = route.version.load(std::memory_order_relaxed);
+    route.version.store(version + 1, std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_release);
+
+    route.sessionId.store(sessionId, std::memory_order_relaxed);
+    route.logConsumerId.store(target.logConsumerId, std::memory_order_relaxed);
+    route.statisticsConsumerId.store(target.statisticsConsumerId, std::memory_order_relaxed);
+    route.logEventConsumerId.store(target.logEventConsumerId, std::memory_order_relaxed);
+    route.logFilterId.store(target.logFilterId, std::memory_order_relaxed);
+    route.hasLogFile.store(target.hasLogFile, std::memory_order_relaxed);
+    route.aggregator.reset(sessionId);
+    {
+        std::lock_guard<std::mutex> lock(route.parserMutex);
+        route.parser.reset(sessionId);
+    }
+
+    // A WRITER STILL HOLDING THE PREVIOUS FILE KEEPS IT MAPPED UNTIL IT RETURNS
+    std::atomic_store(&route.logFile, logFile);
+
+    route.version.store(version + 2, std::memory_order_release);
+}
@@ -0,0 +1,145 @@
+/*
+ * Copyright (c) 2022 Taner Sener
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#ifndef FFMPEG_KIT_TEST_SESSION_ROUTER_H
+#define FFMPEG_KIT_TEST_SESSION_ROUTER_H
+
+#include "LogFilter.h"
+#include "LogParser.h"
+#include "LogRingFile.h"
+#include "LogSink.h"
+#include "StatisticsAggregator.h"
+#include <FFmpegSession.h>
+#include <Log.h>
+#include <atomic>
+#include <chrono>
+#include <functional>
+#include <list>
+#include <map>
+#include <mutex>
+
+namespace ffmpegkittest {
+
+    /**
+     * Routes log and statistics callbacks of each session to the consumers registered for
+     * that session id. Global FFmpegKit callbacks are installed once; lookups on FFmpeg
+     * threads do not lock and finish in a bounded number of steps. Statistics are folded
+     * into a per-session aggregator and delivered to consumers at the sampling rate. When log
+     * files are enabled every routed session also streams its log into its own ring file, so
+     * log files are opt-in: lines its filter rejects are then still copied for the file. A ring
+     * file outlives its session until the route is reused and is deleted then, so there are
+     * never more files than routes. Files left by an earlier run are deleted when log files
+     * are enabled.
+     * Sessions with a log event consumer have their log parsed into typed events. A log
+     * filter keeps uninteresting lines of a session away from its log consumer. Lines of
+     * sessions without a route, including sessions that found the route table full, go to the
+     * default log consumer when one is set.
+     */
+    class SessionRouter {
+        public:
+            static constexpr const int MaxRoutes = 64;
+            static constexpr const int RetiredRouteGracePeriod = 2000;
+            static constexpr const int DefaultStatisticsSamplingInterval = 100;
+            static constexpr const int MaxLogFilters = 16;
+
+            typedef std::function<void(const StatisticsSnapshot& statistics)> StatisticsConsumer;
+            typedef std::function<void(const LogEvent& event)> LogEventConsumer;
+
+            static SessionRouter& getInstance();
+
+            explicit SessionRouter(LogSink& logSink);
+            void enable();
+            void enableLogFiles(const std::string& directory, const size_t capacity = LogRingFile::DefaultCapacity);
+            std::string getLogFile(const long sessionId) const;
+            int registerStatisticsConsumer(const StatisticsConsumer& consumer);
+            void unregisterStatisticsConsumer(const int consumerId);
+            int registerLogEventConsumer(const LogEventConsumer& consumer);
+            void unregisterLogEventConsumer(const int consumerId);
+            int registerLogFilter(const LogFilter& filter);
+            void setDefaultLogConsumer(const int consumerId);
+            bool addRoute(const long sessionId, const int logConsumerId, const int statisticsConsumerId, const int logEventConsumerId = 0, const int logFilterId = 0);
+            void removeRoute(const long sessionId);
+            void dispatchLog(const std::shared_ptr<ffmpegkit::Log> log);
+            void dispatchLog(const long sessionId, const int level, const std::string& message);
+            void dispatchStatistics(const std::shared_ptr<ffmpegkit::Statistics> statistics);
+            std::shared_ptr<ffmpegkit::FFmpegSession> executeAsync(const std::string& command, ffmpegkit::FFmpegSessionCompleteCallback completeCallback, const int logConsumerId, const int statisticsConsumerId = 0, const int logEventConsumerId = 0, const int logFilterId = 0);
+            std::shared_ptr<ffmpegkit::FFmpegSession> executeAsync(const std::list<std::string>& arguments, ffmpegkit::FFmpegSessionCompleteCallback completeCallback, const int logConsumerId, const int statisticsConsumerId = 0, const int logEventConsumerId = 0, const int logFilterId = 0);
+            int sampleStatistics();
+            bool getStatistics(const long sessionId, StatisticsSnapshot& snapshot);
+            void setStatisticsSamplingInterval(const int intervalInMilliseconds);
+            uint64_t getFilteredCount() const;
+            uint64_t getUnroutedCount() const;
+
+            friend gboolean sampleRouteStatistics(void* parameters);
+            friend gboolean deliverLogEvent(void* parameters);
+
+        private:
+            struct Route {
+                std::atomic<unsigned> version;
+                std::atomic<long> sessionId;
+                std::atomic<int> logConsumerId;
+                std::atomic<int> statisticsConsumerId;
+                std::atomic<int> logEventConsumerId;
+                std::atomic<int> logFilterId;
+                std::atomic<bool> hasLogFile;
+                bool retired;
+                std::chrono::steady_clock::time_point retireTime;
+                StatisticsAggregator aggregator;
+                std::shared_ptr<LogRingFile> logFile;
+                LogParser parser;
+                std::mutex parserMutex;
+            };
+
+            struct RouteTarget {
+                int logConsumerId;
+                int statisticsConsumerId;
+                int logEventConsumerId;
+                int logFilterId;
+                bool hasLogFile;
+            };
+
+            int lookup(const long sessionId, RouteTarget& target);
+            void deliverLog(const int index, const long sessionId, const RouteTarget& target, const bool levelAccepted, const std::string& message);
+            void writeRoute(Route& route, const long sessionId, const RouteTarget& target, const std::shared_ptr<LogRingFile> logFile);
+
+            LogSink& logSink;
+            Route routes[MaxRoutes];
+            std::mutex routeMutex;
+            std::atomic<uint64_t> unroutedCount;
+            std::atomic<uint64_t> filteredCount;
+            std::atomic<int> defaultLogConsumerId;
+            LogFilter logFilters[MaxLogFilters];
+            int nextLogFilterId;
+            std::map<int, StatisticsConsumer> statisticsConsumers;
+            int nextStatisticsConsumerId;
+            std::map<int, LogEventConsumer> logEventConsumers;
+            int nextLogEventConsumerId;
+            int statisticsSamplingInterval;
+            guint statisticsSamplingSource;
+            std::string logFileDirectory;
+            size_t logFileCapacity;
+            bool enabled;
+    };
+
+}
+
+#endif // FFMPEG_KIT_TEST_SESSION_ROUTER_H
@@ -0,0 +1,329 @@
+/*
+ * Copyright (c) 2022 Taner Sener
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#include "SessionRouterTest.h"
+#include "Application.h"
+#include "SessionRouter.h"
+#include <chrono>
+#include <cstdio>
+#include <iostream>
+#include <sys/stat.h>
+#include <thread>
+#include <unistd.h>
+#include <vector>
+
+using namespace ffmpegkittest;
+
+static const int SessionCount = 16;
+static const int LinesPerSession = 250;
+static const int BenchmarkLinesPerSession = 4000;
+
+void routeConcurrentSessions(const int linesPerSession) {
+    LogSink logSink(SessionCount * linesPerSession);
+    SessionRouter sessionRouter(logSink);
+    std::vector<std::vector<int>> received(SessionCount);
+
+    for (int i = 0; i < SessionCount; i++) {
+        const int consumerId = logSink.registerConsumer([&received, i](const std::string& batch) {
+            size_t start = 0;
+            size_t end;
+            while ((end = batch.find('\n', start)) != std::string::npos) {
+                const size_t separator = batch.find(':', start);
+                assert(std::stoi(batch.substr(start, separator - start)) == i);
+                received[i].push_back(std::stoi(batch.substr(separator + 1, end - separator - 1)));
+                start = end + 1;
+            }
+        });
+        const bool added = sessionRouter.addRoute(1000 + i, consumerId, 0);
+        assert(added);
+    }
+
+    std::atomic<bool> producing(true);
+    std::thread drainThread([&logSink, &producing]() {
+        while (producing.load()) {
+            logSink.drain();
+        }
+        logSink.drain();
+    });
+
+    std::atomic<long> dispatchNanoseconds(0);
+    std::vector<std::thread> sessionThreads;
+    for (int i = 0; i < SessionCount; i++) {
+        sessionThreads.emplace_back([&sessionRouter, &dispatchNanoseconds, linesPerSession, i]() {
+            const std::string prefix = std::to_string(i) + ":";
+            const auto start = std::chrono::steady_clock::now();
+            for (int line = 0; line < linesPerSession; line++) {
+                sessionRouter.dispatchLog(1000 + i, ffmpegkit::LevelAVLogInfo, prefix + std::to_string(line) + "\n");
+            }
+            dispatchNanoseconds += std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - start).count();
+        });
+    }
+    for (auto& thread : sessionThreads) {
+        thread.join();
+    }
+    producing = false;
+    drainThread.join();
+
+    uint64_t receivedCount = 0;
+    for (int i = 0; i < SessionCount; i++) {
+        for (size_t line = 1; line < received[i].size(); line++) {
+            assert(received[i][line] > received[i][line - 1]);
+        }
+        receivedCount += received[i].size();
+    }
+
+    assert(receivedCount + logSink.getDroppedCount() == (uint64_t)SessionCount * linesPerSession);
+    assert(sessionRouter.getUnroutedCount() == 0);
+
+    std::cout << "Routed " << SessionCount * linesPerSession << " lines of " << SessionCount << " concurrent sessions, " << dispatchNanoseconds.load() / ((long)SessionCount * linesPerSession) << " ns per line, " << logSink.getDroppedCount() << " dropped." << std::endl;
+}
+
+void testConcurrentSessionsWithoutCrossTalk() {
+    routeConcurrentSessions(LinesPerSession);
+}
+
+void testRetiredRoutesAreReused() {
+    LogSink logSink(16);
+    SessionRouter sessionRouter(logSink);
+
+    for (long sessionId = 1; sessionId <= SessionRouter::MaxRoutes; sessionId++) {
+        const bool added = sessionRouter.addRoute(sessionId, 1, 0);
+        assert(added);
+    }
+    const bool addedToFullTable = sessionRouter.addRoute(SessionRouter::MaxRoutes + 1, 1, 0);
+    assert(!addedToFullTable);
+
+    sessionRouter.removeRoute(5);
+    const bool addedToRetiredRoute = sessionRouter.addRoute(SessionRouter::MaxRoutes + 1, 2, 0);
+    assert(addedToRetiredRoute);
+
+    sessionRouter.dispatchLog(5, ffmpegkit::LevelAVLogInfo, "unrouted\n");
+    assert(sessionRouter.getUnroutedCount() == 1);
+}
+
+void testFullRouteTableFallsBackToDefaultConsumer() {
+    LogSink logSink(16);
+    SessionRouter sessionRouter(logSink);
+    std::string received;
+    std::string fallback;
+
+    const int consumerId = logSink.registerConsumer([&received](const std::string& batch) {
+        received.append(batch);
+    });
+    for (long sessionId = 1; sessionId <= SessionRouter::MaxRoutes; sessionId++) {
+        sessionRouter.addRoute(sessionId, consumerId, 0);
+    }
+    const long overflowSessionId = SessionRouter::MaxRoutes + 1;
+    assert(!sessionRouter.addRoute(overflowSessionId, consumerId, 0));
+
+    // WITHOUT A DEFAULT CONSUMER THE LINE IS ONLY COUNTED
+    sessionRouter.dispatchLog(overflowSessionId, ffmpegkit::LevelAVLogInfo, "lost\n");
+    logSink.drain();
+    assert(received.empty());
+    assert(sessionRouter.getUnroutedCount() == 1);
+
+    sessionRouter.setDefaultLogConsumer(logSink.registerConsumer([&fallback](const std::string& batch) {
+        fallback.append(batch);
+    }));
+    sessionRouter.dispatchLog(overflowSessionId, ffmpegkit::LevelAVLogInfo, "overflow\n");
+    sessionRouter.dispatchLog(1, ffmpegkit::LevelAVLogInfo, "routed\n");
+    logSink.drain();
+    assert(fallback == "overflow\n");
+    assert(received == "routed\n");
+    assert(sessionRouter.getUnroutedCount() == 2);
+}
+
+void testStatisticsAreSampledLatestWins() {
+    LogSink logSink(16);
+    SessionRouter sessionRouter(logSink);
+    std::vector<StatisticsSnapshot> delivered;
+
+    const int consumerId = sessionRouter.registerStatisticsConsumer([&delivered](const StatisticsSnapshot& statistics) {
+        delivered.push_back(statistics);
+    });
+    sessionRouter.addRoute(7, 0, consumerId);
+
+    for (int frame = 1; frame <= 1000; frame++) {
+        sessionRouter.dispatchStatistics(std::make_shared<ffmpegkit::Statistics>(7, frame, (float)(frame % 10 + 20), 28.0f, frame * 1000, frame * 40.0, 512.0, (frame % 2 == 0) ? 2.0 : 1.0));
+    }
+    sessionRouter.dispatchStatistics(std::make_shared<ffmpegkit::Statistics>(8, 1, 1.0f, 1.0f, 1, 1.0, 1.0, 1.0));
+
+    assert(sessionRouter.sampleStatistics() == 1);
+    assert(sessionRouter.sampleStatistics() == 0);
+    assert(delivered.size() == 1);
+
+    const StatisticsSnapshot& snapshot = delivered.back();
+    assert(snapshot.sessionId == 7);
+    assert(snapshot.sampleCount == 1000);
+    assert(snapshot.videoFrameNumber == 1000);
+    assert(snapshot.time == 40000.0);
+    assert(snapshot.minVideoFps == 20.0f && snapshot.maxVideoFps == 29.0f);
+    assert(snapshot.averageVideoFps == 24.5f);
+    assert(snapshot.minSpeed == 1.0 && snapshot.maxSpeed == 2.0 && snapshot.averageSpeed == 1.5);
+    assert(sessionRouter.getUnroutedCount() == 1);
+}
+
+/**
+ * Creates an empty directory for ring files, since enabling log files deletes the ring
+ * files already in the directory.
+ */
+static std::string createLogDirectory() {
+    std::string directory = Application::getApplicationCacheDirectory() + "/session-router-test-XXXXXX";
+    const bool created = (mkdtemp(&directory[0]) != nullptr);
+    assert(created);
+    return directory;
+}
+
+void testSessionLogsWrapInRingFiles() {
+    const std::string directory = createLogDirectory();
+    LogSink logSink(16);
+    SessionRouter sessionRouter(logSink);
+    sessionRouter.enableLogFiles(directory, 256);
+    sessionRouter.addRoute(11, 0, 0);
+
+    std::string expected;
+    for (int line = 0; line < 100; line++) {
+        const std::string message = "line " + std::to_string(line) + "\n";
+        sessionRouter.dispatchLog(11, ffmpegkit::LevelAVLogInfo, message);
+        expected.append(message);
+    }
+
+    long sessionId;
+    std::string log;
+    const bool read = LogRingFile::read(sessionRouter.getLogFile(11), sessionId, log);
+    assert(read);
+    assert(sessionId == 11);
+    assert(!log.empty() && log.size() <= 256);
+    assert(expected.compare(expected.size() - log.size(), log.size(), log) == 0);
+    assert(log.compare(0, 5, "line ") == 0);
+    assert(sessionRouter.getUnroutedCount() == 0);
+
+    std::remove(sessionRouter.getLogFile(11).c_str());
+    rmdir(directory.c_str());
+}
+
+static bool fileExists(const std::string& path) {
+    struct stat fileStat;
+    return stat(path.c_str(), &fileStat) == 0;
+}
+
+void testRingFilesAreDeletedWithTheirRoute() {
+    const std::string directory = createLogDirectory();
+
+    // A FILE LEFT BY AN EARLIER RUN
+    const std::string staleFile = directory + "/session-999.log";
+    fclose(fopen(staleFile.c_str(), "w"));
+
+    LogSink logSink(16);
+    SessionRouter sessionRouter(logSink);
+    sessionRouter.enableLogFiles(directory, 256);
+    assert(!fileExists(staleFile));
+
+    for (long sessionId = 1; sessionId <= SessionRouter::MaxRoutes; sessionId++) {
+        sessionRouter.addRoute(sessionId, 0, 0);
+    }
+
+    // A SESSION THAT FINDS THE TABLE FULL LEAVES NO FILE BEHIND
+    assert(!sessionRouter.addRoute(SessionRouter::MaxRoutes + 1, 0, 0));
+    assert(!fileExists(sessionRouter.getLogFile(SessionRouter::MaxRoutes + 1)));
+
+    sessionRouter.removeRoute(3);
+    assert(fileExists(sessionRouter.getLogFile(3)));
+
+    // THE RETIRED ROUTE IS THE ONLY ONE LEFT, REUSING IT DELETES THE FILE OF ITS SESSION
+    assert(sessionRouter.addRoute(SessionRouter::MaxRoutes + 1, 0, 0));
+    assert(!fileExists(sessionRouter.getLogFile(3)));
+    assert(fileExists(sessionRouter.getLogFile(SessionRouter::MaxRoutes + 1)));
+
+    for (long sessionId = 1; sessionId <= SessionRouter::MaxRoutes + 1; sessionId++) {
+        std::remove(sessionRouter.getLogFile(sessionId).c_str());
+    }
+    rmdir(directory.c_str());
+}
+
+void testLogFilterDropsLinesBeforeDelivery() {
+    LogSink logSink(64);
+    SessionRouter sessionRouter(logSink);
+    std::string received;
+
+    const int consumerId = logSink.registerConsumer([&received](const std::string& batch) {
+        received.append(batch);
+    });
+    const int warningFilterId = sessionRouter.registerLogFilter(LogFilter(ffmpegkit::LevelAVLogWarning));
+    const int contextFilterId = sessionRouter.registerLogFilter(LogFilter(ffmpegkit::LevelAVLogInfo, LogCategoryContext, "libx264"));
+    sessionRouter.addRoute(21, consumerId, 0, 0, warningFilterId);
+    sessionRouter.addRoute(22, consumerId, 0, 0, contextFilterId);
+
+    sessionRouter.dispatchLog(21, ffmpegkit::LevelAVLogInfo, "info\n");
+    sessionRouter.dispatchLog(21, ffmpegkit::LevelAVLogError, "error\n");
+    sessionRouter.dispatchLog(22, ffmpegkit::LevelAVLogInfo, "[libx264 @ 0x1] profile High\n");
+    sessionRouter.dispatchLog(22, ffmpegkit::LevelAVLogInfo, "[mp4 @ 0x2] muxing\n");
+    sessionRouter.dispatchLog(22, ffmpegkit::LevelAVLogInfo, "frame=   10 fps=0.0 libx264\n");
+    sessionRouter.dispatchLog(22, ffmpegkit::LevelAVLogDebug, "[libx264 @ 0x1] debug\n");
+    logSink.drain();
+
+    assert(received == "error\n[libx264 @ 0x1] profile High\n");
+    assert(sessionRouter.getFilteredCount() == 4);
+    assert(sessionRouter.getUnroutedCount() == 0);
+}
+
+void benchmarkLogFilter() {
+    static const int Lines = 200000;
+    static const char* LibX264Line = "[libx264 @ 0x55d1c4a3e2c0] frame=  112 QP=23.41 NAL=2 Slice:P Poc:224 I:12   P:401  SKIP:1127 size=3417 bytes\n";
+
+    for (int filtered = 0; filtered < 2; filtered++) {
+        LogSink logSink;
+        SessionRouter sessionRouter(logSink);
+        const int consumerId = logSink.registerConsumer([](const std::string&) {});
+        const int filterId = filtered ? sessionRouter.registerLogFilter(LogFilter(ffmpegkit::LevelAVLogWarning)) : 0;
+        sessionRouter.addRoute(31, consumerId, 0, 0, filterId);
+
+        const auto start = std::chrono::steady_clock::now();
+        for (int line = 0; line < Lines; line++) {
+            sessionRouter.dispatchLog(31, ffmpegkit::LevelAVLogInfo, LibX264Line);
+            if ((line & 4095) == 4095) {
+                logSink.drain();
+            }
+        }
+        logSink.drain();
+        const double nanoseconds = std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - start).count();
+
+        std::cout << "Dispatched " << Lines << " info lines " << (filtered ? "filtered to warning" : "unfiltered") << ", " << (long)(nanoseconds / Lines) << " ns per line including main loop delivery, " << logSink.getDeliveredCount() << " delivered." << std::endl;
+    }
+}
+
+void testSessionRouter(void) {
+    testConcurrentSessionsWithoutCrossTalk();
+    testRetiredRoutesAreReused();
+    testFullRouteTableFallsBackToDefaultConsumer();
+    testStatisticsAreSampledLatestWins();
+    testSessionLogsWrapInRingFiles();
+    testRingFilesAreDeletedWithTheirRoute();
+    testLogFilterDropsLinesBeforeDelivery();
+
+    std::cout << "SessionRouterTest passed." << std::endl;
+}
+
+void benchmarkSessionRouter(void) {
+    routeConcurrentSessions(BenchmarkLinesPerSession);
+    benchmarkLogFilter();
+}
@@ -0,0 +1,309 @@
+/*
+ * Copyright (c) 2022 Taner Sener
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#include "Slideshow.h"
+#include "CommandTemplate.h"
+#include "SessionRouter.h"
+#include "Video.h"
+#include <FFmpegKit.h>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <fstream>
+#include <memory>
+#include <mutex>
+#include <sstream>
+#include <sys/stat.h>
+#include <thread>
+
+using namespace ffmpegkit;
+
+namespace ffmpegkittest {
+
+    static const double DefaultImageDuration = 2;
+
+    static std::string formatSeconds(const double seconds) {
+        std::ostringstream stream;
+        stream << seconds;
+        return stream.str();
+    }
+
+    static long getElapsedTime(const std::chrono::steady_clock::time_point start) {
+        return (long)std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::steady_clock::now() - start).count();
+    }
+
+    static std::string getListFile(const std::string& segmentDirectory) {
+        return segmentDirectory + "/segments.txt";
+    }
+
+}
+
+std::string ffmpegkittest::Slideshow::generateConcatList(const std::vector<SlideshowSegment>& segments) {
+    std::string list;
+
+    for (const SlideshowSegment& segment : segments) {
+
+        // A QUOTE INSIDE A QUOTED CONCAT PATH IS CLOSED, ESCAPED AND REOPENED
+        std::string file;
+        for (const char c : segment.file) {
+            if (c == '\'') {
+                file += "'\\''";
+            } else {
+                file += c;
+            }
+        }
+        list += "file '" + file + "'\n";
+    }
+
+    return list;
+}
+
+std::list<std::string> ffmpegkittest::Slideshow::generateConcatArguments(const std::string& listFilePath, const std::string& videoFilePath) {
+    static const CommandTemplate concatTemplate("-hide_banner -y -f concat -safe 0 -i {list} -c copy {video}");
+
+    return concatTemplate.bind({
+        {"list", listFilePath},
+        {"video", videoFilePath}
+    });
+}
+
+ffmpegkittest::Slideshow::Slideshow(const std::vector<std::string>& images, const std::vector<double>& durations, const SlideshowTransition transition, const double transitionDuration, const std::string& segmentDirectory, const int logConsumerId) :
+    images(images),
+    durations(durations),
+    transition(transition),
+    transitionDuration(transitionDuration),
+    segmentDirectory(segmentDirectory),
+    logConsumerId(logConsumerId),
+    concatSessionId(0),
+    segmentScheduler(1, [](const long sessionId) {
+        FFmpegKit::cancel(sessionId);
+    }, &ThreadBudget::getInstance()) {
+}
+
+std::vector<ffmpegkittest::SlideshowSegment> ffmpegkittest::Slideshow::generateSegments(const std::string& extension, const std::string& videoCodec, const std::string& pixelFormat, const std::string& customOptions) const {
+    static const CommandTemplate holdTemplate("-hide_banner -y -i {image} -filter_complex {graph} -map [video] -fps_mode cfr {options...} -flags +cgop -c:v {codec} -r {rate} -frames:v {frames} {segment}");
+    static const CommandTemplate transitionTemplate("-hide_banner -y -i {image} -i {next} -filter_complex {graph} -map [video] -fps_mode cfr {options...} -flags +cgop -c:v {codec} -r {rate} -frames:v {frames} {segment}");
+    std::vector<SlideshowSegment> segments;
+
+    // SEGMENTS START WITH A KEY FRAME AND NEVER REFERENCE EACH OTHER, SO THEIR PACKETS CAN BE COPIED INTO ONE FILE
+    const std::string rate = std::to_string(FrameRate);
+    const std::string outputFilters = "scale=w=640:h=424,format=" + pixelFormat;
+    const std::string transitionTrim = "trim=duration=" + formatSeconds(transitionDuration);
+
+    for (size_t i = 0; i < images.size(); i++) {
+        const double duration = (i < durations.size()) ? durations[i] : DefaultImageDuration;
+        const std::string imageTrim = "trim=duration=" + formatSeconds(duration);
+
+        const std::string holdGraph = FilterGraph::cached("slideshow hold\n" + imageTrim + "\n" + outputFilters, [&imageTrim, &pixelFormat, &outputFilters](FilterGraph& graph) {
+            graph.output(graph.chain(Video::addStillImage(graph, 0, true, pixelFormat), imageTrim + "," + outputFilters), "video");
+        });
+
+        char file[32];
+        snprintf(file, sizeof(file), "/segment-%05d", (int)segments.size());
+        const int frameCount = (int)std::lround(duration * FrameRate);
+        segments.push_back(SlideshowSegment{
+            "image " + std::to_string(i + 1),
+            holdTemplate.bind({
+                {"image", images[i]},
+                {"graph", holdGraph},
+                {"options", customOptions},
+                {"codec", videoCodec},
+                {"rate", rate},
+                {"frames", std::to_string(frameCount)},
+                {"segment", segmentDirectory + file + extension}
+            }),
+            segmentDirectory + file + extension,
+            duration,
+            frameCount});
+
+        if (transition == TransitionCut || i + 1 == images.size()) {
+            continue;
+        }
+
+        const std::string transitionGraph = FilterGraph::cached("slideshow transition\n" + std::to_string(transition) + "\n" + transitionTrim + "\n" + outputFilters, [this, &transitionTrim, &pixelFormat, &outputFilters](FilterGraph& graph) {
+            auto next = graph.chain(Video::addStillImage(graph, 1, true, pixelFormat), transitionTrim);
+            auto previous = graph.chain(Video::addStillImage(graph, 0, true, pixelFormat), transitionTrim);
+            graph.output(graph.chain(Video::addWipeTransition(graph, next, previous, transitionDuration, transition, pixelFormat), outputFilters), "video");
+        });
+
+        snprintf(file, sizeof(file), "/segment-%05d", (int)segments.size());
+        const int transitionFrameCount = (int)std::lround(transitionDuration * FrameRate);
+        segments.push_back(SlideshowSegment{
+            "transition " + std::to_string(i + 1) + "-" + std::to_string(i + 2),
+            transitionTemplate.bind({
+                {"image", images[i]},
+                {"next", images[i + 1]},
+                {"graph", transitionGraph},
+                {"options", customOptions},
+                {"codec", videoCodec},
+                {"rate", rate},
+                {"frames", std::to_string(transitionFrameCount)},
+                {"segment", segmentDirectory + file + extension}
+            }),
+            segmentDirectory + file + extension,
+            transitionDuration,
+            transitionFrameCount});
+    }
+
+    return segments;
+}
+
+double ffmpegkittest::Slideshow::getDuration() const {
+    double duration = 0;
+
+    for (size_t i = 0; i < images.size(); i++) {
+        duration += (i < durations.size()) ? durations[i] : DefaultImageDuration;
+    }
+    if (transition != TransitionCut && images.size() > 1) {
+        duration += transitionDuration * (images.size() - 1);
+    }
+
+    return duration;
+}
+
+int ffmpegkittest::Slideshow::encode(const std::string& videoFilePath, const std::string& videoCodec, const std::string& pixelFormat, const std::string& customOptions, const int maxWorkers, const EncodeCallback& callback) {
+    const auto start = std::chrono::steady_clock::now();
+    const size_t dot = videoFilePath.rfind('.');
+    const std::string extension = (dot == std::string::npos) ? "" : videoFilePath.substr(dot);
+    auto encode = std::make_shared<Encode>();
+    encode->segments = generateSegments(extension, videoCodec, pixelFormat, customOptions);
+    encode->videoFilePath = videoFilePath;
+    encode->start = start;
+    encode->callback = callback;
+    encode->remaining = encode->segments.size();
+    encode->failed = false;
+    encode->concatenating = false;
+    encode->cancelled = false;
+
+    if (encode->segments.empty()) {
+        callback(false, 0);
+        return 0;
+    }
+
+    mkdir(segmentDirectory.c_str(), 0700);
+    {
+        std::lock_guard<std::mutex> lock(encodeMutex);
+        currentEncode = encode;
+    }
+
+    segmentScheduler.setMaxRunningJobs(maxWorkers);
+    for (const SlideshowSegment& segment : encode->segments) {
+        segmentScheduler.submitFFmpeg(segment.arguments, [this, encode](auto session) {
+            bool completed;
+            bool failed;
+            {
+                std::lock_guard<std::mutex> lock(encode->mutex);
+
+                // A CANCELLED ENCODE IS FINISHED BY CANCEL
+                if (encode->cancelled) {
+                    return;
+                }
+                encode->failed = encode->failed || !ReturnCode::isSuccess(session->getReturnCode());
+                completed = (--encode->remaining == 0);
+                failed = encode->failed;
+                encode->concatenating = completed && !failed;
+            }
+            if (!completed) {
+                return;
+            }
+
+            if (failed) {
+                finish(encode, false);
+            } else {
+                concatenate(encode);
+            }
+        }, JobScheduler::PriorityNormal, logConsumerId);
+    }
+
+    return (int)encode->segments.size();
+}
+
+void ffmpegkittest::Slideshow::cancel() {
+    std::shared_ptr<Encode> encode;
+    {
+        std::lock_guard<std::mutex> lock(encodeMutex);
+        encode = currentEncode;
+    }
+
+    bool concatenating = false;
+    if (encode != nullptr) {
+        std::lock_guard<std::mutex> lock(encode->mutex);
+        if (encode->cancelled) {
+            encode = nullptr;
+        } else {
+            encode->cancelled = true;
+            concatenating = encode->concatenating;
+        }
+    }
+
+    // QUEUED SEGMENTS ARE DROPPED WITHOUT A CALLBACK, RUNNING ONES END WITH A CANCEL RETURN CODE
+    segmentScheduler.cancelAll();
+
+    const long sessionId = concatSessionId.exchange(0);
+    if (sessionId != 0) {
+        FFmpegKit::cancel(sessionId);
+    }
+
+    // THE CONCAT SESSION FINISHES ITS OWN ENCODE. OTHERWISE THE SEGMENTS ARE REMOVED ONCE NO SEGMENT SESSION CAN WRITE THEM
+    if (encode != nullptr && !concatenating) {
+        std::thread([this, encode]() {
+            segmentScheduler.waitUntilIdle();
+            finish(encode, false);
+        }).detach();
+    }
+}
+
+void ffmpegkittest::Slideshow::concatenate(const std::shared_ptr<Encode>& encode) {
+    const std::string listFile = getListFile(segmentDirectory);
+    {
+        std::ofstream list(listFile, std::ios::trunc);
+        list << generateConcatList(encode->segments);
+    }
+
+    auto session = SessionRouter::getInstance().executeAsync(generateConcatArguments(listFile, encode->videoFilePath), [this, encode](auto session) {
+        concatSessionId = 0;
+        finish(encode, ReturnCode::isSuccess(session->getReturnCode()));
+    }, logConsumerId);
+    concatSessionId = session->getSessionId();
+
+    // A CANCEL THAT CAME BEFORE THE SESSION ID WAS KNOWN COULD NOT REACH THE SESSION
+    std::lock_guard<std::mutex> lock(encode->mutex);
+    if (encode->cancelled && concatSessionId.exchange(0) != 0) {
+        FFmpegKit::cancel(session->getSessionId());
+    }
+}
+
+void ffmpegkittest::Slideshow::finish(const std::shared_ptr<Encode>& encode, const bool succeeded) {
+    {
+        std::lock_guard<std::mutex> lock(encodeMutex);
+        if (currentEncode == encode) {
+            currentEncode.reset();
+        }
+    }
+
+    for (const SlideshowSegment& segment : encode->segments) {
+        std::remove(segment.file.c_str());
+    }
+    std::remove(getListFile(segmentDirectory).c_str());
+
+    encode->callback(succeeded, getElapsedTime(encode->start));
+}
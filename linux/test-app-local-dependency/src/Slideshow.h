@@ -0,0 +1,102 @@
+/*
+ * Copyright (c) 2022 Taner Sener
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#ifndef FFMPEG_KIT_TEST_SLIDESHOW_H
+#define FFMPEG_KIT_TEST_SLIDESHOW_H
+
+#include "JobScheduler.h"
+#include "Video.h"
+#include <atomic>
+#include <chrono>
+#include <functional>
+#include <list>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+
+namespace ffmpegkittest {
+
+    struct SlideshowSegment {
+        std::string name;
+        std::list<std::string> arguments;
+        std::string file;
+        double duration;
+        int frameCount;
+    };
+
+    /**
+     * Generates slideshows of any number of images. The timeline is cut at transition
+     * boundaries into segments that depend on one or two images only. Segments are encoded by
+     * parallel sessions with closed GOPs and joined by the concat demuxer without re-encoding.
+     * Segment and concat commands are built as argument lists, so image and segment paths are
+     * never quoted.
+     * Wipe transitions use a generated mask unless the expression wipe is requested. A
+     * cancelled encode calls its callback as failed once its sessions have ended and removes
+     * the segments it produced.
+     */
+    class Slideshow {
+        public:
+            static constexpr const int FrameRate = 30;
+
+            typedef std::function<void(const bool succeeded, const long elapsed)> EncodeCallback;
+
+            static std::string generateConcatList(const std::vector<SlideshowSegment>& segments);
+            static std::list<std::string> generateConcatArguments(const std::string& listFilePath, const std::string& videoFilePath);
+
+            Slideshow(const std::vector<std::string>& images, const std::vector<double>& durations, const SlideshowTransition transition, const double transitionDuration, const std::string& segmentDirectory, const int logConsumerId = 0);
+            std::vector<SlideshowSegment> generateSegments(const std::string& extension, const std::string& videoCodec, const std::string& pixelFormat, const std::string& customOptions) const;
+            double getDuration() const;
+            int encode(const std::string& videoFilePath, const std::string& videoCodec, const std::string& pixelFormat, const std::string& customOptions, const int maxWorkers, const EncodeCallback& callback);
+            void cancel();
+
+        private:
+            struct Encode {
+                std::mutex mutex;
+                std::vector<SlideshowSegment> segments;
+                std::string videoFilePath;
+                std::chrono::steady_clock::time_point start;
+                EncodeCallback callback;
+                size_t remaining;
+                bool failed;
+                bool concatenating;
+                bool cancelled;
+            };
+
+            void concatenate(const std::shared_ptr<Encode>& encode);
+            void finish(const std::shared_ptr<Encode>& encode, const bool succeeded);
+
+            std::vector<std::string> images;
+            std::vector<double> durations;
+            SlideshowTransition transition;
+            double transitionDuration;
+            std::string segmentDirectory;
+            int logConsumerId;
+            std::atomic<long> concatSessionId;
+            std::mutex encodeMutex;
+            std::shared_ptr<Encode> currentEncode;
+            JobScheduler segmentScheduler;
+    };
+
+}
+
+#endif // FFMPEG_KIT_TEST_SLIDESHOW_H
@@ -0,0 +1,127 @@
+/*
+ * Copyright (c) 2022 Taner Sener
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#include "SlideshowTest.h"
+#include "Slideshow.h"
+#include "CommandTemplate.h"
+#include "Video.h"
+#include <algorithm>
+#include <iostream>
+#include <iterator>
+
+using namespace ffmpegkittest;
+
+static std::string getCommand(const SlideshowSegment& segment) {
+    return CommandTemplate::toString(segment.arguments);
+}
+
+static std::string getOptionValue(const std::list<std::string>& arguments, const std::string& option) {
+    auto argument = std::find(arguments.begin(), arguments.end(), option);
+    return (argument == arguments.end() || std::next(argument) == arguments.end()) ? "" : *std::next(argument);
+}
+
+void testSegmentsOfWipeSlideshow() {
+    std::vector<std::string> images;
+    std::vector<double> durations;
+    for (int i = 0; i < 200; i++) {
+        images.push_back("/images/photo " + std::to_string(i) + ".jpg");
+        durations.push_back(i == 0 ? 3 : 2);
+    }
+
+    Slideshow slideshow(images, durations, TransitionWipe, 1, "/cache/segments");
+    const auto segments = slideshow.generateSegments(".mp4", "mpeg4", "yuv420p", "");
+    assert(segments.size() == 399);
+    assert(slideshow.getDuration() == 3 + 199 * 2 + 199 * 1);
+
+    // HOLDS AND TRANSITIONS ALTERNATE, EVERY SEGMENT IS A CLOSED GOP WITH AN EXACT FRAME COUNT
+    int frameCount = 0;
+    for (size_t i = 0; i < segments.size(); i++) {
+        assert(getCommand(segments[i]).find("-flags +cgop") != std::string::npos);
+        assert(getCommand(segments[i]).find("-frames:v " + std::to_string(segments[i].frameCount) + " ") != std::string::npos);
+        frameCount += segments[i].frameCount;
+    }
+    assert(frameCount == (int)(slideshow.getDuration() * Slideshow::FrameRate));
+
+    assert(segments[0].name == "image 1");
+    assert(segments[0].frameCount == 90);
+    assert(segments[0].file == "/cache/segments/segment-00000.mp4");
+    assert(segments[1].name == "transition 1-2");
+    assert(segments[1].frameCount == 30);
+    assert(getCommand(segments[1]).find("-i \"/images/photo 0.jpg\" -i \"/images/photo 1.jpg\"") != std::string::npos);
+    assert(getCommand(segments[1]).find("alphamerge") != std::string::npos);
+    assert(getCommand(segments[1]).find("blend=") == std::string::npos);
+    const std::string canvas = std::to_string((int)Video::CanvasWidth) + "x" + std::to_string((int)Video::CanvasHeight);
+    assert(getCommand(segments[1]).find("pad=width=" + std::to_string((int)Video::CanvasWidth) + ":height=" + std::to_string((int)Video::CanvasHeight) + ":") != std::string::npos);
+    assert(getCommand(segments[1]).find("color=white:s=" + canvas + ":") != std::string::npos);
+    assert(segments[398].name == "image 200");
+    assert(getCommand(segments[398]).find("alphamerge") == std::string::npos);
+
+    // SEGMENTS OF THE SAME LENGTH SHARE ONE FILTER GRAPH
+    assert(!getOptionValue(segments[2].arguments, "-filter_complex").empty());
+    assert(getOptionValue(segments[2].arguments, "-filter_complex") == getOptionValue(segments[4].arguments, "-filter_complex"));
+}
+
+void testImagePathsAreSingleArguments() {
+    Slideshow slideshow({"/images/it's \"one\".jpg", "/images/two \"2\".jpg"}, {1}, TransitionWipe, 1, "/cache/my \"segments\"");
+    const auto segments = slideshow.generateSegments(".mp4", "mpeg4", "yuv420p", "");
+
+    // PATHS ARE PASSED AS THEY ARE, QUOTES IN THEM ARE NEVER PARSED
+    const std::list<std::string> inputs{"-i", "/images/it's \"one\".jpg", "-i", "/images/two \"2\".jpg"};
+    assert(std::search(segments[1].arguments.begin(), segments[1].arguments.end(), inputs.begin(), inputs.end()) != segments[1].arguments.end());
+    assert(segments[1].arguments.back() == "/cache/my \"segments\"/segment-00001.mp4");
+    assert(segments[1].arguments.back() == segments[1].file);
+}
+
+void testSegmentsOfCutSlideshow() {
+    Slideshow slideshow({"1.jpg", "2.jpg", "3.jpg"}, {1.5}, TransitionCut, 1, "/tmp");
+    const auto segments = slideshow.generateSegments(".mkv", "libx264", "yuv420p", "-crf 23 ");
+    assert(segments.size() == 3);
+    assert(segments[0].frameCount == 45);
+    assert(segments[1].frameCount == 60);
+    assert(getCommand(segments[2]).find("-crf 23 -flags +cgop -c:v libx264") != std::string::npos);
+    assert(slideshow.getDuration() == 1.5 + 2 + 2);
+}
+
+void testSegmentsOfExpressionWipeSlideshow() {
+    Slideshow slideshow({"1.jpg", "2.jpg"}, {1}, TransitionWipeExpression, 0.5, "/tmp");
+    const auto segments = slideshow.generateSegments(".mp4", "mpeg4", "yuv420p", "");
+    assert(segments.size() == 3);
+    assert(segments[1].frameCount == 15);
+    assert(getCommand(segments[1]).find(Video::generateWipeFilter(0.5)) != std::string::npos);
+    assert(getCommand(segments[1]).find("alphamerge") == std::string::npos);
+}
+
+void testConcatList() {
+    std::vector<SlideshowSegment> segments{{"image 1", {}, "/cache/a.mp4", 1, 30}, {"image 2", {}, "/cache/it's.mp4", 1, 30}};
+    assert(Slideshow::generateConcatList(segments) == "file '/cache/a.mp4'\nfile '/cache/it'\\''s.mp4'\n");
+    const std::list<std::string> expected{"-hide_banner", "-y", "-f", "concat", "-safe", "0", "-i", "/cache/my \"list\".txt", "-c", "copy", "/cache/video.mp4"};
+    assert(Slideshow::generateConcatArguments("/cache/my \"list\".txt", "/cache/video.mp4") == expected);
+}
+
+void testSlideshow(void) {
+    testSegmentsOfWipeSlideshow();
+    testSegmentsOfCutSlideshow();
+    testSegmentsOfExpressionWipeSlideshow();
+    testImagePathsAreSingleArguments();
+    testConcatList();
+    std::cout << "SlideshowTest passed." << std::endl;
+}
@@ -0,0 +1,102 @@
+/*
+ * Copyright (c) 2022 Taner Sener
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#include "StatisticsAggregator.h"
+#include <algorithm>
+
+ffmpegkittest::StatisticsAggregator::StatisticsAggregator() {
+    reset(0);
+}
+
+void ffmpegkittest::StatisticsAggregator::reset(const long sessionId) {
+    std::lock_guard<std::mutex> lock(mutex);
+
+    current = StatisticsSnapshot{};
+    current.sessionId = sessionId;
+    fpsCount = 0;
+    fpsSum = 0;
+    bitrateCount = 0;
+    bitrateSum = 0;
+    speedCount = 0;
+    speedSum = 0;
+    sampledCount = 0;
+}
+
+void ffmpegkittest::StatisticsAggregator::add(const ffmpegkit::Statistics& statistics) {
+    std::lock_guard<std::mutex> lock(mutex);
+
+    // A LATE SAMPLE OF A PREVIOUS SESSION MUST NOT LEAK INTO THE CURRENT ONE
+    if (statistics.getSessionId() != current.sessionId) {
+        return;
+    }
+
+    current.sampleCount++;
+    current.videoFrameNumber = statistics.getVideoFrameNumber();
+    current.videoFps = statistics.getVideoFps();
+    current.videoQuality = statistics.getVideoQuality();
+    current.size = statistics.getSize();
+    current.time = statistics.getTime();
+    current.bitrate = statistics.getBitrate();
+    current.speed = statistics.getSpeed();
+
+    // VALUES ARE NOT AVAILABLE FOR THE FIRST FEW SAMPLES, THEY DO NOT TAKE PART IN AGGREGATES
+    if (current.videoFps > 0) {
+        current.minVideoFps = (fpsCount == 0) ? current.videoFps : std::min(current.minVideoFps, current.videoFps);
+        current.maxVideoFps = std::max(current.maxVideoFps, current.videoFps);
+        fpsSum += current.videoFps;
+        fpsCount++;
+        current.averageVideoFps = fpsSum / fpsCount;
+    }
+    if (current.bitrate > 0) {
+        current.minBitrate = (bitrateCount == 0) ? current.bitrate : std::min(current.minBitrate, current.bitrate);
+        current.maxBitrate = std::max(current.maxBitrate, current.bitrate);
+        bitrateSum += current.bitrate;
+        bitrateCount++;
+        current.averageBitrate = bitrateSum / bitrateCount;
+    }
+    if (current.speed > 0) {
+        current.minSpeed = (speedCount == 0) ? current.speed : std::min(current.minSpeed, current.speed);
+        current.maxSpeed = std::max(current.maxSpeed, current.speed);
+        speedSum += current.speed;
+        speedCount++;
+        current.averageSpeed = speedSum / speedCount;
+    }
+}
+
+bool ffmpegkittest::StatisticsAggregator::sample(StatisticsSnapshot& snapshot) {
+    std::lock_guard<std::mutex> lock(mutex);
+
+    if (current.sampleCount == sampledCount) {
+        return false;
+    }
+
+    sampledCount = current.sampleCount;
+    snapshot = current;
+    return true;
+}
+
+bool ffmpegkittest::StatisticsAggregator::peek(StatisticsSnapshot& snapshot) {
+    std::lock_guard<std::mutex> lock(mutex);
+
+    snapshot = current;
+    return current.sampleCount > 0;
+}
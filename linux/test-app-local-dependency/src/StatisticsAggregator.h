@@ -0,0 +1,78 @@
+/*
+ * Copyright (c) 2022 Taner Sener
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#ifndef FFMPEG_KIT_TEST_STATISTICS_AGGREGATOR_H
+#define FFMPEG_KIT_TEST_STATISTICS_AGGREGATOR_H
+
+#include <Statistics.h>
+#include <mutex>
+
+namespace ffmpegkittest {
+
+    struct StatisticsSnapshot {
+        long sessionId;
+        long sampleCount;
+        int videoFrameNumber;
+        float videoFps;
+        float minVideoFps;
+        float averageVideoFps;
+        float maxVideoFps;
+        float videoQuality;
+        int64_t size;
+        double time;
+        double bitrate;
+        double minBitrate;
+        double averageBitrate;
+        double maxBitrate;
+        double speed;
+        double minSpeed;
+        double averageSpeed;
+        double maxSpeed;
+    };
+
+    /**
+     * Keeps the latest statistics of a session together with running aggregates. Writers
+     * overwrite the previous sample; readers decide how often to look at it.
+     */
+    class StatisticsAggregator {
+        public:
+            StatisticsAggregator();
+            void reset(const long sessionId);
+            void add(const ffmpegkit::Statistics& statistics);
+            bool sample(StatisticsSnapshot& snapshot);
+            bool peek(StatisticsSnapshot& snapshot);
+
+        private:
+            std::mutex mutex;
+            StatisticsSnapshot current;
+            long fpsCount;
+            double fpsSum;
+            long bitrateCount;
+            double bitrateSum;
+            long speedCount;
+            double speedSum;
+            long sampledCount;
+    };
+
+}
+
+#endif // FFMPEG_KIT_TEST_STATISTICS_AGGREGATOR_H
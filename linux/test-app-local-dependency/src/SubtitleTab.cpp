@@ -22,13 +22,18 @@
 
 #include "SubtitleTab.h"
 #include "Application.h"
+#include "CommandTemplate.h"
 #include "Constants.h"
 #include "Log.h"
+#include "LogSink.h"
+#include "Pipeline.h"
 #include "Popup.h"
-#include "Statistics.h"
+#include "ProgressEstimator.h"
+#include "SessionRouter.h"
 #include "Video.h"
 #include <FFmpegKit.h>
 #include <FFmpegKitConfig.h>
+#include <thread>
 
 using namespace ffmpegkit;
 
@@ -40,8 +45,6 @@ enum State {
 
 static State state = StateIdle;
 
-static long sessionId = -1;
-
 static gboolean showBurningCancelledPopup(const std::pair<Gtk::Window*,const std::string>* parameters) {
     Gtk::Window* window = parameters->first;
     auto messageDetail = parameters->second;
@@ -58,23 +61,7 @@ static gboolean showBurningFailedPopup(const std::pair<Gtk::Window*,const std::s
     return FALSE;
 }
 
-static gboolean saveStatistics(const std::pair<ffmpegkittest::SubtitleTab*,const std::shared_ptr<Statistics>>* parameters) {
-    ffmpegkittest::SubtitleTab* subtitleTab = parameters->first;
-    auto statistics = parameters->second;
-    subtitleTab->updateProgressDialog(statistics);
-    delete parameters;
-    return FALSE;
-}
-
-static gboolean appendLog(const std::pair<ffmpegkittest::SubtitleTab*,const std::shared_ptr<Log>>* parameters) {
-    ffmpegkittest::SubtitleTab* videoTab = parameters->first;
-    auto log = parameters->second;
-    videoTab->appendOutput(log->getMessage());
-    delete parameters;
-    return FALSE;
-}
-
-ffmpegkittest::SubtitleTab::SubtitleTab() : statistics(nullptr) {
+ffmpegkittest::SubtitleTab::SubtitleTab() : outputView("subtitle"), statistics() {
     encodeButton.set_label("BURN SUBTITLES");
     encodeButton.set_size_request(120, 30);
     encodeButton.set_tooltip_text(Constants::SubtitleTestEncodeTooltipText);
@@ -87,25 +74,29 @@ ffmpegkittest::SubtitleTab::SubtitleTab() : statistics(nullptr) {
     Util::applyButtonStyle(cancelButton);
     buttonBox.pack_start(encodeButton, Gtk::PACK_EXPAND_PADDING);
     buttonBox.pack_start(cancelButton, Gtk::PACK_EXPAND_PADDING);
-
-    outputText.set_editable(false);
-    Util::applyOutputTextStyle(outputText);
-    outputTextWindow.add(outputText);
+    benchmarkButton.set_label("BENCHMARK");
+    benchmarkButton.set_size_request(120, 30);
+    benchmarkButton.set_tooltip_text(Constants::SubtitleTestEncodeTooltipText);
+    benchmarkButton.signal_clicked().connect(sigc::mem_fun(*this, &SubtitleTab::runBenchmark));
+    Util::applyButtonStyle(benchmarkButton);
+    buttonBox.pack_start(benchmarkButton, Gtk::PACK_EXPAND_PADDING);
+    benchmarkRunning = false;
+
+    logConsumerId = LogSink::getInstance().registerConsumer([this](const std::string& batch) {
+        appendOutput(batch);
+    });
+    statisticsConsumerId = SessionRouter::getInstance().registerStatisticsConsumer([this](const StatisticsSnapshot& statistics) {
+        updateProgressDialog(statistics);
+    });
 
     pack_start(buttonBox, Gtk::PACK_SHRINK);
-    add(outputTextWindow);
+    add(outputView);
 
     state = StateIdle;
 }
 
 void ffmpegkittest::SubtitleTab::setActive() {
     std::cout << "Subtitle Tab Activated" << std::endl;
-    FFmpegKitConfig::enableLogCallback([this](auto log) {
-        g_idle_add((GSourceFunc)appendLog, new std::pair<SubtitleTab*,const std::shared_ptr<Log>>(this, log));
-    });
-    FFmpegKitConfig::enableStatisticsCallback([this](auto statistics) {
-        g_idle_add((GSourceFunc)saveStatistics, new std::pair<SubtitleTab*,const std::shared_ptr<Statistics>>(this, statistics));
-    });
 }
 
 void ffmpegkittest::SubtitleTab::setParentWindow(Gtk::Window* parentWindow) {
@@ -113,91 +104,144 @@ void ffmpegkittest::SubtitleTab::setParentWindow(Gtk::Window* parentWindow) {
 }
 
 void ffmpegkittest::SubtitleTab::appendOutput(const std::string& string) {
-    outputText.get_buffer()->set_text(outputText.get_buffer()->get_text() + string);
-    Glib::RefPtr<Gtk::Adjustment> adj = outputText.get_vadjustment();
-    adj->set_value(adj->get_upper());
+    outputView.append(string);
 }
 
-void ffmpegkittest::SubtitleTab::updateProgressDialog(const std::shared_ptr<ffmpegkit::Statistics> statistics) {
-    if (statistics == nullptr || statistics->getTime() < 0) {
+void ffmpegkittest::SubtitleTab::updateProgressDialog(const StatisticsSnapshot& statistics) {
+    if (statistics.time < 0) {
         return;
     }
 
     this->statistics = statistics;
-    double timeInMilliseconds = this->statistics->getTime();
-    int totalVideoDuration = 9000;
-    double completePercentage = timeInMilliseconds*100/totalVideoDuration;
-    // progressDialog.update(completePercentage);
+    auto progress = ProgressEstimator::getInstance().update(statistics);
+    // progressDialog.update(progress.percentage);
     if (state == StateCreating) {
-        std::cout << "Creating video: " << completePercentage << "%" << std::endl;
+        std::cout << "Creating video: " << ProgressEstimator::format(progress) << std::endl;
     } else if (state == StateBurning) {
-        std::cout << "Burning subtitles: " << completePercentage << "%" << std::endl;
+        std::cout << "Burning subtitles: " << ProgressEstimator::format(progress) << std::endl;
     }
 }
 
 void ffmpegkittest::SubtitleTab::clearOutput() {
-    outputText.get_buffer()->set_text("");
+    outputView.clear();
 }
 
 void ffmpegkittest::SubtitleTab::burnSubtitles() {
     clearOutput();
 
-    std::string image1File = Application::getApplicationInstallDirectory() + "/share/images/machupicchu.jpg";
-    std::string image2File = Application::getApplicationInstallDirectory() + "/share/images/pyramid.jpg";
-    std::string image3File = Application::getApplicationInstallDirectory() + "/share/images/stonehenge.jpg";
-    std::string videoFile = getVideoFile();
-    std::string videoWithSubtitlesFile = getVideoWithSubtitlesFile();
-
     std::cout << "Testing SUBTITLE burning." << std::endl;
 
     showCreateProgressDialog();
 
-    std::string ffmpegCommand = Video::generateEncodeVideoScript(image1File, image2File, image3File, videoFile, "mpeg4", "");
+    auto burnPipeline = createBurnPipeline(true);
+    Pipeline* pipeline = burnPipeline.get();
+    burnPipeline->start([this, pipeline](const bool succeeded) {
+        std::cout << pipeline->describeTimings();
+
+        hideBurnProgressDialog();
+        state = StateIdle;
+
+        bool cancelled = false;
+        for (const PipelineNode& node : pipeline->getNodes()) {
+            cancelled = cancelled || (node.state == NodeCancelled);
+        }
 
-    std::cout << "FFmpeg process started with arguments: '" << ffmpegCommand << "'." << std::endl;
+        if (succeeded) {
+            std::cout << "Burn subtitles completed successfully." << std::endl;
+        } else if (cancelled) {
+            g_idle_add((GSourceFunc)showBurningCancelledPopup, new std::pair<Gtk::Window*,const std::string>(this->parentWindow, "Burn subtitles operation cancelled."));
+            std::cout << "Burn subtitles operation cancelled." << std::endl;
+        } else {
+            g_idle_add((GSourceFunc)showBurningFailedPopup, new std::pair<Gtk::Window*,const std::string>(this->parentWindow, "Burn subtitles failed. Please check logs for the details."));
+            std::cout << "Burn subtitles failed." << std::endl;
+        }
+    });
 
-    state = StateCreating;
+    this->pipeline = burnPipeline;
+}
 
-    sessionId = FFmpegKit::executeAsync(ffmpegCommand, [this, videoFile, videoWithSubtitlesFile](auto session) {
-        std::cout << "FFmpeg process exited with state " << FFmpegKitConfig::sessionStateToString(session->getState()) << " and rc " << session->getReturnCode() << "." << session->getFailStackTrace() << std::endl;
+void ffmpegkittest::SubtitleTab::runBenchmark() {
+    if (benchmarkRunning.exchange(true)) {
+        std::cout << "Subtitle benchmark is already running." << std::endl;
+        return;
+    }
 
-        this->hideCreateProgressDialog();
+    clearOutput();
 
-        if (ReturnCode::isSuccess(session->getReturnCode())) {
-            std::cout << "Create completed successfully; burning subtitles." << std::endl;
+    std::cout << "Testing SUBTITLE burning in one and two passes." << std::endl;
 
-            std::string burnSubtitlesCommand = "-y -i " + videoFile + " -vf subtitles=" + getSubtitleFile() + ":force_style='FontName=MyFontName' -c:v mpeg4 " + videoWithSubtitlesFile;
+    // WAITING FOR EACH PIPELINE BLOCKS, SO THEY RUN OUTSIDE THE MAIN LOOP
+    std::thread([this]() {
+        auto twoPass = createBurnPipeline(false);
+        twoPass->start(nullptr);
+        twoPass->waitUntilFinished();
 
-            this->showBurnProgressDialog();
+        auto onePass = createBurnPipeline(true);
+        onePass->start(nullptr);
+        onePass->waitUntilFinished();
 
-            std::cout << "FFmpeg process started with arguments: '" << burnSubtitlesCommand << "'." << std::endl;
+        const long twoPassTime = twoPass->getElapsedTime();
+        const long onePassTime = onePass->getElapsedTime();
+        std::cout << "Burn subtitles took " << twoPassTime << " ms in two passes" << (twoPass->isSucceeded() ? "" : " (failed)") << " and " << onePassTime << " ms in one pass" << (onePass->isSucceeded() ? "" : " (failed)") << ", " << (onePassTime > 0 ? (double)twoPassTime / onePassTime : 0) << "x speedup." << std::endl;
 
-            state = StateBurning;
+        state = StateIdle;
+        benchmarkRunning = false;
+    }).detach();
+}
 
-            FFmpegKit::executeAsync(burnSubtitlesCommand, [this](auto secondSession) {
+std::shared_ptr<ffmpegkittest::Pipeline> ffmpegkittest::SubtitleTab::createBurnPipeline(const bool onePass) {
+    std::string image1File = Application::getApplicationInstallDirectory() + "/share/images/machupicchu.jpg";
+    std::string image2File = Application::getApplicationInstallDirectory() + "/share/images/pyramid.jpg";
+    std::string image3File = Application::getApplicationInstallDirectory() + "/share/images/stonehenge.jpg";
+    std::string videoFile = getVideoFile();
+    std::string videoWithSubtitlesFile = getVideoWithSubtitlesFile();
 
-                hideBurnProgressDialog();
+    auto pipeline = Pipeline::create(logConsumerId, statisticsConsumerId);
+    int create = -1;
+    int burn;
+
+    // THE SLIDESHOW IS GENERATED HERE, SO SUBTITLES CAN BE DRAWN BEFORE ITS ONLY ENCODE
+    if (onePass) {
+        burn = pipeline->addNode("create with subtitles", Video::generateEncodeVideoArguments(image1File, image2File, image3File, videoWithSubtitlesFile, "mpeg4", "yuv420p", "", Video::generateSubtitlesFilter(getSubtitleFile(), "FontName=MyFontName")));
+    } else {
+        create = pipeline->addNode("create", Video::generateEncodeVideoArguments(image1File, image2File, image3File, videoFile, "mpeg4", "yuv420p", "", ""));
+        burn = pipeline->addNode("burn subtitles", generateBurnSubtitlesArguments(videoFile, videoWithSubtitlesFile));
+        pipeline->addFileEdge(create, burn, videoFile);
+    }
 
-                if (ReturnCode::isSuccess(secondSession->getReturnCode())) {
-                    std::cout << "Burn subtitles completed successfully." << std::endl;
-                } else if (ReturnCode::isCancel(secondSession->getReturnCode())) {
-                    g_idle_add((GSourceFunc)showBurningCancelledPopup, new std::pair<Gtk::Window*,const std::string>(this->parentWindow, "Burn subtitles operation cancelled."));
-                    std::cout << "Burn subtitles operation cancelled." << std::endl;
-                } else {
-                    g_idle_add((GSourceFunc)showBurningFailedPopup, new std::pair<Gtk::Window*,const std::string>(this->parentWindow, "Burn subtitles failed. Please check logs for the details."));
-                    std::cout << "Burn subtitles failed with state " << FFmpegKitConfig::sessionStateToString(secondSession->getState()) << " and rc " << secondSession->getReturnCode() << "." << secondSession->getFailStackTrace() << std::endl;
-                }
-            });
+    pipeline->setNodeListener([this, create, burn](const PipelineNode& node) {
+        if (node.state == NodeRunning) {
+            state = (node.id == create) ? StateCreating : StateBurning;
+            ProgressEstimator::getInstance().expectDuration(node.sessionId, Video::getEncodeVideoDuration());
+            if (node.id == burn) {
+                this->hideCreateProgressDialog();
+                this->showBurnProgressDialog();
+            }
+        } else if (node.id == create && node.state == NodeSucceeded) {
+            std::cout << "Create completed successfully; burning subtitles." << std::endl;
         }
-    })->getSessionId();
+    });
 
-    std::cout << "Async FFmpeg process started with sessionId " << sessionId << "." << std::endl;
+    return pipeline;
+}
+
+std::list<std::string> ffmpegkittest::SubtitleTab::generateBurnSubtitlesArguments(const std::string& inputVideoFile, const std::string& outputVideoFile) {
+    static const CommandTemplate burnTemplate("-y -i {input} -vf {filter} -c:v mpeg4 {output}");
+
+    // VIDEOS THAT ARE NOT GENERATED HERE STILL NEED A DECODE AND A SECOND ENCODE
+    return burnTemplate.bind({
+        {"input", inputVideoFile},
+        {"filter", Video::generateSubtitlesFilter(getSubtitleFile(), "FontName=MyFontName")},
+        {"output", outputVideoFile}
+    });
 }
 
 void ffmpegkittest::SubtitleTab::cancel() {
-    if (sessionId > -1) {
-        std::cout << "Cancelling FFmpeg execution with sessionId " << sessionId << "." << std::endl;
-        FFmpegKit::cancel(sessionId);
+
+    // CANCELLING THE PIPELINE ALSO KEEPS STAGES THAT HAVE NOT STARTED YET FROM RUNNING
+    if (pipeline != nullptr) {
+        std::cout << "Cancelling subtitle pipeline." << std::endl;
+        pipeline->cancel();
     }
 }
 
@@ -23,9 +23,12 @@
 #ifndef FFMPEG_KIT_TEST_SUBTITLE_TAB_H
 #define FFMPEG_KIT_TEST_SUBTITLE_TAB_H
 
+#include "OutputView.h"
+#include "Pipeline.h"
 #include "ProgressDialog.h"
-#include "Statistics.h"
+#include "StatisticsAggregator.h"
 #include "Util.h"
+#include <atomic>
 #include <gtkmm.h>
 
 namespace ffmpegkittest {
@@ -36,12 +39,15 @@ namespace ffmpegkittest {
             void setActive();
             void setParentWindow(Gtk::Window* parentWindow);
             void appendOutput(const std::string& string);
-            void updateProgressDialog(const std::shared_ptr<ffmpegkit::Statistics> statistics);
+            void updateProgressDialog(const StatisticsSnapshot& statistics);
 
         private:
             void clearOutput();
             void burnSubtitles();
             void cancel();
+            void runBenchmark();
+            std::shared_ptr<Pipeline> createBurnPipeline(const bool onePass);
+            std::list<std::string> generateBurnSubtitlesArguments(const std::string& inputVideoFile, const std::string& outputVideoFile);
             std::string getSubtitleFile();
             std::string getVideoFile();
             std::string getVideoWithSubtitlesFile();
@@ -52,12 +58,16 @@ namespace ffmpegkittest {
 
             Gtk::Button encodeButton;
             Gtk::Button cancelButton;
+            Gtk::Button benchmarkButton;
             Gtk::HBox buttonBox;
-            Gtk::TextView outputText;
-            Gtk::ScrolledWindow outputTextWindow;
+            OutputView outputView;
             ffmpegkittest::ProgressDialog progressDialog;
             Gtk::Window* parentWindow;
-            std::shared_ptr<ffmpegkit::Statistics> statistics;
+            int logConsumerId;
+            int statisticsConsumerId;
+            StatisticsSnapshot statistics;
+            std::shared_ptr<Pipeline> pipeline;
+            std::atomic<bool> benchmarkRunning;
     };
 
 }
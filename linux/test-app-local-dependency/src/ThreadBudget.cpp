@@ -0,0 +1,194 @@
+/*
+ * Copyright (c) 2022 Taner Sener
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#include "ThreadBudget.h"
+#include "JobScheduler.h"
+#include <algorithm>
+#include <iterator>
+
+static bool containsOption(const std::string& command, const std::string& option) {
+    size_t position = command.find(option);
+    while (position != std::string::npos) {
+        const size_t end = position + option.size();
+        if ((position == 0 || command[position - 1] == ' ') && (end == command.size() || command[end] == ' ')) {
+            return true;
+        }
+        position = command.find(option, end);
+    }
+    return false;
+}
+
+static bool containsOption(const std::list<std::string>& arguments, const std::string& option) {
+    return std::find(arguments.begin(), arguments.end(), option) != arguments.end();
+}
+
+static bool isVideoCodecOption(const std::string& argument) {
+    return argument == "-c:v" || argument == "-vcodec" || argument == "-codec:v";
+}
+
+ffmpegkittest::ThreadBudget& ffmpegkittest::ThreadBudget::getInstance() {
+    static ThreadBudget instance(JobScheduler::getPhysicalCoreCount());
+    return instance;
+}
+
+std::string ffmpegkittest::ThreadBudget::apply(const std::string& command, const int threads) {
+    const std::string count = std::to_string(std::max(1, threads));
+    const bool hasThreads = containsOption(command, "-threads");
+    std::string budgeted;
+    budgeted.reserve(command.size() + 128);
+
+    // FILTER THREAD OPTIONS ARE GLOBAL, THEY CAN PRECEDE EVERYTHING ELSE
+    if (!containsOption(command, "-filter_threads")) {
+        budgeted.append("-filter_threads ").append(count).append(" ");
+    }
+    if (!containsOption(command, "-filter_complex_threads")) {
+        budgeted.append("-filter_complex_threads ").append(count).append(" ");
+    }
+
+    char quote = 0;
+    for (size_t i = 0; i < command.size(); i++) {
+        const char c = command[i];
+        if (quote != 0) {
+            if (c == quote) {
+                quote = 0;
+            }
+            budgeted.push_back(c);
+            continue;
+        }
+        if (c == '"' || c == '\'') {
+            quote = c;
+            budgeted.push_back(c);
+            continue;
+        }
+
+        const bool atToken = (i == 0 || command[i - 1] == ' ');
+        const bool videoCodec = atToken && (command.compare(i, 5, "-c:v ") == 0 || command.compare(i, 8, "-vcodec ") == 0 || command.compare(i, 9, "-codec:v ") == 0);
+        if (!videoCodec) {
+            budgeted.push_back(c);
+            continue;
+        }
+
+        // ENCODER OPTIONS ARE PLACED NEXT TO THE CODEC THEY BELONG TO
+        const size_t nameStart = command.find(' ', i) + 1;
+        const size_t nameEnd = std::min(command.find(' ', nameStart), command.size());
+        const std::string codec = command.substr(nameStart, nameEnd - nameStart);
+
+        if (!hasThreads) {
+            budgeted.append("-threads ").append(count).append(" ");
+        }
+        if (codec == "libx265" && !containsOption(command, "-x265-params")) {
+            budgeted.append("-x265-params pools=").append(count).append(" ");
+        } else if (codec == "libkvazaar" && !containsOption(command, "-kvazaar-params")) {
+            budgeted.append("-kvazaar-params threads=").append(count).append(" ");
+        } else if (codec == "libaom-av1" && !containsOption(command, "-row-mt")) {
+            budgeted.append("-row-mt 1 ");
+        }
+        budgeted.push_back(c);
+    }
+
+    return budgeted;
+}
+
+std::list<std::string> ffmpegkittest::ThreadBudget::apply(const std::list<std::string>& arguments, const int threads) {
+    const std::string count = std::to_string(std::max(1, threads));
+    const bool hasThreads = containsOption(arguments, "-threads");
+    std::list<std::string> budgeted;
+
+    // FILTER THREAD OPTIONS ARE GLOBAL, THEY CAN PRECEDE EVERYTHING ELSE
+    if (!containsOption(arguments, "-filter_threads")) {
+        budgeted.insert(budgeted.end(), {"-filter_threads", count});
+    }
+    if (!containsOption(arguments, "-filter_complex_threads")) {
+        budgeted.insert(budgeted.end(), {"-filter_complex_threads", count});
+    }
+
+    // ARGUMENTS ARE ALREADY SPLIT, SO A FILTER GRAPH NEVER LOOKS LIKE AN OPTION
+    for (auto argument = arguments.begin(); argument != arguments.end(); ++argument) {
+        if (isVideoCodecOption(*argument) && std::next(argument) != arguments.end()) {
+            const std::string& codec = *std::next(argument);
+
+            // ENCODER OPTIONS ARE PLACED NEXT TO THE CODEC THEY BELONG TO
+            if (!hasThreads) {
+                budgeted.insert(budgeted.end(), {"-threads", count});
+            }
+            if (codec == "libx265" && !containsOption(arguments, "-x265-params")) {
+                budgeted.insert(budgeted.end(), {"-x265-params", "pools=" + count});
+            } else if (codec == "libkvazaar" && !containsOption(arguments, "-kvazaar-params")) {
+                budgeted.insert(budgeted.end(), {"-kvazaar-params", "threads=" + count});
+            } else if (codec == "libaom-av1" && !containsOption(arguments, "-row-mt")) {
+                budgeted.insert(budgeted.end(), {"-row-mt", "1"});
+            }
+        }
+        budgeted.push_back(*argument);
+    }
+
+    return budgeted;
+}
+
+ffmpegkittest::ThreadBudget::ThreadBudget(const int cores) :
+    cores(std::max(1, cores)),
+    activeSessions(0),
+    allocatedThreads(0),
+    enabled(true) {
+}
+
+int ffmpegkittest::ThreadBudget::acquire(const int expectedSessions) {
+    std::lock_guard<std::mutex> lock(mutex);
+    activeSessions++;
+
+    // AN EVEN SHARE, BUT NEVER MORE THAN THE CORES OTHER SESSIONS LEFT FREE
+    const int share = cores / std::max(activeSessions, expectedSessions);
+    const int threads = std::max(1, std::min(share, cores - allocatedThreads));
+    allocatedThreads += threads;
+    return threads;
+}
+
+void ffmpegkittest::ThreadBudget::release(const int threads) {
+    std::lock_guard<std::mutex> lock(mutex);
+    activeSessions = std::max(0, activeSessions - 1);
+    allocatedThreads = std::max(0, allocatedThreads - threads);
+}
+
+void ffmpegkittest::ThreadBudget::setEnabled(const bool enabled) {
+    std::lock_guard<std::mutex> lock(mutex);
+    this->enabled = enabled;
+}
+
+bool ffmpegkittest::ThreadBudget::isEnabled() {
+    std::lock_guard<std::mutex> lock(mutex);
+    return enabled;
+}
+
+int ffmpegkittest::ThreadBudget::getCores() {
+    std::lock_guard<std::mutex> lock(mutex);
+    return cores;
+}
+
+int ffmpegkittest::ThreadBudget::getActiveSessions() {
+    std::lock_guard<std::mutex> lock(mutex);
+    return activeSessions;
+}
+
+int ffmpegkittest::ThreadBudget::getAllocatedThreads() {
+    std::lock_guard<std::mutex> lock(mutex);
+    return allocatedThreads;
+}
@@ -0,0 +1,67 @@
+/*
+ * Copyright (c) 2022 Taner Sener
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#ifndef FFMPEG_KIT_TEST_THREAD_BUDGET_H
+#define FFMPEG_KIT_TEST_THREAD_BUDGET_H
+
+#include <list>
+#include <mutex>
+#include <string>
+
+namespace ffmpegkittest {
+
+    /**
+     * Splits the physical cores between the FFmpeg sessions that run at the same time.
+     * A running session cannot change its thread count, so budgets rebalance through
+     * the sessions started next: cores returned by finished sessions are handed out again.
+     */
+    class ThreadBudget {
+        public:
+            static ThreadBudget& getInstance();
+
+            /**
+             * Adds explicit thread options for the given budget to a command. Thread options
+             * already present in the command are kept.
+             */
+            static std::string apply(const std::string& command, const int threads);
+            static std::list<std::string> apply(const std::list<std::string>& arguments, const int threads);
+
+            explicit ThreadBudget(const int cores);
+            int acquire(const int expectedSessions = 0);
+            void release(const int threads);
+            void setEnabled(const bool enabled);
+            bool isEnabled();
+            int getCores();
+            int getActiveSessions();
+            int getAllocatedThreads();
+
+        private:
+            std::mutex mutex;
+            int cores;
+            int activeSessions;
+            int allocatedThreads;
+            bool enabled;
+    };
+
+}
+
+#endif // FFMPEG_KIT_TEST_THREAD_BUDGET_H
@@ -0,0 +1,74 @@
+/*
+ * Copyright (c) 2022 Taner Sener
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#include "ThreadBudgetTest.h"
+#include "ThreadBudget.h"
+#include <iostream>
+
+using namespace ffmpegkittest;
+
+void testThreadOptionsAreInjected() {
+    assert(ThreadBudget::apply("-i in.mp4 -c:v libx264 out.mp4", 3) == "-filter_threads 3 -filter_complex_threads 3 -i in.mp4 -threads 3 -c:v libx264 out.mp4");
+    assert(ThreadBudget::apply("-i in.mp4 -vcodec libx265 out.mp4", 2) == "-filter_threads 2 -filter_complex_threads 2 -i in.mp4 -threads 2 -x265-params pools=2 -vcodec libx265 out.mp4");
+    assert(ThreadBudget::apply("-i in.mp4 -c:v libkvazaar out.mp4", 4) == "-filter_threads 4 -filter_complex_threads 4 -i in.mp4 -threads 4 -kvazaar-params threads=4 -c:v libkvazaar out.mp4");
+
+    // EXPLICIT OPTIONS ARE KEPT AND QUOTED FILTER GRAPHS ARE NOT TOUCHED
+    assert(ThreadBudget::apply("-filter_threads 1 -i in.mp4 -threads 8 -c:v mpeg4 out.mp4", 2) == "-filter_complex_threads 2 -filter_threads 1 -i in.mp4 -threads 8 -c:v mpeg4 out.mp4");
+    assert(ThreadBudget::apply("-i in.mp4 -vf \"drawtext=text=' -c:v x'\" -c:v mpeg4 out.mp4", 0) == "-filter_threads 1 -filter_complex_threads 1 -i in.mp4 -vf \"drawtext=text=' -c:v x'\" -threads 1 -c:v mpeg4 out.mp4");
+
+    // ARGUMENT LISTS GET THE SAME OPTIONS, A PATH WITH QUOTES OR SPACES IS ONE ARGUMENT
+    const std::list<std::string> arguments{"-i", "my \"photo\".jpg", "-vf", "drawtext=text=' -c:v x'", "-c:v", "libx265", "out.mp4"};
+    const std::list<std::string> expected{"-filter_threads", "2", "-filter_complex_threads", "2", "-i", "my \"photo\".jpg", "-vf", "drawtext=text=' -c:v x'", "-threads", "2", "-x265-params", "pools=2", "-c:v", "libx265", "out.mp4"};
+    assert(ThreadBudget::apply(arguments, 2) == expected);
+    assert(ThreadBudget::apply(std::list<std::string>{"-threads", "8", "-filter_threads", "1", "-c:v", "mpeg4"}, 2) == (std::list<std::string>{"-filter_complex_threads", "2", "-threads", "8", "-filter_threads", "1", "-c:v", "mpeg4"}));
+}
+
+void testBudgetsRebalance() {
+    ThreadBudget threadBudget(8);
+
+    assert(threadBudget.acquire(4) == 2);
+    assert(threadBudget.acquire(4) == 2);
+
+    // WITHOUT A HINT THE SHARE FOLLOWS THE ACTIVE SESSIONS
+    const int third = threadBudget.acquire();
+    assert(third == 2);
+    assert(threadBudget.getAllocatedThreads() == 6);
+
+    threadBudget.release(2);
+    threadBudget.release(2);
+    assert(threadBudget.getActiveSessions() == 1);
+
+    // FINISHED SESSIONS RETURN THEIR CORES TO THE NEXT ONE
+    assert(threadBudget.acquire() == 4);
+
+    // OVERSUBSCRIBED BY ONE THREAD AT MOST WHEN NOTHING IS FREE
+    ThreadBudget full(2);
+    assert(full.acquire() == 2);
+    assert(full.acquire() == 1);
+}
+
+void testThreadBudget(void) {
+    testThreadOptionsAreInjected();
+    testBudgetsRebalance();
+
+    std::cout << "ThreadBudgetTest passed." << std::endl;
+}
@@ -0,0 +1,106 @@
+/*
+ * Copyright (c) 2022 Taner Sener
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#include "ToneMapLut.h"
+#include "FilterGraph.h"
+#include <FFmpegKit.h>
+#include <cstdio>
+#include <iostream>
+#include <mutex>
+#include <sys/stat.h>
+
+using namespace ffmpegkit;
+
+namespace ffmpegkittest {
+
+    static std::mutex bakeMutex;
+
+    static std::string getScaleMatrix(const std::string& matrix) {
+
+        // SWSCALE HAS ONE NAME FOR BOTH BT.2020 MATRICES AND A SINGLE BT.601 ENTRY
+        if (matrix.compare(0, 6, "bt2020") == 0) {
+            return "bt2020";
+        } else if (matrix == "bt470bg" || matrix == "smpte170m") {
+            return "bt601";
+        } else {
+            return matrix;
+        }
+    }
+
+}
+
+std::string ffmpegkittest::ToneMapLut::generateToneMapFilters(const std::string& transfer, const std::string& primaries, const std::string& matrix) {
+    return "zscale=tin=" + transfer + ":min=" + matrix + ":pin=" + primaries + ":rin=tv:t=" + transfer + ":m=" + matrix + ":p=" + primaries + ":r=tv,zscale=t=linear,tonemap=tonemap=clip,zscale=t=bt709";
+}
+
+std::string ffmpegkittest::ToneMapLut::getLutFile(const std::string& cacheDirectory, const std::string& transfer, const std::string& primaries, const std::string& matrix) {
+    return cacheDirectory + "/tonemap-" + transfer + "-" + primaries + "-" + matrix + "-" + std::to_string(HaldLevel) + ".png";
+}
+
+std::string ffmpegkittest::ToneMapLut::generateBakeScript(const std::string& transfer, const std::string& primaries, const std::string& lutFilePath) {
+
+    // THE IDENTITY CLUT IS GENERATED AT 16 BITS, SO EVERY LATTICE POINT ENTERS THE TRANSFORM AT ITS EXACT POSITION. RGB
+    // INPUT HAS NO MATRIX, IT IS APPLIED BY SWSCALE AROUND THE LOOKUP
+    return "-hide_banner -y -f lavfi -i haldclutsrc=level=" + std::to_string(HaldLevel) + ",format=gbrp16le" +
+            " -vf zscale=tin=" + transfer + ":pin=" + primaries + ":rin=full:t=" + transfer + ":p=" + primaries + ":r=full,zscale=t=linear,tonemap=tonemap=clip,zscale=t=bt709,format=rgb48be" +
+            " -frames:v 1 -update 1 \"" + lutFilePath + "\"";
+}
+
+std::string ffmpegkittest::ToneMapLut::generateApplyFilterGraph(const std::string& matrix) {
+    const std::string scaleMatrix = getScaleMatrix(matrix);
+
+    return FilterGraph::cached("tonemap lut\n" + scaleMatrix, [&scaleMatrix](FilterGraph& graph) {
+        auto rgb = graph.chain(graph.input("0:v"), "scale=in_color_matrix=" + scaleMatrix + ":in_range=tv,format=gbrp16le");
+
+        // THE CLUT IS A SINGLE FRAME, HALDCLUT KEEPS USING IT FOR EVERY FRAME OF THE VIDEO
+        auto clut = graph.chain(graph.input("1:v"), "format=gbrp16le");
+        auto mapped = graph.chain({rgb, clut}, "haldclut=interp=tetrahedral");
+        graph.output(graph.chain(mapped, "scale=out_color_matrix=" + scaleMatrix + ":out_range=tv,format=yuv420p"), "video");
+    });
+}
+
+std::string ffmpegkittest::ToneMapLut::generateApplyScript(const std::string& inputVideoFilePath, const std::string& outputVideoFilePath, const std::string& lutFilePath, const std::string& matrix) {
+    return "-hide_banner -y -i \"" + inputVideoFilePath + "\" -i \"" + lutFilePath + "\" -filter_complex \"" + generateApplyFilterGraph(matrix) + "\" -map [video] -map 0:a? \"" + outputVideoFilePath + "\"";
+}
+
+std::string ffmpegkittest::ToneMapLut::prepare(const std::string& cacheDirectory, const std::string& transfer, const std::string& primaries, const std::string& matrix) {
+    const std::string lutFile = getLutFile(cacheDirectory, transfer, primaries, matrix);
+
+    std::lock_guard<std::mutex> lock(bakeMutex);
+
+    struct stat fileStat;
+    if (stat(lutFile.c_str(), &fileStat) == 0 && fileStat.st_size > 0) {
+        return lutFile;
+    }
+
+    // A BAKE THAT FAILS HALF WAY MUST NOT LEAVE A FILE THAT LOOKS CACHED
+    const std::string bakingFile = lutFile + ".baking.png";
+    auto session = FFmpegKit::execute(generateBakeScript(transfer, primaries, bakingFile));
+    if (!ReturnCode::isSuccess(session->getReturnCode()) || std::rename(bakingFile.c_str(), lutFile.c_str()) != 0) {
+        std::cout << "Failed to bake tone map lut " << lutFile << " with rc " << session->getReturnCode() << "." << std::endl;
+        std::remove(bakingFile.c_str());
+        return "";
+    }
+
+    std::cout << "Baked tone map lut " << lutFile << " in " << session->getDuration() << " ms." << std::endl;
+    return lutFile;
+}
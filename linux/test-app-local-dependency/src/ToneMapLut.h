@@ -0,0 +1,53 @@
+/*
+ * Copyright (c) 2022 Taner Sener
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#ifndef FFMPEG_KIT_TEST_TONE_MAP_LUT_H
+#define FFMPEG_KIT_TEST_TONE_MAP_LUT_H
+
+#include <string>
+
+namespace ffmpegkittest {
+
+    /**
+     * Tone maps HDR video to SDR with the transform of the zscale script. The RGB part of the
+     * transform is baked once per transfer, primaries and matrix into a Hald CLUT image in the
+     * cache directory. Later runs only convert to RGB, look each colour up and convert back, so
+     * no frame goes through the floating point linearise, tonemap and transfer steps.
+     */
+    class ToneMapLut {
+        public:
+            static constexpr const int HaldLevel = 12;
+            static constexpr const char* DefaultTransfer = "smpte2084";
+            static constexpr const char* DefaultPrimaries = "bt2020";
+            static constexpr const char* DefaultMatrix = "bt2020nc";
+
+            static std::string generateToneMapFilters(const std::string& transfer, const std::string& primaries, const std::string& matrix);
+            static std::string getLutFile(const std::string& cacheDirectory, const std::string& transfer, const std::string& primaries, const std::string& matrix);
+            static std::string generateBakeScript(const std::string& transfer, const std::string& primaries, const std::string& lutFilePath);
+            static std::string generateApplyFilterGraph(const std::string& matrix);
+            static std::string generateApplyScript(const std::string& inputVideoFilePath, const std::string& outputVideoFilePath, const std::string& lutFilePath, const std::string& matrix);
+            static std::string prepare(const std::string& cacheDirectory, const std::string& transfer, const std::string& primaries, const std::string& matrix);
+    };
+
+}
+
+#endif // FFMPEG_KIT_TEST_TONE_MAP_LUT_H
@@ -0,0 +1,67 @@
+/*
+ * Copyright (c) 2022 Taner Sener
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#include "ToneMapLutTest.h"
+#include "ToneMapLut.h"
+#include "Video.h"
+#include <iostream>
+
+using namespace ffmpegkittest;
+
+void testZscaleScriptIsUnchanged() {
+    assert(Video::generateZscaleVideoScript("in.mp4", "out.mp4") == "-y -i in.mp4 -vf zscale=tin=smpte2084:min=bt2020nc:pin=bt2020:rin=tv:t=smpte2084:m=bt2020nc:p=bt2020:r=tv,zscale=t=linear,tonemap=tonemap=clip,zscale=t=bt709,format=yuv420p out.mp4");
+}
+
+void testLutFilesAreKeyedByColourProperties() {
+    const std::string hdr10 = ToneMapLut::getLutFile("/cache", "smpte2084", "bt2020", "bt2020nc");
+    assert(hdr10 == "/cache/tonemap-smpte2084-bt2020-bt2020nc-12.png");
+    assert(ToneMapLut::getLutFile("/cache", "arib-std-b67", "bt2020", "bt2020nc") != hdr10);
+    assert(ToneMapLut::getLutFile("/cache", "smpte2084", "bt2020", "bt2020c") != hdr10);
+}
+
+void testBakeScript() {
+    const std::string script = ToneMapLut::generateBakeScript("smpte2084", "bt2020", "/cache/my lut.png");
+    assert(script.find("haldclutsrc=level=12,format=gbrp16le") != std::string::npos);
+    assert(script.find("zscale=tin=smpte2084:pin=bt2020:rin=full:t=smpte2084:p=bt2020:r=full,zscale=t=linear,tonemap=tonemap=clip,zscale=t=bt709,format=rgb48be") != std::string::npos);
+    assert(script.find("-frames:v 1 -update 1 \"/cache/my lut.png\"") != std::string::npos);
+}
+
+void testApplyGraph() {
+    const std::string graph = ToneMapLut::generateApplyFilterGraph("bt2020nc");
+
+    // THE LOOKUP REPLACES EVERY FLOATING POINT STEP, ONLY THE MATRIX CONVERSIONS AROUND IT ARE LEFT
+    assert(graph == "[0:v]scale=in_color_matrix=bt2020:in_range=tv,format=gbrp16le[s1];[1:v]format=gbrp16le[s3];[s1][s3]haldclut=interp=tetrahedral,scale=out_color_matrix=bt2020:out_range=tv,format=yuv420p[video]");
+    assert(graph.find("zscale") == std::string::npos);
+    assert(ToneMapLut::generateApplyFilterGraph("bt2020c") == graph);
+    assert(ToneMapLut::generateApplyFilterGraph("smpte170m").find("in_color_matrix=bt601") != std::string::npos);
+
+    const std::string script = ToneMapLut::generateApplyScript("/videos/in put.mp4", "/videos/out.mp4", "/cache/lut.png", "bt2020nc");
+    assert(script == "-hide_banner -y -i \"/videos/in put.mp4\" -i \"/cache/lut.png\" -filter_complex \"" + graph + "\" -map [video] -map 0:a? \"/videos/out.mp4\"");
+}
+
+void testToneMapLut(void) {
+    testZscaleScriptIsUnchanged();
+    testLutFilesAreKeyedByColourProperties();
+    testBakeScript();
+    testApplyGraph();
+    std::cout << "ToneMapLutTest passed." << std::endl;
+}
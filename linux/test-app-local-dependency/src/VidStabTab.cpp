@@ -24,10 +24,14 @@
 #include "Application.h"
 #include "Constants.h"
 #include "Log.h"
+#include "LogSink.h"
+#include "Pipeline.h"
 #include "Popup.h"
 #include "Video.h"
 #include <FFmpegKit.h>
 #include <FFmpegKitConfig.h>
+#include <fstream>
+#include <thread>
 
 using namespace ffmpegkit;
 
@@ -39,36 +43,31 @@ static gboolean showStabilizeFailedPopup(const std::pair<Gtk::Window*,const std:
     return FALSE;
 }
 
-static gboolean appendLog(const std::pair<ffmpegkittest::VidStabTab*,const std::shared_ptr<Log>>* parameters) {
-    ffmpegkittest::VidStabTab* videoTab = parameters->first;
-    auto log = parameters->second;
-    videoTab->appendOutput(log->getMessage());
-    delete parameters;
-    return FALSE;
-}
-
-ffmpegkittest::VidStabTab::VidStabTab() {
+ffmpegkittest::VidStabTab::VidStabTab() : outputView("vidstab") {
     stabilizeVideoButton.set_label("STABILIZE VIDEO");
     stabilizeVideoButton.set_size_request(120, 30);
     stabilizeVideoButton.set_tooltip_text(Constants::VidStabTestTooltipText);
     stabilizeVideoButton.signal_clicked().connect(sigc::mem_fun(*this, &VidStabTab::stabilizeVideo));
     Util::applyButtonStyle(stabilizeVideoButton);
     stabilizeVideoButtonBox.pack_start(stabilizeVideoButton, Gtk::PACK_EXPAND_PADDING);
-
-    outputText.set_editable(false);
-    Util::applyOutputTextStyle(outputText);
-    outputTextWindow.add(outputText);
+    benchmarkButton.set_label("BENCHMARK");
+    benchmarkButton.set_size_request(120, 30);
+    benchmarkButton.set_tooltip_text(Constants::VidStabTestTooltipText);
+    benchmarkButton.signal_clicked().connect(sigc::mem_fun(*this, &VidStabTab::runBenchmark));
+    Util::applyButtonStyle(benchmarkButton);
+    stabilizeVideoButtonBox.pack_start(benchmarkButton, Gtk::PACK_EXPAND_PADDING);
+    benchmarkRunning = false;
+
+    logConsumerId = LogSink::getInstance().registerConsumer([this](const std::string& batch) {
+        appendOutput(batch);
+    });
 
     pack_start(stabilizeVideoButtonBox, Gtk::PACK_SHRINK);
-    add(outputTextWindow);
+    add(outputView);
 }
 
 void ffmpegkittest::VidStabTab::setActive() {
     std::cout << "VidStab Tab Activated" << std::endl;
-    FFmpegKitConfig::enableLogCallback([this](auto log) {
-        g_idle_add((GSourceFunc)appendLog, new std::pair<VidStabTab*,const std::shared_ptr<Log>>(this, log));
-    });
-    FFmpegKitConfig::enableStatisticsCallback(nullptr);
 }
 
 void ffmpegkittest::VidStabTab::setParentWindow(Gtk::Window* parentWindow) {
@@ -76,81 +75,152 @@ void ffmpegkittest::VidStabTab::setParentWindow(Gtk::Window* parentWindow) {
 }
 
 void ffmpegkittest::VidStabTab::appendOutput(const std::string& string) {
-    outputText.get_buffer()->set_text(outputText.get_buffer()->get_text() + string);
-    Glib::RefPtr<Gtk::Adjustment> adj = outputText.get_vadjustment();
-    adj->set_value(adj->get_upper());
+    outputView.append(string);
 }
 
 void ffmpegkittest::VidStabTab::clearOutput() {
-    outputText.get_buffer()->set_text("");
+    outputView.clear();
 }
 
 void ffmpegkittest::VidStabTab::stabilizeVideo() {
     clearOutput();
 
-    std::string image1File = Application::getApplicationInstallDirectory() + "/share/images/machupicchu.jpg";
-    std::string image2File = Application::getApplicationInstallDirectory() + "/share/images/pyramid.jpg";
-    std::string image3File = Application::getApplicationInstallDirectory() + "/share/images/stonehenge.jpg";
-    std::string shakeResultsFile = getShakeResultsFile();
-    std::string videoFile = getVideoFile();
-    std::string stabilizedVideoFile = getStabilizedVideoFile();
-
-    std::remove(shakeResultsFile.c_str());
-    std::remove(videoFile.c_str());
-    std::remove(stabilizedVideoFile.c_str());
-
     std::cout << "Testing VID.STAB." << std::endl;
 
     showCreateProgressDialog();
 
-    std::string ffmpegCommand = Video::generateShakingVideoScript(image1File, image2File, image3File, videoFile);
+    auto pipeline = createStabilizePipeline(true);
+    Pipeline* stabilizePipeline = pipeline.get();
+    pipeline->start([this, stabilizePipeline](const bool succeeded) {
+        std::cout << stabilizePipeline->describeTimings();
 
-    std::cout << "FFmpeg process started with arguments: '" << ffmpegCommand << "'." << std::endl;
+        this->hideStabilizeProgressDialog();
 
-    FFmpegKit::executeAsync(ffmpegCommand, [this, videoFile, shakeResultsFile, stabilizedVideoFile](auto session) {
-        std::cout << "FFmpeg process exited with state " << FFmpegKitConfig::sessionStateToString(session->getState()) << " and rc " << session->getReturnCode() << "." << session->getFailStackTrace() << std::endl;
+        if (succeeded) {
+            std::cout << "Stabilize video completed successfully." << std::endl;
+        } else if (stabilizePipeline->getNodes()[0].state != NodeSucceeded) {
+            g_idle_add((GSourceFunc)showStabilizeFailedPopup, new std::pair<Gtk::Window*,const std::string>(this->parentWindow, "Create video failed. Please check logs for the details."));
+        } else {
+            g_idle_add((GSourceFunc)showStabilizeFailedPopup, new std::pair<Gtk::Window*,const std::string>(this->parentWindow, "Stabilize video failed. Please check logs for the details."));
+        }
+    });
+}
 
-        this->hideCreateProgressDialog();
+void ffmpegkittest::VidStabTab::runBenchmark() {
+    if (benchmarkRunning.exchange(true)) {
+        std::cout << "VID.STAB benchmark is already running." << std::endl;
+        return;
+    }
 
-        if (ReturnCode::isSuccess(session->getReturnCode())) {
-            std::cout << "Create completed successfully; stabilizing video." << std::endl;
+    clearOutput();
 
-            std::string analyzeVideoCommand = "-y -i " + videoFile + " -vf vidstabdetect=shakiness=10:accuracy=15:result=" + shakeResultsFile + " -f null -";
+    std::cout << "Testing VID.STAB with and without single decode detection." << std::endl;
 
-            this->showStabilizeProgressDialog();
+    // WAITING FOR EACH PIPELINE BLOCKS, SO THEY RUN OUTSIDE THE MAIN LOOP
+    std::thread([this]() {
+        for (int fused = 0; fused <= 1; fused++) {
+            const IoCounters before = readIoCounters();
 
-            std::cout << "FFmpeg process started with arguments: '" << analyzeVideoCommand << "'." << std::endl;
+            auto pipeline = createStabilizePipeline(fused);
+            pipeline->start(nullptr);
+            pipeline->waitUntilFinished();
 
-            FFmpegKit::executeAsync(analyzeVideoCommand, [this, videoFile, shakeResultsFile, stabilizedVideoFile](auto secondSession) {
-                std::cout << "FFmpeg process exited with state " << FFmpegKitConfig::sessionStateToString(secondSession->getState()) << " and rc " << secondSession->getReturnCode() << "." << secondSession->getFailStackTrace() << std::endl;
+            const IoCounters after = readIoCounters();
 
-                if (ReturnCode::isSuccess(secondSession->getReturnCode())) {
-                    std::string stabilizeVideoCommand = "-y -i " + videoFile + " -vf vidstabtransform=smoothing=30:input=" + shakeResultsFile + " -c:v mpeg4 " + stabilizedVideoFile;
+            std::cout << pipeline->describeTimings();
+            std::cout << "VID.STAB " << (fused ? "single decode graph" : "three session chain") << (pipeline->isSucceeded() ? " completed" : " failed") << " in " << pipeline->getElapsedTime() << " ms, " << (after.writtenBytes - before.writtenBytes) << " bytes written and " << (after.readBytes - before.readBytes) << " bytes read." << std::endl;
+        }
 
-                    std::cout << "FFmpeg process started with arguments: '" << stabilizeVideoCommand << "'." << std::endl;
+        benchmarkShakingGeneration();
 
-                    FFmpegKit::executeAsync(stabilizeVideoCommand, [this](auto thirdSession) {
+        benchmarkRunning = false;
+    }).detach();
+}
 
-                        std::cout << "FFmpeg process exited with state " << FFmpegKitConfig::sessionStateToString(thirdSession->getState()) << " and rc " << thirdSession->getReturnCode() << "." << thirdSession->getFailStackTrace() << std::endl;
+void ffmpegkittest::VidStabTab::benchmarkShakingGeneration() {
+    std::string image1File = Application::getApplicationInstallDirectory() + "/share/images/machupicchu.jpg";
+    std::string image2File = Application::getApplicationInstallDirectory() + "/share/images/pyramid.jpg";
+    std::string image3File = Application::getApplicationInstallDirectory() + "/share/images/stonehenge.jpg";
 
-                        this->hideStabilizeProgressDialog();
+    // THE 9 S TEST VIDEO AND A 10 MINUTE CLIP, WRAPPED FRAMES ARE NOT ENCODED SO ONLY GENERATION IS MEASURED
+    const double imageDurations[2] = {3, 200};
+    for (int clip = 0; clip < 2; clip++) {
+        const int frameCount = (int)(3 * imageDurations[clip] * 25);
+        double fps[2];
+        bool succeeded = true;
+
+        for (int cropJitter = 0; cropJitter < 2; cropJitter++) {
+            auto session = FFmpegKit::execute("-hide_banner -y -i \"" + image1File + "\" -i \"" + image2File + "\" -i \"" + image3File + "\" -filter_complex \"" + Video::generateShakingFilterGraph(imageDurations[clip], cropJitter == 1, "") + "\" -map [video] -c:v wrapped_avframe -f null -");
+            succeeded = succeeded && ReturnCode::isSuccess(session->getReturnCode());
+            fps[cropJitter] = session->getDuration() > 0 ? frameCount * 1000.0 / session->getDuration() : 0;
+        }
 
-                        if (ReturnCode::isSuccess(thirdSession->getReturnCode())) {
-                            std::cout << "Stabilize video completed successfully." << std::endl;
-                        } else {
-                            g_idle_add((GSourceFunc)showStabilizeFailedPopup, new std::pair<Gtk::Window*,const std::string>(this->parentWindow, "Stabilize video failed. Please check logs for the details."));
-                        }
-                    });
+        std::cout << "Generated " << 3 * imageDurations[clip] << " s of shaking video at " << fps[0] << " fps with overlays and at " << fps[1] << " fps with crop offsets" << (succeeded ? "" : " (failed)") << "." << std::endl;
+    }
+}
 
-                } else {
-                    this->hideCreateProgressDialog();
-                    g_idle_add((GSourceFunc)showStabilizeFailedPopup, new std::pair<Gtk::Window*,const std::string>(this->parentWindow, "Stabilize video failed. Please check logs for the details."));
-                }
-            });
-        } else {
-            g_idle_add((GSourceFunc)showStabilizeFailedPopup, new std::pair<Gtk::Window*,const std::string>(this->parentWindow, "Create video failed. Please check logs for the details."));
+std::shared_ptr<ffmpegkittest::Pipeline> ffmpegkittest::VidStabTab::createStabilizePipeline(const bool fused) {
+    std::string image1File = Application::getApplicationInstallDirectory() + "/share/images/machupicchu.jpg";
+    std::string image2File = Application::getApplicationInstallDirectory() + "/share/images/pyramid.jpg";
+    std::string image3File = Application::getApplicationInstallDirectory() + "/share/images/stonehenge.jpg";
+    std::string shakeResultsFile = getShakeResultsFile();
+    std::string videoFile = getVideoFile();
+    std::string stabilizedVideoFile = getStabilizedVideoFile();
+
+    std::remove(stabilizedVideoFile.c_str());
+
+    std::string stabilizeVideoCommand = "-y -i " + videoFile + " -vf vidstabtransform=smoothing=30:input=" + shakeResultsFile + " -c:v mpeg4 " + stabilizedVideoFile;
+
+    auto pipeline = Pipeline::create(logConsumerId);
+    int create;
+    int stabilize;
+
+    // THE FUSED GRAPH WRITES THE SHAKE RESULTS WHILE ENCODING, THE CHAIN DECODES THE NEW VIDEO AGAIN TO DETECT THEM
+    if (fused) {
+        create = pipeline->addNode("create and vidstabdetect", Video::generateShakingVideoScript(image1File, image2File, image3File, videoFile, shakeResultsFile));
+        stabilize = pipeline->addNode("vidstabtransform", stabilizeVideoCommand);
+        pipeline->addFileEdge(create, stabilize, videoFile);
+        pipeline->addFileEdge(create, stabilize, shakeResultsFile);
+    } else {
+        std::string analyzeVideoCommand = "-y -i " + videoFile + " -vf vidstabdetect=shakiness=10:accuracy=15:result=" + shakeResultsFile + " -f null -";
+
+        create = pipeline->addNode("create", Video::generateShakingVideoScript(image1File, image2File, image3File, videoFile));
+        const int analyze = pipeline->addNode("vidstabdetect", analyzeVideoCommand);
+        stabilize = pipeline->addNode("vidstabtransform", stabilizeVideoCommand);
+        pipeline->addFileEdge(create, analyze, videoFile);
+        pipeline->addFileEdge(create, stabilize);
+        pipeline->addFileEdge(analyze, stabilize, shakeResultsFile);
+    }
+
+    pipeline->setNodeListener([this, create](const PipelineNode& node) {
+        if (node.id == create && node.state == NodeSucceeded) {
+            std::cout << "Create completed successfully; stabilizing video." << std::endl;
+            this->hideCreateProgressDialog();
+            this->showStabilizeProgressDialog();
+        } else if (node.id == create && node.state != NodeRunning) {
+            this->hideCreateProgressDialog();
         }
     });
+
+    return pipeline;
+}
+
+ffmpegkittest::VidStabTab::IoCounters ffmpegkittest::VidStabTab::readIoCounters() {
+    IoCounters counters{0, 0};
+    std::ifstream io("/proc/self/io");
+    std::string name;
+    long long value;
+
+    // SESSIONS RUN INSIDE THIS PROCESS, SO ITS COUNTERS COVER EVERY STAGE
+    while (io >> name >> value) {
+        if (name == "rchar:") {
+            counters.readBytes = value;
+        } else if (name == "wchar:") {
+            counters.writtenBytes = value;
+        }
+    }
+
+    return counters;
 }
 
 std::string ffmpegkittest::VidStabTab::getShakeResultsFile() {
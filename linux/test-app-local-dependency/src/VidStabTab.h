@@ -23,9 +23,12 @@
 #ifndef FFMPEG_KIT_TEST_VIDSTAB_TAB_H
 #define FFMPEG_KIT_TEST_VIDSTAB_TAB_H
 
+#include "OutputView.h"
+#include "Pipeline.h"
 #include "ProgressDialog.h"
 #include "Statistics.h"
 #include "Util.h"
+#include <atomic>
 #include <gtkmm.h>
 
 namespace ffmpegkittest {
@@ -38,8 +41,17 @@ namespace ffmpegkittest {
             void appendOutput(const std::string& string);
 
         private:
+            struct IoCounters {
+                long long readBytes;
+                long long writtenBytes;
+            };
+
             void clearOutput();
             void stabilizeVideo();
+            void runBenchmark();
+            void benchmarkShakingGeneration();
+            std::shared_ptr<Pipeline> createStabilizePipeline(const bool fused);
+            IoCounters readIoCounters();
             std::string getShakeResultsFile();
             std::string getVideoFile();
             std::string getStabilizedVideoFile();
@@ -49,12 +61,14 @@ namespace ffmpegkittest {
             void hideStabilizeProgressDialog();
 
             Gtk::Button stabilizeVideoButton;
+            Gtk::Button benchmarkButton;
             Gtk::HBox stabilizeVideoButtonBox;
-            Gtk::TextView outputText;
-            Gtk::ScrolledWindow outputTextWindow;
+            OutputView outputView;
             ffmpegkittest::ProgressDialog progressDialog;
             Gtk::Window* parentWindow;
+            int logConsumerId;
             std::shared_ptr<ffmpegkit::Statistics> statistics;
+            std::atomic<bool> benchmarkRunning;
     };
 
 }
@@ -21,25 +21,125 @@
  */
 
 #include "Video.h"
+#include "CommandTemplate.h"
+#include "ToneMapLut.h"
+#include <sstream>
+
+namespace ffmpegkittest {
+
+    static const std::string CanvasWidthText = std::to_string((int)Video::CanvasWidth);
+    static const std::string CanvasHeightText = std::to_string((int)Video::CanvasHeight);
+    static const std::string CanvasSize = "s=" + CanvasWidthText + "x" + CanvasHeightText;
+    static const std::string FitImageFilters = "setpts=PTS-STARTPTS,scale=w='if(gte(iw/ih," + CanvasWidthText + "/" + CanvasHeightText + "),min(iw," + CanvasWidthText + "),-1)':h='if(gte(iw/ih," + CanvasWidthText + "/" + CanvasHeightText + "),-1,min(ih," + CanvasHeightText + "))'";
+    static const char* EvenImageFilters = "scale=trunc(iw/2)*2:trunc(ih/2)*2,setsar=sar=1/1";
+    static const std::string PadImageFilter = "pad=width=" + CanvasWidthText + ":height=" + CanvasHeightText + ":x=(" + CanvasWidthText + "-iw)/2:y=(" + CanvasHeightText + "-ih)/2:color=black";
+    static const std::string ShakingPadImageFilter = "pad=width=" + std::to_string(Video::CanvasWidth + 6) + ":height=" + std::to_string(Video::CanvasHeight + 2) + ":x=(" + CanvasWidthText + "-iw)/2+6:y=(" + CanvasHeightText + "-ih)/2+2:color=black";
+    static const std::string ShakingCropFilter = "crop=w=" + CanvasWidthText + ":h=" + CanvasHeightText + ":x='6-2*mod(n,4)':y='2-2*mod(n,2)'";
+    static const char* ReplayImageFilters = "loop=loop=-1:size=1:start=0,setpts=N/25/TB";
+
+    // SECONDS EACH IMAGE IS SHOWN ON ITS OWN IN THE ENCODE AND PIPE SCRIPTS, AND OF EACH WIPE BETWEEN TWO IMAGES
+    static const int SlideshowImageDurations[3] = {3, 2, 2};
+    static const int SlideshowTransitionDuration = 1;
+    static const int SlideshowFrameRate = 30;
+    static const int ShakingImageDuration = 3;
+
+    static std::string generateSegmentTrim(const int duration) {
+        return "trim=duration=" + std::to_string(duration) + ",select=lte(n\\," + std::to_string(duration * SlideshowFrameRate) + ")";
+    }
+
+    static std::string generateImageInput(const std::string& quotedPath, const bool decodeImageOnce) {
+        return (decodeImageOnce ? "-i " : "-loop 1 -i ") + quotedPath + " ";
+    }
+
+    static bool isTenBit(const std::string& pixelFormat) {
+        return pixelFormat.find("p10") != std::string::npos;
+    }
+
+    static std::string pinPixelFormat(const std::string& pixelFormat) {
+        return pixelFormat.empty() ? "" : ",format=" + pixelFormat;
+    }
+
+    static FilterPad addFittedImage(FilterGraph& graph, const int inputIndex, const std::string& pixelFormat, const std::string& padFilter) {
+
+        // THE FIT SCALE ALSO CONVERTS THE DECODED IMAGE INTO THE WORKING FORMAT, EVERY LATER FILTER KEEPS IT
+        auto fitted = graph.chain(graph.input(std::to_string(inputIndex) + ":v"), FitImageFilters + pinPixelFormat(pixelFormat));
+        return graph.chain(fitted, std::string(EvenImageFilters) + "," + padFilter);
+    }
+
+    static std::string getOverlayFormat(const std::string& pixelFormat) {
+        return isTenBit(pixelFormat) ? "yuv420p10" : "yuv420";
+    }
+
+    static void buildSlideshowGraph(FilterGraph& graph, const bool decodeImagesOnce, const std::string& pixelFormat, const std::string& outputFilters) {
+        FilterPad images[3];
+        for (int i = 0; i < 3; i++) {
+            images[i] = Video::addStillImage(graph, i, decodeImagesOnce, pixelFormat);
+        }
+
+        // THE ONE SECOND SEGMENTS AT BOTH ENDS OF A TRANSITION ARE THE SAME NODE, THE BUILDER SPLITS IT
+        const std::string transitionTrim = generateSegmentTrim(SlideshowTransitionDuration);
+        auto stream1Overlaid = graph.chain(images[0], generateSegmentTrim(SlideshowImageDurations[0]));
+        auto stream1Ending = graph.chain(images[0], transitionTrim);
+        auto stream2Overlaid = graph.chain(images[1], generateSegmentTrim(SlideshowImageDurations[1]));
+        auto stream2Starting = graph.chain(images[1], transitionTrim);
+        auto stream2Ending = graph.chain(images[1], transitionTrim);
+        auto stream3Overlaid = graph.chain(images[2], generateSegmentTrim(SlideshowImageDurations[2]));
+        auto stream3Starting = graph.chain(images[2], transitionTrim);
+        auto stream2Blended = Video::addWipeTransition(graph, stream2Starting, stream1Ending, SlideshowTransitionDuration, TransitionWipe, pixelFormat);
+        auto stream3Blended = Video::addWipeTransition(graph, stream3Starting, stream2Ending, SlideshowTransitionDuration, TransitionWipe, pixelFormat);
+
+        auto video = graph.chain({stream1Overlaid, stream2Blended, stream2Overlaid, stream3Blended, stream3Overlaid}, "concat=n=5:v=1:a=0,scale=w=640:h=424," + outputFilters);
+        graph.output(video, "video");
+    }
+
+}
+
+ffmpegkittest::FilterPad ffmpegkittest::Video::addStillImage(FilterGraph& graph, const int inputIndex, const bool decodeImageOnce, const std::string& pixelFormat) {
+    auto padded = addFittedImage(graph, inputIndex, pixelFormat, PadImageFilter);
+
+    // THE IMAGE IS DECODED, SCALED AND PADDED ONCE, THEN THE SAME FRAME IS REPLAYED AT THE IMAGE2 DEMUXER RATE
+    return decodeImageOnce ? graph.chain(padded, ReplayImageFilters) : padded;
+}
+
+std::string ffmpegkittest::Video::generateWipeFilter(const double duration) {
+    std::ostringstream stream;
+    stream << duration;
+    return "blend=all_expr='if(gte(X,(W/2)*T/" + stream.str() + ")*lte(X,W-(W/2)*T/" + stream.str() + "),B,A)':shortest=1";
+}
+
+ffmpegkittest::FilterPad ffmpegkittest::Video::addWipeTransition(FilterGraph& graph, const FilterPad& next, const FilterPad& previous, const double duration, const SlideshowTransition transition, const std::string& pixelFormat) {
+    if (transition == TransitionWipeExpression) {
+        return graph.chain({next, previous}, generateWipeFilter(duration));
+    }
+
+    std::ostringstream stream;
+    stream << duration;
+    const std::string canvas = CanvasSize + ":r=25:d=" + stream.str();
+
+    // THE MASK SHOWS THE PREVIOUS IMAGE IN THE SAME CENTRE BAND AS THE EXPRESSION WIPE. IT IS BUILT FROM WHOLE ROW COPIES
+    // PLACED PER FRAME AND A LOOKUP TABLE, SO NO EXPRESSION IS EVALUATED PER PIXEL
+    // OVERLAY ROUNDS POSITIONS TO THE CHROMA GRID OF ITS FORMAT, SO THE MASK IS PLACED IN 4:4:4 AND ONLY ITS LUMA IS KEPT
+    const std::string maskFormat = pixelFormat.empty() ? "" : ",format=yuv444p";
+    auto black = graph.source("color=black:" + canvas + maskFormat);
+    auto white = graph.source("color=white:" + canvas + maskFormat);
+    auto opened = graph.chain({black, white}, "overlay=x='ceil(W/2*t/" + stream.str() + ")':y=0:format=yuv444");
+    auto band = graph.chain({opened, black}, "overlay=x='floor(W-W/2*t/" + stream.str() + ")+1':y=0:format=yuv444");
+    auto mask = graph.chain(band, isTenBit(pixelFormat) ? "format=gray10le,lut=c0='if(gte(val,512),1023,0)'" : "format=gray,lut=c0='if(gte(val,128),255,0)'");
+
+    auto layer = graph.chain({previous, mask}, "alphamerge");
+    return graph.chain({next, layer}, "overlay=x=0:y=0:format=" + getOverlayFormat(pixelFormat) + ":shortest=1");
+}
 
 std::string ffmpegkittest::Video::generateCreateVideoWithPipesScript(std::string image1Pipe, std::string image2Pipe, std::string image3Pipe, std::string videoFilePath) {
+    const std::string filterGraph = FilterGraph::cached("pipes", [](FilterGraph& graph) {
+        buildSlideshowGraph(graph, true, "yuv420p", "format=yuv420p");
+    });
+
     return  
             "-hide_banner -y -i \"" + image1Pipe + "\" " +
             "-i '" + image2Pipe + "' " +
             "-i " + image3Pipe + " " +
-            "-filter_complex \"" +
-            "[0:v]loop=loop=-1:size=1:start=0,setpts=PTS-STARTPTS,scale=w=\'if(gte(iw/ih,640/427),min(iw,640),-1)\':h=\'if(gte(iw/ih,640/427),-1,min(ih,427))\',scale=trunc(iw/2)*2:trunc(ih/2)*2,setsar=sar=1/1,split=2[stream1out1][stream1out2];" +
-            "[1:v]loop=loop=-1:size=1:start=0,setpts=PTS-STARTPTS,scale=w=\'if(gte(iw/ih,640/427),min(iw,640),-1)\':h=\'if(gte(iw/ih,640/427),-1,min(ih,427))\',scale=trunc(iw/2)*2:trunc(ih/2)*2,setsar=sar=1/1,split=2[stream2out1][stream2out2];" +
-            "[2:v]loop=loop=-1:size=1:start=0,setpts=PTS-STARTPTS,scale=w=\'if(gte(iw/ih,640/427),min(iw,640),-1)\':h=\'if(gte(iw/ih,640/427),-1,min(ih,427))\',scale=trunc(iw/2)*2:trunc(ih/2)*2,setsar=sar=1/1,split=2[stream3out1][stream3out2];" +
-            "[stream1out1]pad=width=640:height=427:x=(640-iw)/2:y=(427-ih)/2:color=#00000000,trim=duration=3,select=lte(n\\,90)[stream1overlaid];" +
-            "[stream1out2]pad=width=640:height=427:x=(640-iw)/2:y=(427-ih)/2:color=#00000000,trim=duration=1,select=lte(n\\,30)[stream1ending];" +
-            "[stream2out1]pad=width=640:height=427:x=(640-iw)/2:y=(427-ih)/2:color=#00000000,trim=duration=2,select=lte(n\\,60)[stream2overlaid];" +
-            "[stream2out2]pad=width=640:height=427:x=(640-iw)/2:y=(427-ih)/2:color=#00000000,trim=duration=1,select=lte(n\\,30),split=2[stream2starting][stream2ending];" +
-            "[stream3out1]pad=width=640:height=427:x=(640-iw)/2:y=(427-ih)/2:color=#00000000,trim=duration=2,select=lte(n\\,60)[stream3overlaid];" +
-            "[stream3out2]pad=width=640:height=427:x=(640-iw)/2:y=(427-ih)/2:color=#00000000,trim=duration=1,select=lte(n\\,30)[stream3starting];" +
-            "[stream2starting][stream1ending]blend=all_expr=\'if(gte(X,(W/2)*T/1)*lte(X,W-(W/2)*T/1),B,A)\':shortest=1[stream2blended];" +
-            "[stream3starting][stream2ending]blend=all_expr=\'if(gte(X,(W/2)*T/1)*lte(X,W-(W/2)*T/1),B,A)\':shortest=1[stream3blended];" +
-            "[stream1overlaid][stream2blended][stream2overlaid][stream3blended][stream3overlaid]concat=n=5:v=1:a=0,scale=w=640:h=424,format=yuv420p[video]\"" +
+            "-filter_complex \"" + filterGraph + "\"" +
             " -map [video] -fps_mode cfr -c:v mpeg4 -r 30 " + videoFilePath;
 }
 
@@ -48,49 +148,126 @@ std::string ffmpegkittest::Video::generateEncodeVideoScript(std::string image1Pa
 }
 
 std::string ffmpegkittest::Video::generateEncodeVideoScript(std::string image1Path, std::string image2Path, std::string image3Path, std::string videoFilePath, std::string videoCodec, std::string pixelFormat, std::string customOptions) {
+    return ffmpegkittest::Video::generateEncodeVideoScript(image1Path, image2Path, image3Path, videoFilePath, videoCodec, pixelFormat, customOptions, "");
+}
+
+std::string ffmpegkittest::Video::generateEncodeVideoScript(std::string image1Path, std::string image2Path, std::string image3Path, std::string videoFilePath, std::string videoCodec, std::string pixelFormat, std::string customOptions, std::string subtitlesFilter) {
+    return ffmpegkittest::Video::generateEncodeVideoScript(image1Path, image2Path, image3Path, videoFilePath, videoCodec, pixelFormat, customOptions, subtitlesFilter, true);
+}
+
+std::string ffmpegkittest::Video::generateEncodeVideoScript(std::string image1Path, std::string image2Path, std::string image3Path, std::string videoFilePath, std::string videoCodec, std::string pixelFormat, std::string customOptions, std::string subtitlesFilter, bool decodeImagesOnce) {
+
+    const std::string filterGraph = generateEncodeFilterGraph(pixelFormat, subtitlesFilter, decodeImagesOnce, true);
+
     return
-            "-hide_banner -y -loop 1 -i \"" + image1Path + "\" " +
-            "-loop 1 -i '" + image2Path + "' " +
-            "-loop 1 -i \"" + image3Path + "\" " +
-            "-filter_complex \"" +
-            "[0:v]setpts=PTS-STARTPTS,scale=w=\'if(gte(iw/ih,640/427),min(iw,640),-1)\':h=\'if(gte(iw/ih,640/427),-1,min(ih,427))\',scale=trunc(iw/2)*2:trunc(ih/2)*2,setsar=sar=1/1,split=2[stream1out1][stream1out2];" +
-            "[1:v]setpts=PTS-STARTPTS,scale=w=\'if(gte(iw/ih,640/427),min(iw,640),-1)\':h=\'if(gte(iw/ih,640/427),-1,min(ih,427))\',scale=trunc(iw/2)*2:trunc(ih/2)*2,setsar=sar=1/1,split=2[stream2out1][stream2out2];" +
-            "[2:v]setpts=PTS-STARTPTS,scale=w=\'if(gte(iw/ih,640/427),min(iw,640),-1)\':h=\'if(gte(iw/ih,640/427),-1,min(ih,427))\',scale=trunc(iw/2)*2:trunc(ih/2)*2,setsar=sar=1/1,split=2[stream3out1][stream3out2];" +
-            "[stream1out1]pad=width=640:height=427:x=(640-iw)/2:y=(427-ih)/2:color=#00000000,trim=duration=3,select=lte(n\\,90)[stream1overlaid];" +
-            "[stream1out2]pad=width=640:height=427:x=(640-iw)/2:y=(427-ih)/2:color=#00000000,trim=duration=1,select=lte(n\\,30)[stream1ending];" +
-            "[stream2out1]pad=width=640:height=427:x=(640-iw)/2:y=(427-ih)/2:color=#00000000,trim=duration=2,select=lte(n\\,60)[stream2overlaid];" +
-            "[stream2out2]pad=width=640:height=427:x=(640-iw)/2:y=(427-ih)/2:color=#00000000,trim=duration=1,select=lte(n\\,30),split=2[stream2starting][stream2ending];" +
-            "[stream3out1]pad=width=640:height=427:x=(640-iw)/2:y=(427-ih)/2:color=#00000000,trim=duration=2,select=lte(n\\,60)[stream3overlaid];" +
-            "[stream3out2]pad=width=640:height=427:x=(640-iw)/2:y=(427-ih)/2:color=#00000000,trim=duration=1,select=lte(n\\,30)[stream3starting];" +
-            "[stream2starting][stream1ending]blend=all_expr=\'if(gte(X,(W/2)*T/1)*lte(X,W-(W/2)*T/1),B,A)\':shortest=1[stream2blended];" +
-            "[stream3starting][stream2ending]blend=all_expr=\'if(gte(X,(W/2)*T/1)*lte(X,W-(W/2)*T/1),B,A)\':shortest=1[stream3blended];" +
-            "[stream1overlaid][stream2blended][stream2overlaid][stream3blended][stream3overlaid]concat=n=5:v=1:a=0,scale=w=640:h=424,format=" + pixelFormat + "[video]\"" +
+            "-hide_banner -y " +
+            generateImageInput("\"" + image1Path + "\"", decodeImagesOnce) +
+            generateImageInput("'" + image2Path + "'", decodeImagesOnce) +
+            generateImageInput("\"" + image3Path + "\"", decodeImagesOnce) +
+            "-filter_complex \"" + filterGraph + "\"" +
             " -map [video] -fps_mode cfr " + customOptions + "-c:v " + videoCodec + " -r 30 " + videoFilePath;
 }
 
+std::string ffmpegkittest::Video::generateEncodeFilterGraph(const std::string& pixelFormat, const std::string& subtitlesFilter, const bool decodeImagesOnce, const bool pinPixelFormat) {
+
+    // SUBTITLES ARE DRAWN ON THE GENERATED FRAMES, SO THE BURNED-IN VIDEO COMES OUT OF A SINGLE ENCODE. WITHOUT A PINNED
+    // FORMAT EACH FILTER NEGOTIATES ITS OWN AND THE FINAL FORMAT FILTER IS THE ONLY ONE THAT REACHES THE ENCODER FORMAT
+    const std::string workingFormat = pinPixelFormat ? pixelFormat : "";
+    const std::string outputFilters = (subtitlesFilter.empty() ? "" : subtitlesFilter + ",") + "format=" + pixelFormat;
+    return FilterGraph::cached(std::string(decodeImagesOnce ? "encode once\n" : "encode\n") + workingFormat + "\n" + outputFilters, [decodeImagesOnce, &workingFormat, &outputFilters](FilterGraph& graph) {
+        buildSlideshowGraph(graph, decodeImagesOnce, workingFormat, outputFilters);
+    });
+}
+
+std::list<std::string> ffmpegkittest::Video::generateEncodeVideoArguments(const std::string& image1Path, const std::string& image2Path, const std::string& image3Path, const std::string& videoFilePath, const std::string& videoCodec, const std::string& pixelFormat, const std::string& customOptions, const std::string& subtitlesFilter) {
+    static const CommandTemplate encodeTemplate("-hide_banner -y -i {image1} -i {image2} -i {image3} -filter_complex {graph} -map [video] -fps_mode cfr {options...} -c:v {codec} -r 30 {video}");
+
+    return encodeTemplate.bind({
+        {"image1", image1Path},
+        {"image2", image2Path},
+        {"image3", image3Path},
+        {"graph", generateEncodeFilterGraph(pixelFormat, subtitlesFilter, true, true)},
+        {"options", customOptions},
+        {"codec", videoCodec},
+        {"video", videoFilePath}
+    });
+}
+
 std::string ffmpegkittest::Video::generateShakingVideoScript(std::string image1Path, std::string image2Path, std::string image3Path, std::string videoFilePath) {
+    return ffmpegkittest::Video::generateShakingVideoScript(image1Path, image2Path, image3Path, videoFilePath, "");
+}
+
+std::string ffmpegkittest::Video::generateShakingVideoScript(std::string image1Path, std::string image2Path, std::string image3Path, std::string videoFilePath, std::string shakeResultsFilePath) {
+    const std::string filterGraph = generateShakingFilterGraph(ShakingImageDuration, true, shakeResultsFilePath);
+
     return
-            "-hide_banner -y -loop 1 -i \"" + image1Path + "\" " +
-            "-loop 1 -i '" + image2Path + "' " +
-            "-loop 1 -i " + image3Path + " " +
-            "-f lavfi -i color=black:s=640x427 " +
-            "-filter_complex \"" +
-            "[0:v]setpts=PTS-STARTPTS,scale=w=\'if(gte(iw/ih,640/427),min(iw,640),-1)\':h=\'if(gte(iw/ih,640/427),-1,min(ih,427))\',scale=trunc(iw/2)*2:trunc(ih/2)*2,setsar=sar=1/1[stream1out];" +
-            "[1:v]setpts=PTS-STARTPTS,scale=w=\'if(gte(iw/ih,640/427),min(iw,640),-1)\':h=\'if(gte(iw/ih,640/427),-1,min(ih,427))\',scale=trunc(iw/2)*2:trunc(ih/2)*2,setsar=sar=1/1[stream2out];" +
-            "[2:v]setpts=PTS-STARTPTS,scale=w=\'if(gte(iw/ih,640/427),min(iw,640),-1)\':h=\'if(gte(iw/ih,640/427),-1,min(ih,427))\',scale=trunc(iw/2)*2:trunc(ih/2)*2,setsar=sar=1/1[stream3out];" +
-            "[stream1out]pad=width=640:height=427:x=(640-iw)/2:y=(427-ih)/2:color=#00000000,trim=duration=3[stream1overlaid];" +
-            "[stream2out]pad=width=640:height=427:x=(640-iw)/2:y=(427-ih)/2:color=#00000000,trim=duration=3[stream2overlaid];" +
-            "[stream3out]pad=width=640:height=427:x=(640-iw)/2:y=(427-ih)/2:color=#00000000,trim=duration=3[stream3overlaid];" +
-            "[3:v][stream1overlaid]overlay=x=\'2*mod(n,4)\':y=\'2*mod(n,2)\',trim=duration=3[stream1shaking];" +
-            "[3:v][stream2overlaid]overlay=x=\'2*mod(n,4)\':y=\'2*mod(n,2)\',trim=duration=3[stream2shaking];" +
-            "[3:v][stream3overlaid]overlay=x=\'2*mod(n,4)\':y=\'2*mod(n,2)\',trim=duration=3[stream3shaking];" +
-            "[stream1shaking][stream2shaking][stream3shaking]concat=n=3:v=1:a=0,scale=w=640:h=424,format=yuv420p[video]\"" +
+            "-hide_banner -y -i \"" + image1Path + "\" " +
+            "-i '" + image2Path + "' " +
+            "-i " + image3Path + " " +
+            "-filter_complex \"" + filterGraph + "\"" +
             " -map [video] -fps_mode cfr -c:v mpeg4 -r 30 " + videoFilePath;
 }
 
+std::string ffmpegkittest::Video::generateShakingFilterGraph(const double imageDuration, const bool cropJitter, const std::string& shakeResultsFilePath) {
+    std::ostringstream stream;
+    stream << imageDuration;
+    const std::string imageTrim = "trim=duration=" + stream.str();
+
+    return FilterGraph::cached("shaking\n" + imageTrim + "\n" + std::to_string(cropJitter) + "\n" + shakeResultsFilePath, [&imageTrim, cropJitter, &shakeResultsFilePath](FilterGraph& graph) {
+        FilterPad shaking[3];
+        for (int i = 0; i < 3; i++) {
+            if (cropJitter) {
+
+                // THE MARGINS ARE PADDED ONCE INTO THE REPLAYED IMAGE. MOVING THE CROP WINDOW ONLY OFFSETS THE PLANE POINTERS, SO
+                // NO FRAME IS COMPOSED OR COPIED TO SHAKE IT
+                auto padded = addFittedImage(graph, i, "yuv420p", ShakingPadImageFilter);
+                shaking[i] = graph.chain(padded, std::string(ReplayImageFilters) + "," + imageTrim + "," + ShakingCropFilter);
+            } else {
+                auto background = graph.source("color=black:" + CanvasSize + ",format=yuv420p");
+                auto overlaid = graph.chain(Video::addStillImage(graph, i, true, "yuv420p"), imageTrim);
+                shaking[i] = graph.chain({background, overlaid}, "overlay=x='2*mod(n,4)':y='2*mod(n,2)':format=yuv420," + imageTrim);
+            }
+        }
+        auto video = graph.chain({shaking[0], shaking[1], shaking[2]}, "concat=n=3:v=1:a=0,scale=w=640:h=424,format=yuv420p");
+
+        // WITH A RESULTS FILE THE GENERATED FRAMES ALSO FEED VIDSTABDETECT, SO THE VIDEO IS NOT DECODED AGAIN FOR DETECTION.
+        // FPS MATCHES -r 30 SO DETECTION SEES EXACTLY THE FRAMES THAT ARE ENCODED
+        if (!shakeResultsFilePath.empty()) {
+            video = graph.chain(video, "fps=30");
+            graph.chain(video, "vidstabdetect=shakiness=10:accuracy=15:result=" + shakeResultsFilePath + ",nullsink");
+        }
+        graph.output(video, "video");
+    });
+}
+
+std::string ffmpegkittest::Video::generateSubtitlesFilter(std::string subtitlePath, std::string forceStyle) {
+    const bool ass = subtitlePath.size() >= 4 && subtitlePath.compare(subtitlePath.size() - 4, 4, ".ass") == 0;
+
+    // ASS FILES CARRY THEIR OWN STYLES
+    if (ass) {
+        return "ass=" + subtitlePath;
+    } else if (forceStyle.empty()) {
+        return "subtitles=" + subtitlePath;
+    } else {
+        return "subtitles=" + subtitlePath + ":force_style='" + forceStyle + "'";
+    }
+}
+
 std::string ffmpegkittest::Video::generateZscaleVideoScript(std::string inputVideoFilePath, std::string outputVideoFilePath) {
     return  "-y -i " +
             inputVideoFilePath +
-            " -vf zscale=tin=smpte2084:min=bt2020nc:pin=bt2020:rin=tv:t=smpte2084:m=bt2020nc:p=bt2020:r=tv,zscale=t=linear,tonemap=tonemap=clip,zscale=t=bt709,format=yuv420p " +
+            " -vf " + ToneMapLut::generateToneMapFilters(ToneMapLut::DefaultTransfer, ToneMapLut::DefaultPrimaries, ToneMapLut::DefaultMatrix) + ",format=yuv420p " +
             outputVideoFilePath;
 }
+
+int ffmpegkittest::Video::getEncodeVideoDuration() {
+
+    // THE THREE IMAGES AND THE TWO TRANSITIONS CONCATENATED BY THE ENCODE AND PIPE SCRIPTS
+    return (SlideshowImageDurations[0] + SlideshowImageDurations[1] + SlideshowImageDurations[2] + 2 * SlideshowTransitionDuration) * 1000;
+}
+
+int ffmpegkittest::Video::getShakingVideoDuration() {
+
+    // THE THREE SHAKING SEGMENTS
+    return 3 * ShakingImageDuration * 1000;
+}
@@ -23,17 +23,45 @@
 #ifndef FFMPEG_KIT_TEST_VIDEO_H
 #define FFMPEG_KIT_TEST_VIDEO_H
 
+#include "FilterGraph.h"
+#include <list>
 #include <string>
 
 namespace ffmpegkittest {
 
+    enum SlideshowTransition {
+        TransitionCut,
+        TransitionWipe,
+        TransitionWipeExpression
+    };
+
     class Video {
         public:
+
+            /**
+             * Size every image is fitted and padded to. The height is even so that padding in a 4:2:0 working format keeps
+             * it, the wipe masks are generated at the same size.
+             */
+            static constexpr const int CanvasWidth = 640;
+            static constexpr const int CanvasHeight = 426;
+
+            static FilterPad addStillImage(FilterGraph& graph, const int inputIndex, const bool decodeImageOnce, const std::string& pixelFormat);
+            static std::string generateWipeFilter(const double duration);
+            static FilterPad addWipeTransition(FilterGraph& graph, const FilterPad& next, const FilterPad& previous, const double duration, const SlideshowTransition transition, const std::string& pixelFormat);
+            static std::string generateEncodeFilterGraph(const std::string& pixelFormat, const std::string& subtitlesFilter, const bool decodeImagesOnce, const bool pinPixelFormat);
             static std::string generateCreateVideoWithPipesScript(std::string image1Pipe, std::string image2Pipe, std::string image3Pipe, std::string videoFilePath);
             static std::string generateEncodeVideoScript(std::string image1Path, std::string image2Path, std::string image3Path, std::string videoFilePath, std::string videoCodec, std::string customOptions);
             static std::string generateEncodeVideoScript(std::string image1Path, std::string image2Path, std::string image3Path, std::string videoFilePath, std::string videoCodec, std::string pixelFormat, std::string customOptions);
+            static std::string generateEncodeVideoScript(std::string image1Path, std::string image2Path, std::string image3Path, std::string videoFilePath, std::string videoCodec, std::string pixelFormat, std::string customOptions, std::string subtitlesFilter);
+            static std::string generateEncodeVideoScript(std::string image1Path, std::string image2Path, std::string image3Path, std::string videoFilePath, std::string videoCodec, std::string pixelFormat, std::string customOptions, std::string subtitlesFilter, bool decodeImagesOnce);
+            static std::list<std::string> generateEncodeVideoArguments(const std::string& image1Path, const std::string& image2Path, const std::string& image3Path, const std::string& videoFilePath, const std::string& videoCodec, const std::string& pixelFormat, const std::string& customOptions, const std::string& subtitlesFilter);
             static std::string generateShakingVideoScript(std::string image1Path, std::string image2Path, std::string image3Path, std::string videoFilePath);
+            static std::string generateShakingVideoScript(std::string image1Path, std::string image2Path, std::string image3Path, std::string videoFilePath, std::string shakeResultsFilePath);
+            static std::string generateShakingFilterGraph(const double imageDuration, const bool cropJitter, const std::string& shakeResultsFilePath);
+            static std::string generateSubtitlesFilter(std::string subtitlePath, std::string forceStyle);
             static std::string generateZscaleVideoScript(std::string inputVideoFilePath, std::string outputVideoFilePath);
+            static int getEncodeVideoDuration();
+            static int getShakingVideoDuration();
     };
 
 }
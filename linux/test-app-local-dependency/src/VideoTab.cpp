@@ -22,14 +22,25 @@
 
 #include "VideoTab.h"
 #include "Application.h"
+#include "CommandTemplate.h"
 #include "Constants.h"
+#include "FilterGraph.h"
 #include "Log.h"
+#include "LogSink.h"
 #include "Popup.h"
-#include "Statistics.h"
+#include "ProgressEstimator.h"
+#include "SessionRouter.h"
 #include "Video.h"
 #include <FFmpegKit.h>
 #include <FFmpegKitConfig.h>
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstring>
+#include <future>
+#include <sys/resource.h>
 #include <sys/stat.h>
+#include <thread>
 
 using namespace ffmpegkit;
 
@@ -38,23 +49,7 @@ static gboolean showEncodeFailedPopup(Gtk::Window* window) {
     return FALSE;
 }
 
-static gboolean saveStatistics(const std::pair<ffmpegkittest::VideoTab*,const std::shared_ptr<Statistics>>* parameters) {
-    ffmpegkittest::VideoTab* videoTab = parameters->first;
-    auto statistics = parameters->second;
-    videoTab->updateProgressDialog(statistics);
-    delete parameters;
-    return FALSE;
-}
-
-static gboolean appendLog(const std::pair<ffmpegkittest::VideoTab*,const std::shared_ptr<Log>>* parameters) {
-    ffmpegkittest::VideoTab* videoTab = parameters->first;
-    auto log = parameters->second;
-    videoTab->appendOutput(log->getMessage());
-    delete parameters;
-    return FALSE;
-}
-
-ffmpegkittest::VideoTab::VideoTab() : selectedCodec(-1), statistics(nullptr) {
+ffmpegkittest::VideoTab::VideoTab() : selectedCodec(-1), outputView("video"), statistics() {
     videoCodecModel = Gtk::ListStore::create(videoCodecModelColumn);
     videoCodec.set_model(videoCodecModel);
     videoCodec.set_size_request(240, 30);
@@ -69,20 +64,49 @@ ffmpegkittest::VideoTab::VideoTab() : selectedCodec(-1), statistics(nullptr) {
     encodeButton.signal_clicked().connect(sigc::mem_fun(*this, &VideoTab::encodeVideo));
     Util::applyButtonStyle(encodeButton);
     encodeButtonBox.pack_start(encodeButton, Gtk::PACK_EXPAND_PADDING);
+    benchmarkButton.set_label("BENCHMARK");
+    benchmarkButton.set_size_request(120, 30);
+    benchmarkButton.set_tooltip_text(Constants::VideoTestTooltipText);
+    benchmarkButton.signal_clicked().connect(sigc::mem_fun(*this, &VideoTab::runBenchmark));
+    Util::applyButtonStyle(benchmarkButton);
+    encodeButtonBox.pack_start(benchmarkButton, Gtk::PACK_EXPAND_PADDING);
+    slideshowButton.set_label("SLIDESHOW");
+    slideshowButton.set_size_request(120, 30);
+    slideshowButton.set_tooltip_text(Constants::VideoTestTooltipText);
+    slideshowButton.signal_clicked().connect(sigc::mem_fun(*this, &VideoTab::runSlideshowBenchmark));
+    Util::applyButtonStyle(slideshowButton);
+    encodeButtonBox.pack_start(slideshowButton, Gtk::PACK_EXPAND_PADDING);
+    benchmarkRunning = false;
+    benchmarkLogBytes = 0;
+
+    logConsumerId = LogSink::getInstance().registerConsumer([this](const std::string& batch) {
+        appendOutput(batch);
+    });
+    statisticsConsumerId = SessionRouter::getInstance().registerStatisticsConsumer([this](const StatisticsSnapshot& statistics) {
+        updateProgressDialog(statistics);
+    });
+    logEventConsumerId = SessionRouter::getInstance().registerLogEventConsumer([this](const LogEvent& event) {
+        onLogEvent(event);
+    });
+    benchmarkLogConsumerId = LogSink::getInstance().registerConsumer([this](const std::string& batch) {
+        benchmarkLogBytes += batch.size();
+    });
+    warningLogFilterId = SessionRouter::getInstance().registerLogFilter(LogFilter(LevelAVLogWarning));
 
-    outputText.set_editable(false);
-    Util::applyOutputTextStyle(outputText);
-    outputTextWindow.add(outputText);
+    std::vector<std::string> slideshowImages;
+    const std::string sampleImages[] = {"machupicchu.jpg", "pyramid.jpg", "stonehenge.jpg"};
+    for (int i = 0; i < SlideshowBenchmarkImageCount; i++) {
+        slideshowImages.push_back(Application::getApplicationInstallDirectory() + "/share/images/" + sampleImages[i % 3]);
+    }
+    slideshow.reset(new Slideshow(slideshowImages, std::vector<double>(SlideshowBenchmarkImageCount, 1), TransitionWipe, 0.5, Application::getApplicationCacheDirectory() + "/slideshow-segments"));
 
     pack_start(videoCodecBox, Gtk::PACK_SHRINK);
     pack_start(encodeButtonBox, Gtk::PACK_SHRINK);
-    add(outputTextWindow);
+    add(outputView);
 }
 
 void ffmpegkittest::VideoTab::setActive() {
     std::cout << "Video Tab Activated" << std::endl;
-    FFmpegKitConfig::enableLogCallback(nullptr);
-    FFmpegKitConfig::enableStatisticsCallback(nullptr);
 }
 
 void ffmpegkittest::VideoTab::setParentWindow(Gtk::Window* parentWindow) {
@@ -90,26 +114,32 @@ void ffmpegkittest::VideoTab::setParentWindow(Gtk::Window* parentWindow) {
 }
 
 void ffmpegkittest::VideoTab::appendOutput(const std::string& string) {
-    outputText.get_buffer()->set_text(outputText.get_buffer()->get_text() + string);
-    Glib::RefPtr<Gtk::Adjustment> adj = outputText.get_vadjustment();
-    adj->set_value(adj->get_upper());
+    outputView.append(string);
 }
 
-void ffmpegkittest::VideoTab::updateProgressDialog(const std::shared_ptr<ffmpegkit::Statistics> statistics) {
-    if (statistics == nullptr || statistics->getTime() < 0) {
+void ffmpegkittest::VideoTab::updateProgressDialog(const StatisticsSnapshot& statistics) {
+    if (statistics.time < 0) {
         return;
     }
 
     this->statistics = statistics;
-    double timeInMilliseconds = this->statistics->getTime();
-    int totalVideoDuration = 9000;
-    double completePercentage = timeInMilliseconds*100/totalVideoDuration;
-    // progressDialog.update(completePercentage);
-    std::cout << "Encoding completed " << completePercentage << "%" << std::endl;
+    auto progress = ProgressEstimator::getInstance().update(statistics);
+    // progressDialog.update(progress.percentage);
+    std::cout << "Encoding: " << ProgressEstimator::format(progress) << std::endl;
+}
+
+void ffmpegkittest::VideoTab::onLogEvent(const LogEvent& event) {
+    if (event.type == LogEventOutput) {
+        std::cout << "Writing " << event.file.format << " output to " << event.file.url << "." << std::endl;
+    } else if (event.type == LogEventStream && event.stream.output && strcmp(event.stream.mediaType, "Video") == 0) {
+        std::cout << "Encoding " << event.stream.codec << " stream " << event.stream.width << "x" << event.stream.height << " at " << event.stream.frameRate << " fps." << std::endl;
+    } else if (event.type == LogEventProgress && event.progress.last) {
+        std::cout << "Encoded " << event.progress.frame << " frames into " << event.progress.size / 1024 << " KB." << std::endl;
+    }
 }
 
 void ffmpegkittest::VideoTab::clearOutput() {
-    outputText.get_buffer()->set_text("");
+    outputView.clear();
 }
 
 void ffmpegkittest::VideoTab::initVideoCodecData() {
@@ -172,7 +202,11 @@ void ffmpegkittest::VideoTab::onVideoCodecChanged() {
 }
 
 std::string ffmpegkittest::VideoTab::getSelectedVideoCodec() {
-    switch(selectedCodec) {
+    return getVideoCodec(selectedCodec);
+}
+
+std::string ffmpegkittest::VideoTab::getVideoCodec(const int codecIndex) {
+    switch(codecIndex) {
         case 0: return "mpeg4";
         case 1: return "libx264";
         case 2: return "libopenh264";
@@ -194,21 +228,20 @@ void ffmpegkittest::VideoTab::encodeVideo() {
     std::string image1File = Application::getApplicationInstallDirectory() + "/share/images/machupicchu.jpg";
     std::string image2File = Application::getApplicationInstallDirectory() + "/share/images/pyramid.jpg";
     std::string image3File = Application::getApplicationInstallDirectory() + "/share/images/stonehenge.jpg";
-    std::string videoFile = getVideoFile();
+    std::string videoCodec = this->getSelectedVideoCodec();
+    std::string videoFile = getVideoFile(videoCodec);
 
     std::remove(videoFile.c_str());
 
-    std::string videoCodec = this->getSelectedVideoCodec();
-
     std::cout << "Testing VIDEO encoding with '" << videoCodec << "' codec" << std::endl;
 
     showProgressDialog();
 
-    std::string ffmpegCommand = Video::generateEncodeVideoScript(image1File, image2File, image3File, videoFile, getSelectedVideoCodec(), getPixelFormat(), getCustomOptions());
+    auto arguments = Video::generateEncodeVideoArguments(image1File, image2File, image3File, videoFile, videoCodec, getPixelFormat(videoCodec), getCustomOptions(videoCodec), "");
 
-    std::cout << "FFmpeg process started with arguments: '" << ffmpegCommand << "'." << std::endl;
+    std::cout << "FFmpeg process started with arguments: '" << CommandTemplate::toString(arguments) << "'." << std::endl;
 
-    auto session = FFmpegKit::executeAsync(ffmpegCommand, [this](auto session) {
+    auto session = SessionRouter::getInstance().executeAsync(arguments, [this](auto session) {
         const auto state = session->getState();
         auto returnCode = session->getReturnCode();
 
@@ -220,18 +253,236 @@ void ffmpegkittest::VideoTab::encodeVideo() {
             g_idle_add((GSourceFunc)showEncodeFailedPopup, this->parentWindow);
             std::cout << "Encode failed with state " << FFmpegKitConfig::sessionStateToString(state) << " and rc " << returnCode << "." << session->getFailStackTrace() << std::endl;
         }
-    }, [this](auto log) {
-        g_idle_add((GSourceFunc)appendLog, new std::pair<VideoTab*,const std::shared_ptr<Log>>(this, log));
-    }, [this](auto statistics) {
-        g_idle_add((GSourceFunc)saveStatistics, new std::pair<VideoTab*,const std::shared_ptr<Statistics>>(this, statistics));
-    });
+    }, logConsumerId, statisticsConsumerId, logEventConsumerId);
+    ProgressEstimator::getInstance().expectDuration(session->getSessionId(), Video::getEncodeVideoDuration());
 
     std::cout << "Async FFmpeg process started with sessionId " << session->getSessionId() << "." << std::endl;
 }
 
-std::string ffmpegkittest::VideoTab::getPixelFormat() {
-    std::string videoCodec = this->getSelectedVideoCodec();
+void ffmpegkittest::VideoTab::runBenchmark() {
+    if (benchmarkRunning.exchange(true)) {
+        std::cout << "Video benchmark is already running." << std::endl;
+        return;
+    }
+
+    clearOutput();
+
+    std::cout << "Testing VIDEO filter graph generation, initialisation and image sources." << std::endl;
+
+    // SYNCHRONOUS SESSIONS BLOCK, SO THE BENCHMARK RUNS OUTSIDE THE MAIN LOOP
+    std::thread([this]() {
+        const int generationCount = 10000;
+        const int initRunCount = 5;
+        std::string image1File = Application::getApplicationInstallDirectory() + "/share/images/machupicchu.jpg";
+        std::string image2File = Application::getApplicationInstallDirectory() + "/share/images/pyramid.jpg";
+        std::string image3File = Application::getApplicationInstallDirectory() + "/share/images/stonehenge.jpg";
+
+        auto start = std::chrono::steady_clock::now();
+        for (int i = 0; i < generationCount; i++) {
+            FilterGraph::clearCache();
+            Video::generateEncodeVideoScript(image1File, image2File, image3File, getVideoFile("mpeg4"), "mpeg4", "yuv420p", "");
+        }
+        const double builtTime = std::chrono::duration<double, std::micro>(std::chrono::steady_clock::now() - start).count() / generationCount;
+
+        start = std::chrono::steady_clock::now();
+        for (int i = 0; i < generationCount; i++) {
+            Video::generateEncodeVideoScript(image1File, image2File, image3File, getVideoFile("mpeg4"), "mpeg4", "yuv420p", "");
+        }
+        const double cachedTime = std::chrono::duration<double, std::micro>(std::chrono::steady_clock::now() - start).count() / generationCount;
+
+        std::cout << "Generated the encode script in " << builtTime << " us when the graph was built and " << cachedTime << " us when it was cached." << std::endl;
+
+        // THE SAME COMMAND BUILT AS A STRING AND TOKENIZED BY FFMPEGKIT, AGAINST A TEMPLATE THAT WAS TOKENIZED ONCE
+        const int instantiationCount = 1000000;
+        const std::string videoFile = getVideoFile("libx265");
+        size_t argumentCount = 0;
+
+        start = std::chrono::steady_clock::now();
+        for (int i = 0; i < instantiationCount; i++) {
+            argumentCount += FFmpegKitConfig::parseArguments(Video::generateEncodeVideoScript(image1File, image2File, image3File, videoFile, "libx265", "yuv420p10le", getCustomOptions("libx265"))).size();
+        }
+        const long parsedTime = std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::steady_clock::now() - start).count();
+
+        start = std::chrono::steady_clock::now();
+        for (int i = 0; i < instantiationCount; i++) {
+            argumentCount += Video::generateEncodeVideoArguments(image1File, image2File, image3File, videoFile, "libx265", "yuv420p10le", getCustomOptions("libx265"), "").size();
+        }
+        const long boundTime = std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::steady_clock::now() - start).count();
+
+        std::cout << "Instantiated the encode command " << instantiationCount << " times in " << parsedTime << " ms by building and parsing a string and in " << boundTime << " ms by binding a template, " << argumentCount / (2 * instantiationCount) << " arguments each." << std::endl;
+
+        // A SINGLE FRAME WRITTEN TO THE NULL MUXER IS DOMINATED BY PARSING AND INITIALISING THE GRAPH
+        long initTime = 0;
+        int failedCount = 0;
+        for (int i = 0; i < initRunCount; i++) {
+            auto session = FFmpegKit::execute(Video::generateEncodeVideoScript(image1File, image2File, image3File, "-f null -", "mpeg4", "yuv420p", "-frames:v 1 "));
+            if (!ReturnCode::isSuccess(session->getReturnCode())) {
+                failedCount++;
+            }
+            initTime += session->getDuration();
+        }
+
+        std::cout << "FFmpeg initialised the graph and encoded one frame in " << initTime / initRunCount << " ms on average, " << failedCount << " of " << initRunCount << " runs failed." << std::endl;
+
+        // WRAPPED FRAMES ARE NOT ENCODED, SO THE SESSION TIME IS SPENT DECODING THE IMAGES ONCE AND RUNNING THE GRAPH
+        const int graphFrameCount = Video::getEncodeVideoDuration() * 25 / 1000;
+        const char* pixelFormats[2] = {"yuv420p", "yuv420p10le"};
+        for (int format = 0; format < 2; format++) {
+            double frameTime[2];
+            for (int pinned = 0; pinned < 2; pinned++) {
+                auto session = FFmpegKit::execute("-hide_banner -y -i \"" + image1File + "\" -i \"" + image2File + "\" -i \"" + image3File + "\" -filter_complex \"" + Video::generateEncodeFilterGraph(pixelFormats[format], "", true, pinned == 1) + "\" -map [video] -c:v wrapped_avframe -f null -");
+                frameTime[pinned] = ReturnCode::isSuccess(session->getReturnCode()) ? session->getDuration() * 1000.0 / graphFrameCount : -1;
+            }
+
+            std::cout << "Filter graph took " << frameTime[0] << " us per frame with negotiated formats and " << frameTime[1] << " us per frame working in " << pixelFormats[format] << "." << std::endl;
+        }
+
+        const int codecCount = 11;
+        for (int codec = 0; codec < codecCount; codec++) {
+            benchmarkImageSources(getVideoCodec(codec));
+        }
+
+        benchmarkTransitions();
+
+        benchmarkLogFilter();
+
+        benchmarkRunning = false;
+    }).detach();
+}
 
+void ffmpegkittest::VideoTab::benchmarkImageSources(const std::string& videoCodec) {
+    std::string image1File = Application::getApplicationInstallDirectory() + "/share/images/machupicchu.jpg";
+    std::string image2File = Application::getApplicationInstallDirectory() + "/share/images/pyramid.jpg";
+    std::string image3File = Application::getApplicationInstallDirectory() + "/share/images/stonehenge.jpg";
+    const int frameCount = Video::getEncodeVideoDuration() * 30 / 1000;
+
+    double fps[2];
+    double cpuTime[2];
+    bool succeeded = true;
+
+    // LOOPED INPUTS DECODE AND SCALE EVERY IMAGE FOR EVERY FRAME, STILL SOURCES DO IT ONCE PER IMAGE
+    for (int decodeOnce = 0; decodeOnce < 2; decodeOnce++) {
+        struct rusage usageBefore;
+        struct rusage usageAfter;
+        getrusage(RUSAGE_SELF, &usageBefore);
+
+        auto session = FFmpegKit::execute(Video::generateEncodeVideoScript(image1File, image2File, image3File, "-f null -", videoCodec, getPixelFormat(videoCodec), getCustomOptions(videoCodec), "", decodeOnce == 1));
+
+        getrusage(RUSAGE_SELF, &usageAfter);
+        succeeded = succeeded && ReturnCode::isSuccess(session->getReturnCode());
+
+        // SESSIONS RUN ONE AT A TIME, SO THE PROCESS CPU TIME BELONGS TO THIS ENCODE
+        cpuTime[decodeOnce] = (usageAfter.ru_utime.tv_sec - usageBefore.ru_utime.tv_sec) + (usageAfter.ru_stime.tv_sec - usageBefore.ru_stime.tv_sec) + ((usageAfter.ru_utime.tv_usec - usageBefore.ru_utime.tv_usec) + (usageAfter.ru_stime.tv_usec - usageBefore.ru_stime.tv_usec)) / 1000000.0;
+        fps[decodeOnce] = session->getDuration() > 0 ? frameCount * 1000.0 / session->getDuration() : 0;
+    }
+
+    std::cout << "Encoded " << videoCodec << " at " << fps[0] << " fps using " << cpuTime[0] << " s cpu with looped images and at " << fps[1] << " fps using " << cpuTime[1] << " s cpu with still images" << (succeeded ? "" : " (failed)") << "." << std::endl;
+}
+
+void ffmpegkittest::VideoTab::benchmarkTransitions() {
+    std::string image1File = Application::getApplicationInstallDirectory() + "/share/images/machupicchu.jpg";
+    std::string image2File = Application::getApplicationInstallDirectory() + "/share/images/pyramid.jpg";
+    const SlideshowTransition transitions[2] = {TransitionWipeExpression, TransitionWipe};
+    const double transitionDuration = 10;
+
+    std::string transitionFiles[2];
+    double fps[2];
+    bool succeeded = true;
+
+    // A LONG TRANSITION SEGMENT KEEPS IMAGE DECODING AND ENCODER START UP OUT OF THE MEASUREMENT
+    for (int i = 0; i < 2; i++) {
+        Slideshow transitionSlideshow({image1File, image2File}, {0}, transitions[i], transitionDuration, Application::getApplicationCacheDirectory());
+        const SlideshowSegment segment = transitionSlideshow.generateSegments(".mp4", "mpeg4", "yuv420p", "-q:v 2 ")[1];
+
+        auto session = FFmpegKit::executeWithArguments(segment.arguments);
+        succeeded = succeeded && ReturnCode::isSuccess(session->getReturnCode());
+        fps[i] = session->getDuration() > 0 ? segment.frameCount * 1000.0 / session->getDuration() : 0;
+
+        transitionFiles[i] = Application::getApplicationCacheDirectory() + "/transition-" + std::to_string(i) + ".mp4";
+        std::rename(segment.file.c_str(), transitionFiles[i].c_str());
+    }
+
+    // THE MASK ONLY DIFFERS FROM THE EXPRESSION IN CHROMA ROUNDING ALONG THE BAND EDGES
+    auto psnrSession = FFmpegKit::execute("-hide_banner -i \"" + transitionFiles[0] + "\" -i \"" + transitionFiles[1] + "\" -lavfi psnr -f null -");
+    const std::string logs = psnrSession->getAllLogsAsString();
+    const size_t average = logs.rfind("average:");
+    const std::string psnr = (average == std::string::npos) ? "unknown" : logs.substr(average + 8, logs.find(' ', average) - average - 8);
+
+    std::cout << "Rendered wipe transitions at " << fps[0] << " fps with the blend expression and at " << fps[1] << " fps with the generated mask, PSNR " << psnr << " dB" << (succeeded ? "" : " (failed)") << "." << std::endl;
+}
+
+void ffmpegkittest::VideoTab::benchmarkLogFilter() {
+    std::string image1File = Application::getApplicationInstallDirectory() + "/share/images/machupicchu.jpg";
+    std::string image2File = Application::getApplicationInstallDirectory() + "/share/images/pyramid.jpg";
+    std::string image3File = Application::getApplicationInstallDirectory() + "/share/images/stonehenge.jpg";
+    const int frameCount = Video::getEncodeVideoDuration() * 30 / 1000;
+    const int logFilterIds[2] = {0, warningLogFilterId};
+
+    double fps[2];
+    uint64_t filteredCount[2];
+    size_t deliveredBytes[2];
+    bool succeeded = true;
+
+    // THE SAME ENCODE ROUTED TO A CONSUMER THAT SEES EVERY INFO LINE AND TO ONE THAT ONLY SEES WARNINGS
+    for (int i = 0; i < 2; i++) {
+        const uint64_t filteredBefore = SessionRouter::getInstance().getFilteredCount();
+        benchmarkLogBytes = 0;
+
+        std::promise<std::shared_ptr<FFmpegSession>> result;
+        SessionRouter::getInstance().executeAsync(Video::generateEncodeVideoArguments(image1File, image2File, image3File, "-", "libx264", getPixelFormat("libx264"), getCustomOptions("libx264") + "-f null ", ""), [&result](auto session) {
+            result.set_value(session);
+        }, benchmarkLogConsumerId, 0, 0, logFilterIds[i]);
+        auto session = result.get_future().get();
+
+        // THE SINK DELIVERS THE LAST BATCH ON ITS NEXT DRAIN
+        std::this_thread::sleep_for(std::chrono::milliseconds(LogSink::DefaultDrainInterval * 2));
+
+        succeeded = succeeded && ReturnCode::isSuccess(session->getReturnCode());
+        fps[i] = session->getDuration() > 0 ? frameCount * 1000.0 / session->getDuration() : 0;
+        filteredCount[i] = SessionRouter::getInstance().getFilteredCount() - filteredBefore;
+        deliveredBytes[i] = benchmarkLogBytes;
+    }
+
+    std::cout << "Encoded libx264 at " << fps[0] << " fps delivering " << deliveredBytes[0] << " log bytes at info level and at " << fps[1] << " fps delivering " << deliveredBytes[1] << " log bytes with a warning filter that dropped " << filteredCount[1] << " lines" << (succeeded ? "" : " (failed)") << "." << std::endl;
+}
+
+void ffmpegkittest::VideoTab::runSlideshowBenchmark() {
+    if (benchmarkRunning.exchange(true)) {
+        std::cout << "Video benchmark is already running." << std::endl;
+        return;
+    }
+
+    clearOutput();
+
+    const int coreCount = std::max(1, (int)std::thread::hardware_concurrency());
+    std::cout << "Testing VIDEO slideshow encoding of " << SlideshowBenchmarkImageCount << " images with 1 to " << coreCount << " workers." << std::endl;
+
+    // EVERY ROUND WAITS FOR THE PREVIOUS ONE, SO THE BENCHMARK RUNS OUTSIDE THE MAIN LOOP
+    std::thread([this, coreCount]() {
+        long singleWorkerTime = 0;
+
+        for (int workers = 1; ; workers = std::min(workers * 2, coreCount)) {
+            std::promise<std::pair<bool, long>> result;
+            slideshow->encode(getVideoFile("mpeg4"), "mpeg4", "yuv420p", "", workers, [&result](const bool succeeded, const long elapsed) {
+                result.set_value(std::make_pair(succeeded, elapsed));
+            });
+            const auto outcome = result.get_future().get();
+
+            if (workers == 1) {
+                singleWorkerTime = outcome.second;
+            }
+            std::cout << "Encoded " << slideshow->getDuration() << " s slideshow with " << workers << " workers in " << outcome.second << " ms, " << (outcome.second > 0 ? (double)singleWorkerTime / outcome.second : 0) << "x speedup" << (outcome.first ? "" : " (failed)") << "." << std::endl;
+
+            if (workers == coreCount) {
+                break;
+            }
+        }
+
+        benchmarkRunning = false;
+    }).detach();
+}
+
+std::string ffmpegkittest::VideoTab::getPixelFormat(const std::string& videoCodec) {
     std::string pixelFormat;
     if (videoCodec.compare("libx265") == 0) {
         pixelFormat = "yuv420p10le";
@@ -242,9 +493,7 @@ std::string ffmpegkittest::VideoTab::getPixelFormat() {
     return pixelFormat;
 }
 
-std::string ffmpegkittest::VideoTab::getVideoFile() {
-    std::string videoCodec = this->getSelectedVideoCodec();
-
+std::string ffmpegkittest::VideoTab::getVideoFile(const std::string& videoCodec) {
     std::string extension;
     if (videoCodec.compare("vp8") == 0 || videoCodec.compare("vp9") == 0) {
         extension = "webm";
@@ -263,9 +512,7 @@ std::string ffmpegkittest::VideoTab::getVideoFile() {
     return Application::getApplicationCacheDirectory() + "/video." + extension;
 }
 
-std::string ffmpegkittest::VideoTab::getCustomOptions() {
-    std::string videoCodec = this->getSelectedVideoCodec();
-
+std::string ffmpegkittest::VideoTab::getCustomOptions(const std::string& videoCodec) {
     if (videoCodec.compare("libx265") == 0) {
         return "-crf 28 -preset fast ";
     } else if (videoCodec.compare("vp8") == 0) {
@@ -23,30 +23,44 @@
 #ifndef FFMPEG_KIT_TEST_VIDEO_TAB_H
 #define FFMPEG_KIT_TEST_VIDEO_TAB_H
 
+#include "OutputView.h"
+#include "LogParser.h"
 #include "ProgressDialog.h"
-#include "Statistics.h"
+#include "Slideshow.h"
+#include "StatisticsAggregator.h"
 #include "Util.h"
+#include <atomic>
 #include <gtkmm.h>
+#include <memory>
 
 namespace ffmpegkittest {
 
     class VideoTab: public Gtk::VBox {
         public:
+            static constexpr const int SlideshowBenchmarkImageCount = 200;
+
             VideoTab();
             void setActive();
             void setParentWindow(Gtk::Window* parentWindow);
             void appendOutput(const std::string& string);
-            void updateProgressDialog(const std::shared_ptr<ffmpegkit::Statistics> statistics);
+            void updateProgressDialog(const StatisticsSnapshot& statistics);
+            void onLogEvent(const LogEvent& event);
 
         private:
             void clearOutput();
             void initVideoCodecData();
             void onVideoCodecChanged();
             std::string getSelectedVideoCodec();
+            static std::string getVideoCodec(const int codecIndex);
             void encodeVideo();
-            std::string getPixelFormat();
-            std::string getVideoFile();
-            std::string getCustomOptions();
+            void runBenchmark();
+            void benchmarkImageSources(const std::string& videoCodec);
+            void benchmarkTransitions();
+            void benchmarkLogFilter();
+            void runSlideshowBenchmark();
+            std::string getPixelFormat(const std::string& videoCodec);
+            std::string getVideoFile(const std::string& videoCodec);
+            std::string getCustomOptions(const std::string& videoCodec);
             void showProgressDialog();
             void hideProgressDialog();
 
@@ -56,12 +70,21 @@ namespace ffmpegkittest {
             Gtk::HBox videoCodecBox;
             int selectedCodec;
             Gtk::Button encodeButton;
+            Gtk::Button benchmarkButton;
+            Gtk::Button slideshowButton;
             Gtk::HBox encodeButtonBox;
-            Gtk::TextView outputText;
-            Gtk::ScrolledWindow outputTextWindow;
+            OutputView outputView;
             ffmpegkittest::ProgressDialog progressDialog;
             Gtk::Window* parentWindow;
-            std::shared_ptr<ffmpegkit::Statistics> statistics;
+            int logConsumerId;
+            int statisticsConsumerId;
+            int logEventConsumerId;
+            int benchmarkLogConsumerId;
+            int warningLogFilterId;
+            std::atomic<size_t> benchmarkLogBytes;
+            StatisticsSnapshot statistics;
+            std::atomic<bool> benchmarkRunning;
+            std::unique_ptr<Slideshow> slideshow;
     };
 
 }
@@ -22,8 +22,22 @@
 
 #include "Application.h"
 #include "MediaInformationParserTest.h"
+#include "CommandTemplateTest.h"
 #include "FFmpegKitTest.h"
+#include "FilterGraphTest.h"
+#include "JobSchedulerTest.h"
+#include "LogParserTest.h"
+#include "LogSinkTest.h"
+#include "PipelineTest.h"
+#include "ProgressEstimatorTest.h"
+#include "SessionHistoryTest.h"
+#include "SessionPlacementTest.h"
+#include "SessionRouterTest.h"
+#include "SlideshowTest.h"
+#include "ThreadBudgetTest.h"
+#include "ToneMapLutTest.h"
 #include <FFmpegKitConfig.h>
+#include <cstdlib>
 #include <locale.h>
 
 int main(int argc, char** argv) {
@@ -38,6 +52,28 @@ int main(int argc, char** argv) {
     // RUN UNIT TESTS BEFORE STARTING THE APPLICATION
     testMediaInformationJsonParser();
     testFFmpegKit();
+    testCommandTemplate();
+    testLogParser();
+    testLogSink();
+    testSessionRouter();
+    testProgressEstimator();
+    testJobScheduler();
+    testThreadBudget();
+    testSessionPlacement();
+    testSessionHistory();
+    testPipeline();
+    testFilterGraph();
+    testSlideshow();
+    testToneMapLut();
+
+    // SOAKS AND BENCHMARKS TAKE SECONDS, SO THEY ONLY RUN WHEN ASKED FOR
+    if (getenv("FFMPEG_KIT_TEST_BENCHMARKS") != nullptr) {
+        benchmarkLogParser();
+        benchmarkLogSink();
+        benchmarkSessionRouter();
+        benchmarkSessionHistory();
+        benchmarkPipeline();
+    }
 
     app->run(application);
     ffmpegkit::FFmpegKitConfig::disableRedirection();